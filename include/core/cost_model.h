@@ -0,0 +1,56 @@
+#pragma once
+#include "core/graph.h"
+
+namespace infini {
+
+/**
+ * @brief Estimates the time of operators without running them, e.g. for
+ * SearchEngine to rank candidates before measuring the best ones.
+ */
+class CostModelObj {
+  public:
+    virtual ~CostModelObj() {}
+    /**
+     * @brief The estimated time of `op` in milliseconds. Implementations
+     * must be safe to call from several threads.
+     */
+    virtual double getCost(const Operator &op) const = 0;
+    /**
+     * @brief The sum of the costs of the operators of `graph` that do
+     * anything when run.
+     */
+    double getCost(const Graph &graph) const;
+};
+using CostModel = Ref<CostModelObj>;
+
+/**
+ * @brief The roofline model. An operator takes as long as the slower of its
+ * arithmetic at the peak FLOP rate and its inputs and outputs at the peak
+ * bandwidth, plus a fixed launch overhead. FLOPs and bytes are estimated by
+ * get_flops and get_io_bytes.
+ */
+class RooflineCostModelObj : public CostModelObj {
+    double peakGflops;    // in GFLOP/s
+    double bandwidthGBps; // in GB/s
+    double overheadMs;
+
+  public:
+    RooflineCostModelObj(double peakGflops, double bandwidthGBps,
+                         double overheadMs = 0);
+
+    /**
+     * @brief Measure the peaks of `runtime` with a short micro-benchmark of
+     * its own kernels: a tiny Relu for the overhead, a compute-bound MatMul
+     * for the FLOP rate and a Relu far beyond the caches for the bandwidth.
+     */
+    static Ref<RooflineCostModelObj> calibrate(const Runtime &runtime);
+
+    using CostModelObj::getCost;
+    double getCost(const Operator &op) const override;
+
+    double getPeakGflops() const { return peakGflops; }
+    double getBandwidthGBps() const { return bandwidthGBps; }
+    double getOverheadMs() const { return overheadMs; }
+};
+
+} // namespace infini
@@ -10,6 +10,7 @@ class DummyMutator : public Mutator {
     virtual vector<Graph> run(const Graph &inGraph) override;
     virtual vector<Graph> mergeMultiBranch(const Graph &inGraph) override;
     virtual bool isMultiBranchMergable(const Graph &inGraph) override;
+    bool isThreadSafe() const override { return true; }
 };
 
 } // namespace infini
@@ -0,0 +1,38 @@
+#pragma once
+#include "core/kernel.h"
+
+namespace infini {
+
+/**
+ * @brief The kernels and performance records of the operators of a graph in
+ * execution order, resolved once so that repeated runs skip the lookups in
+ * KernelRegistry and PerfEngine. GraphObj drops its plan whenever operators,
+ * connections, shapes or tensor memory change.
+ */
+struct ExecutionPlanObj {
+    struct Step {
+        Kernel *kernel;
+        // nullptr if there is no record, in which case the kernel runs with
+        // its default arguments
+        PerfRecord record;
+        Operator op;
+        // Index of the description of the operator in Profiler
+        uint32_t profileId = 0;
+    };
+
+    const RuntimeObj *runtime;
+    vector<Step> steps;
+    // PerfEngine::getVersion() when the records were looked up
+    size_t perfVersion;
+    // Profiler::getGeneration() when the operators were described, 0 if
+    // they never were
+    size_t profilerGeneration = 0;
+
+    // Successors and predecessor counts of the steps for parallel execution,
+    // which depend on tensor memory and are built on first use
+    bool hasDependencies = false;
+    vector<vector<size_t>> successors;
+    vector<int> numPredecessors;
+};
+
+} // namespace infini
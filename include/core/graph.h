@@ -32,12 +32,14 @@ class GraphObj : public Object {
         auto it = std::find(ops.begin(), ops.end(), op);
         if (it != ops.end())
             ops.erase(it);
+        invalidateCaches();
     }
 
     void removeTensor(Tensor tensor) {
         auto it = std::find(tensors.begin(), tensors.end(), tensor);
         if (it != tensors.end())
             tensors.erase(it);
+        invalidateCaches();
     }
 
     void deleteConnection(Tensor tensor, Operator op);
@@ -62,10 +64,65 @@ class GraphObj : public Object {
      */
     bool topo_sort();
 
+    /**
+     * @brief Fuse operators on the native CPU backend: BatchNorm is folded
+     * into the weights and bias of the preceding Conv, bias-adds and
+     * activations are absorbed into MatMul and Conv, decomposed attention,
+     * LayerNorm and RMSNorm become single operators, and chains of
+     * element-wise operators become FusedElementWise operators. Folding
+     * BatchNorm needs the data of the weights, so it is skipped before they
+     * are loaded.
+     */
     void optimize();
 
+    /**
+     * @brief Evaluate the operators whose inputs are all loaded weights, as
+     * well as Shape operators, once on the native CPU runtime and replace
+     * their outputs with new weights. Then remove the operators whose outputs
+     * reach no tensor marked as graph output. Folding needs the data of the
+     * weights, so it is skipped before the first dataMalloc. The dims of
+     * graph inputs become constants, so the graph cannot be run with other
+     * input shapes afterwards.
+     */
+    void foldConstants();
+
+    /**
+     * @brief Infer the output shapes of all operators again, e.g. after the
+     * shapes of graph inputs are changed by TensorObj::setShape. Operators
+     * that keep shape-derived attributes, such as MatmulObj, are not
+     * updated and have to be recreated.
+     */
+    void shape_infer();
+
+    /**
+     * @brief Assign memory to all tensors. The plan of non-weight tensors is
+     * cached by the shapes of graph inputs, so that switching between input
+     * shapes that have already occurred only rebinds the tensors to the
+     * existing buffer.
+     */
     void dataMalloc(bool useNaiveAllocator = false);
 
+    /**
+     * @brief Choose how dataMalloc assigns memory to non-weight tensors.
+     * Planned strategies also let the output of element-wise and reshape
+     * operators overwrite an input that is not used afterwards.
+     */
+    void setMemoryPlanStrategy(MemoryPlanStrategy strategy) {
+        memoryPlanStrategy = strategy;
+        allocator.clearCache();
+    }
+
+    const LazyAllocator &getAllocator() const { return allocator; }
+
+    /**
+     * @brief The execution plan cached by the runtime, or nullptr after the
+     * graph has changed.
+     */
+    ExecutionPlan getExecutionPlan() const { return executionPlan; }
+    void setExecutionPlan(ExecutionPlan plan) {
+        executionPlan = std::move(plan);
+    }
+
     /**
      * @brief Add an operator and create its outputs. Output tensor arguments
      * should be empty Refs (e.g., nullptr).
@@ -111,11 +168,65 @@ class GraphObj : public Object {
     bool checkValid() const;
 
   private:
+    // Applies the fusions found by pattern matching through replaceOperators
+    friend class SubGraphRewriter;
+
+    /**
+     * @brief Replace a connected group of operators with `newOp`, which takes
+     * over their outputs that it computes. Tensors that are only used inside
+     * the group are removed.
+     */
+    void replaceOperators(const OpVec &oldOps, const Operator &newOp);
+    /**
+     * @brief Compute the outputs of `op` on the native CPU runtime, turn them
+     * into weights and remove `op`.
+     */
+    void foldOperator(const Operator &op);
+    void eliminateDeadCode();
+
+    // Passes of optimize()
+    void foldBatchNormIntoConv();
+    void fuseAttention();
+    void fuseBiasAndActivation();
+    void fuseElementWise();
+
+    /**
+     * @brief Drop the memory plans and the execution plan, which are only
+     * valid for the current operators and connections.
+     */
+    void invalidateCaches() {
+        allocator.clearCache();
+        executionPlan = nullptr;
+    }
+
     /**
      * @brief Add reverse connections and Op relationship in ctor.
      */
     void addOperatorAndConnect(const Operator &op);
 
+    // Where a view lies in the memory of another tensor
+    struct View {
+        TensorObj *owner;
+        // in bytes
+        size_t offset;
+    };
+
+    /**
+     * @brief Bind the output of every view operator that can share the memory
+     * of its input to the tensor owning that memory, and set the strides of
+     * the outputs of Slice, Transpose and Expand that become strided views.
+     * Operators must be in topological order.
+     */
+    std::unordered_map<TensorObj *, View> planViews();
+
+    /**
+     * @brief Plan offsets of all non-weight tensors from their lifetimes in
+     * the topological order. A view shares the block of its owner, which
+     * lives as long as any of them.
+     */
+    void planMemory(const std::unordered_map<TensorObj *, View> &views,
+                    std::unordered_map<TensorObj *, size_t> &tensorToOffset);
+
     /**
      * @brief If the nodes is sorted in topological order.
      */
@@ -125,6 +236,10 @@ class GraphObj : public Object {
      * @brief If the weight tensors are allocated.
      */
     bool weightAllocated = false;
+
+    MemoryPlanStrategy memoryPlanStrategy = MemoryPlanStrategy::Online;
+
+    ExecutionPlan executionPlan;
 };
 
 } // namespace infini
@@ -30,6 +30,12 @@ class GraphHandlerObj {
     Tensor batchNormalization(Tensor input, Tensor output, Tensor mean,
                               Tensor var, Tensor scale, Tensor bias,
                               float momentum, float eps, bool training);
+    Tensor layerNormalization(Tensor input, Tensor scale, Tensor output,
+                              Tensor bias, float eps, int axis);
+    Tensor rmsNorm(Tensor input, Tensor scale, Tensor output, float eps,
+                   int axis);
+    Tensor attention(Tensor query, Tensor key, Tensor value, Tensor output,
+                     Tensor mask, std::optional<float> scale);
 
     Tensor maxPool(Tensor input, Tensor output, int kh, int kw, int dh, int dw,
                    int ph, int pw, int sh, int sw, int ceilMode);
@@ -69,6 +75,14 @@ class GraphHandlerObj {
     Tensor gather(Tensor data, Tensor indices, Tensor output, int axis);
     Tensor reduceMean(Tensor data, Tensor reduced,
                       const optional<vector<int>> &axes, bool keepdims);
+    Tensor reduceSum(Tensor data, Tensor reduced,
+                     const optional<vector<int>> &axes, bool keepdims);
+    Tensor reduceMax(Tensor data, Tensor reduced,
+                     const optional<vector<int>> &axes, bool keepdims);
+    Tensor reduceMin(Tensor data, Tensor reduced,
+                     const optional<vector<int>> &axes, bool keepdims);
+    Tensor reduceL2(Tensor data, Tensor reduced,
+                    const optional<vector<int>> &axes, bool keepdims);
     Tensor slice(Tensor input, Tensor output, const vector<int> &starts,
                  const vector<int> &ends, const optional<vector<int>> &axes,
                  const optional<vector<int>> &steps);
@@ -92,6 +106,8 @@ class GraphHandlerObj {
 
     inline void optimize() { g->optimize(); }
 
+    inline void fold_constants() { g->foldConstants(); }
+
     //------ runtime
 
     inline void data_malloc() { g->dataMalloc(); }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/graph.h"
+#include <functional>
 namespace infini {
 class SubGraphObj : public GraphObj {
     TensorVec ins;  // inputs from outer predecessors, orders are appointed.
@@ -75,14 +76,26 @@ using MatchGraph = Ref<GraphMatchObj>;
 
 class SubGraphRewriter {
     SubGraph pattern;
-    Graph graph;
+    GraphObj *graph;
 
   public:
-    SubGraphRewriter(Graph g) : graph(g) {}
+    SubGraphRewriter(Graph g) : graph(g.get()) {}
+    explicit SubGraphRewriter(GraphObj *g) : graph(g) {}
     vector<MatchGraph> findMatch(const SubGraph &pattern);
     void replaceSubGraph(const SubGraph &pattern, const SubGraph &replacement);
     TensorVec addSubGraph(const SubGraph &pattern, const TensorVec &inputs);
 
+    /**
+     * @brief Replace the decomposed LayerNorm chain
+     * ReduceMean-Sub-Pow-ReduceMean-Add-Sqrt-Div-Mul[-Add] and the RMSNorm
+     * chain Pow-ReduceMean-Add-Sqrt-Div-Mul over the trailing axes with
+     * LayerNormObj and RMSNormObj. The exponent and the epsilon have to be
+     * loaded scalar weights.
+     *
+     * @return The number of fused chains.
+     */
+    int fuseNormalization();
+
   private:
     void removeSubGraph(MatchGraph match);
     bool MatchNode(const Operator &a, const Operator &b, bool isHead,
@@ -104,5 +117,12 @@ class SubGraphRewriter {
         const MatchGraph &match,
         const std::unordered_set<Operator> &nodesToDelete) const;
     bool checkMatchValid(const MatchGraph &match) const;
+    // Replace every match of `pattern` for which `fuse` returns an operator
+    // with that operator.
+    int replaceMatches(const SubGraph &pattern,
+                       const std::function<Operator(MatchGraph)> &fuse);
+    // Fuse the chains over `axes` of inputs of rank `rank`
+    int fuseLayerNorm(int rank, const vector<int> &axes, bool withBias);
+    int fuseRMSNorm(int rank, const vector<int> &axes);
 };
 }; // namespace infini
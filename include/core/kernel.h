@@ -2,8 +2,12 @@
 #include "core/common.h"
 #include "core/operator.h"
 #include "core/tensor.h"
+#include <algorithm>
 #include <functional>
+#include <list>
+#include <mutex>
 #include <nlohmann/json.hpp>
+#include <shared_mutex>
 using json = nlohmann::json;
 namespace infini {
 
@@ -14,13 +18,17 @@ struct PerfRecordObj {
     PerfRecordObj(double time) : time(time){};
     virtual ~PerfRecordObj(){};
     double time = 0; // in milliseconds
+    // Name of the kernel that the record was tuned for among the kernels of
+    // its KernelAttrs. Records without one, e.g. from files saved before
+    // kernels were named, belong to the default kernel.
+    string kernel;
     virtual void to_json(json &j) {
         j["type"] = 0;
         j["data"] = time;
     }
     static Ref<PerfRecordObj> from_json(const json &j) {
         PerfRecordObj tmp;
-        tmp.time = j["data"].get<int>();
+        tmp.time = j["data"].get<double>();
         return make_ref<PerfRecordObj>(tmp);
     }
 };
@@ -46,6 +54,20 @@ class Kernel {
     // Premise: op is idempotent since it is called multiple times.
     virtual PerfRecord tune(const Operator &op,
                             const RuntimeObj *context) const = 0;
+    /**
+     * @brief Whether compute() reads input `index` of `op` through the
+     * strides of the tensor, which may be a strided view. Otherwise
+     * GraphObj::dataMalloc makes the input contiguous.
+     */
+    virtual bool supportsStridedInput(const Operator &op, int index) const {
+        return false;
+    }
+    /**
+     * @brief Whether the kernel can compute `op`, e.g. for kernels that are
+     * specialized for some shapes. Tuning times all applicable kernels
+     * registered for an operator.
+     */
+    virtual bool isApplicable(const Operator &op) const { return true; }
 };
 
 class PerfRecordRegistry {
@@ -69,48 +91,150 @@ class PerfRecordRegistry {
         nperfrecord++;
         return true;
     }
+    bool hasConstructor(const int type) const {
+        return perfrecords.find(type) != perfrecords.end();
+    }
     const std::function<PerfRecord(const json &)> &
     getConstructor(const int type) const {
         return perfrecords.at(type);
     }
 };
 
+/**
+ * @brief The kernels of all devices. Several kernels may be registered for
+ * the same KernelAttrs. Without a tuned record, the applicable kernel with
+ * the highest priority runs, and the earliest registered one of equal
+ * priorities. Kernels are registered during static initialization but may
+ * also be registered later, e.g. by a plugin, while graphs are running, so
+ * lookups take a shared lock.
+ */
 class KernelRegistry {
   public:
-    using KernelRecord =
-        tuple<Kernel *const, const string, const int>; // Kernel, name, ID
+    using KernelRecord = tuple<Kernel *const, const string, const int,
+                               const int>; // Kernel, name, ID, priority
 
   private:
-    std::map<KernelAttrs, KernelRecord> kernels;
+    // Records are never removed, so references to them stay valid
+    std::map<KernelAttrs, std::list<KernelRecord>> kernels;
     int nKernels = 0;
+    mutable std::shared_mutex mutex;
+
+    const std::list<KernelRecord> &
+    getCandidates(const KernelAttrs &kernelAttrs) const {
+        auto it = kernels.find(kernelAttrs);
+        IT_ASSERT(it != kernels.end(),
+                  "Kernel not found for key {" +
+                      to_string(enum_to_underlying(std::get<0>(kernelAttrs))) +
+                      ", " + std::to_string(std::get<1>(kernelAttrs)) + ", " +
+                      std::get<2>(kernelAttrs).toString() + "}");
+        return it->second;
+    }
 
   public:
     ~KernelRegistry() {
         for (auto &[k, v] : kernels)
-            delete std::get<0>(v);
+            for (auto &record : v)
+                delete std::get<0>(record);
     }
     static KernelRegistry &getInstance() {
         static KernelRegistry instance;
         return instance;
     }
-    bool registerKernel(const KernelAttrs &key, Kernel *kernel, string name) {
-        // TODO: mutliple kernels support: priority and check name
-        IT_ASSERT(kernels.find(key) == kernels.end(),
-                  "Kernel already registered");
-        kernels.emplace(key, KernelRecord{kernel, name, ++nKernels});
+    bool registerKernel(const KernelAttrs &key, Kernel *kernel, string name,
+                        int priority = 0) {
+        std::unique_lock lock(mutex);
+        auto &candidates = kernels[key];
+        for (auto &record : candidates)
+            IT_ASSERT(std::get<1>(record) != name,
+                      "Kernel " + name + " already registered");
+        // Keep the candidates sorted by decreasing priority
+        auto it = std::find_if(
+            candidates.begin(), candidates.end(),
+            [&](const KernelRecord &r) { return std::get<3>(r) < priority; });
+        candidates.emplace(it, kernel, name, ++nKernels, priority);
         return true;
     }
+    /**
+     * @brief The kernel of the highest priority, regardless of whether it
+     * can compute a particular operator.
+     */
     Kernel *getKernel(const KernelAttrs &kernelAttrs) const {
-        auto it = kernels.find(kernelAttrs);
-        IT_ASSERT(it != kernels.end(),
-                  "Kernel not found for key {" +
-                      to_string(enum_to_underlying(std::get<0>(kernelAttrs))) +
-                      ", " + std::to_string(std::get<1>(kernelAttrs)) + ", " +
-                      std::get<2>(kernelAttrs).toString() + "}");
-        return std::get<0>(it->second);
+        return std::get<0>(getKernelItem(kernelAttrs));
+    }
+    Kernel *getKernel(const KernelAttrs &kernelAttrs,
+                      const Operator &op) const {
+        return std::get<0>(getKernelItem(kernelAttrs, op));
+    }
+    bool hasKernel(const KernelAttrs &kernelAttrs) const {
+        std::shared_lock lock(mutex);
+        return kernels.find(kernelAttrs) != kernels.end();
+    }
+    bool hasKernel(const KernelAttrs &kernelAttrs, const Operator &op) const {
+        return !getKernelItems(kernelAttrs, op).empty();
     }
     const KernelRecord &getKernelItem(const KernelAttrs &kernelAttrs) const {
-        return kernels.at(kernelAttrs);
+        std::shared_lock lock(mutex);
+        return getCandidates(kernelAttrs).front();
+    }
+    // The applicable kernel of the highest priority
+    const KernelRecord &getKernelItem(const KernelAttrs &kernelAttrs,
+                                      const Operator &op) const {
+        auto items = getKernelItems(kernelAttrs, op);
+        IT_ASSERT(!items.empty(),
+                  "No kernel is applicable to " + op->toString());
+        return *items.front();
+    }
+    // The kernel named `name`, or nullptr if there is none
+    const KernelRecord *getKernelItem(const KernelAttrs &kernelAttrs,
+                                      const string &name) const {
+        std::shared_lock lock(mutex);
+        auto it = kernels.find(kernelAttrs);
+        if (it != kernels.end())
+            for (auto &record : it->second)
+                if (std::get<1>(record) == name)
+                    return &record;
+        return nullptr;
+    }
+    /**
+     * @brief The kernel that `record` was tuned for, or the applicable kernel
+     * of the highest priority if `record` is nullptr or names no registered
+     * kernel.
+     */
+    const KernelRecord &getKernelItem(const KernelAttrs &kernelAttrs,
+                                      const Operator &op,
+                                      const PerfRecord &record) const {
+        if (record && !record->kernel.empty())
+            if (auto item = getKernelItem(kernelAttrs, record->kernel))
+                return *item;
+        return getKernelItem(kernelAttrs, op);
+    }
+    // The applicable kernels by decreasing priority
+    vector<const KernelRecord *> getKernelItems(const KernelAttrs &kernelAttrs,
+                                                const Operator &op) const {
+        std::shared_lock lock(mutex);
+        vector<const KernelRecord *> ret;
+        auto it = kernels.find(kernelAttrs);
+        if (it != kernels.end())
+            for (auto &record : it->second)
+                if (std::get<0>(record)->isApplicable(op))
+                    ret.emplace_back(&record);
+        return ret;
+    }
+    /**
+     * @brief Tune every applicable kernel of `op` and return the record of
+     * the fastest one, which names its kernel.
+     */
+    PerfRecord tune(const KernelAttrs &kernelAttrs, const Operator &op,
+                    const RuntimeObj *context) const {
+        PerfRecord best;
+        for (auto item : getKernelItems(kernelAttrs, op)) {
+            auto record = std::get<0>(*item)->tune(op, context);
+            record->kernel = std::get<1>(*item);
+            if (!best || record->time < best->time)
+                best = record;
+        }
+        IT_ASSERT(best, "No kernel is applicable to " + op->toString());
+        return best;
     }
 };
 
@@ -131,15 +255,25 @@ class CpuKernelWithoutConfig : public Kernel {
 
 } // namespace infini
 
-#define _REGISTER_KERNEL_1(device, opType, dataType, kernel, name, cnt)        \
+#define _REGISTER_KERNEL_1(device, opType, dataType, kernel, name, priority,  \
+                           cnt)                                                \
     namespace infini {                                                         \
     static const bool _CAT(_register_kernel_, cnt) =                           \
         KernelRegistry::getInstance().registerKernel(                          \
-            KernelAttrs{device, opType, dataType}, new kernel(), name);        \
+            KernelAttrs{device, opType, dataType}, new kernel(), name,         \
+            priority);                                                         \
     }
 
 #define REGISTER_KERNEL(device, opType, dataType, kernel, name)                \
-    _REGISTER_KERNEL_1(device, opType, dataType, kernel, name, __COUNTER__)
+    _REGISTER_KERNEL_1(device, opType, dataType, kernel, name, 0, __COUNTER__)
+
+// Register one of several kernels of an operator, which tuning chooses from
+// per shape. Without tuning, the applicable kernel of the highest priority
+// runs.
+#define REGISTER_KERNEL_WITH_PRIORITY(device, opType, dataType, kernel, name,  \
+                                      priority)                                \
+    _REGISTER_KERNEL_1(device, opType, dataType, kernel, name, priority,       \
+                       __COUNTER__)
 
 #define _REGISTER_CONSTRUCTOR_1(type, constructor, cnt)                        \
     namespace infini {                                                         \
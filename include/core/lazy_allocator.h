@@ -10,12 +10,25 @@
 
 namespace infini {
 
+// How GraphObj::dataMalloc assigns memory to non-weight tensors
+enum class MemoryPlanStrategy {
+    // Allocate and free while simulating the execution in topological order
+    Online,
+    // Plan all lifetimes up front and place the largest blocks first
+    GreedyBySize,
+    // Plan all lifetimes up front and place the blocks live at the steps
+    // with the most live memory first
+    GreedyByBreadth,
+};
+
 class LazyAllocator {
   private:
 #ifdef BUILD_TEST
     FRIEND_TEST(LazyAllocator, testMergeFreeBlocks);
 
     FRIEND_TEST(LazyAllocator, testAllocWithEndFreeBlock);
+
+    FRIEND_TEST(LazyAllocator, testPlanCache);
 #endif
 
     Runtime runtime;
@@ -26,17 +39,34 @@ class LazyAllocator {
 
     size_t weightPeak = 0;
 
+    // the largest total size of blocks live at the same step, known only
+    // after planning
+    size_t lowerBound = 0;
+
     size_t alignment;
 
     // pointer to the memory actually allocated
     void *ptr = nullptr;
 
+    // size of the memory actually allocated, which is kept across init as
+    // long as it is large enough for the current peak
+    size_t ptrSize = 0;
+
+    // whether getPtr has been called since init, after which the
+    // simulation can no longer free memory
+    bool materialized = false;
+
     // pointer to the weight memory space
     void *weightPtr = nullptr;
 
-    // // a cache designed for a batch size that has already occurred
-    // std::unordered_map<size_t, std::unordered_map<TensorObj *, size_t>>
-    // batchsizeToTensorOffset;
+    struct MemoryPlan {
+        // head address offset and size of every non-weight tensor
+        std::unordered_map<TensorObj *, std::pair<size_t, size_t>> tensors;
+        size_t peak, lowerBound;
+    };
+
+    // a cache of the plans for the input shapes that have already occurred
+    std::map<vector<Shape>, MemoryPlan> inputShapesToPlan;
 
     struct freeBlockInfo {
         size_t addr;
@@ -62,6 +92,12 @@ class LazyAllocator {
     std::unordered_map<size_t, size_t> tailAddrToBlockSize;
 
   public:
+    struct BlockLifetime {
+        size_t size;
+        // the first and the last step (inclusive) using the block
+        size_t firstStep, lastStep;
+    };
+
     LazyAllocator(Runtime runtime);
 
     virtual ~LazyAllocator();
@@ -82,13 +118,40 @@ class LazyAllocator {
     //     size: size of memory block to be freed
     void free(size_t addr, size_t size);
 
+    // function: offline memory planning, which places blocks with known
+    // lifetimes so that blocks live at the same step do not overlap. It
+    // replaces alloc and free, and must be called right after init.
+    // arguments:
+    //     blocks: size and lifetime of every memory block
+    //     strategy: the order in which blocks are placed
+    // return: head address offset of every memory block
+    vector<size_t> plan(const vector<BlockLifetime> &blocks,
+                        MemoryPlanStrategy strategy);
+
+    size_t getPeak() const { return peak; }
+
+    size_t getLowerBound() const { return lowerBound; }
+
     // function: perform actual memory allocation
     // return: pointer to the head address of the allocated memory
     void *getPtr();
 
-    // void addCache(size_t batchsize, std::unordered_map<TensorObj *, size_t>);
+    // function: remember the offsets of all non-weight tensors, together
+    // with the current peak, for the given input shapes
+    void addCache(const vector<Shape> &inputShapes,
+                  const std::unordered_map<TensorObj *, size_t> &offsets);
 
-    // std::unordered_map<TensorObj *, size_t> getCache(size_t batchsize);
+    // function: switch to the plan cached for the given input shapes, which
+    // reinitializes the allocator with the peak of that plan
+    // arguments:
+    //     inputShapes: shapes of the graph inputs
+    //     tensors: all non-weight tensors, each of which must match the
+    //              size it was planned with
+    // return: offsets of the tensors, or nullopt if no valid plan is cached
+    std::optional<vector<size_t>> getCache(const vector<Shape> &inputShapes,
+                                           const TensorVec &tensors);
+
+    void clearCache() { inputShapesToPlan.clear(); }
 
     void *getWeightPtr();
 
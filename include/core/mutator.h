@@ -30,6 +30,11 @@ class Mutator {
     virtual bool isMultiBranchMergable(const Graph &in_graph) {
         IT_TODO_HALT();
     }
+    /**
+     * @brief Whether run() may be called from several threads at once, so
+     * that SearchEngine mutates independent subgraphs in parallel.
+     */
+    virtual bool isThreadSafe() const { return false; }
 };
 
 } // namespace infini
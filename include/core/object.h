@@ -1,6 +1,7 @@
 #pragma once
 #include "core/common.h"
 #include "ref.h"
+#include <atomic>
 
 namespace infini {
 
@@ -19,8 +20,10 @@ class Uid {
 
 class Guid : public Uid {
   private:
+    // Atomic, since graphs may be built by several threads, e.g. by
+    // SearchEngine
     UidBaseType generateGuid() {
-        static UidBaseType guidCnt = 0;
+        static std::atomic<UidBaseType> guidCnt = 0;
         return ++guidCnt;
     }
 
@@ -35,7 +38,7 @@ class Guid : public Uid {
 class Fuid : public Uid {
   private:
     UidBaseType generateFuid() {
-        static UidBaseType fuidCnt = 0;
+        static std::atomic<UidBaseType> fuidCnt = 0;
         return ++fuidCnt;
     }
 
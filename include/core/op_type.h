@@ -231,6 +231,11 @@ struct OpType {
         AllReduceAvg,
         AllGather,
         Broadcast,
+
+        // Fused Ops
+        FusedElementWise,
+        RMSNorm,
+        Attention,
     } type;
 
     constexpr OpType(decltype(type) t) : type(t) {}
@@ -245,6 +250,7 @@ struct OpType {
     bool isUnary() const;
     bool isBinary() const;
     bool isElementWise() const;
+    bool isView() const;
     bool isCompair() const;
     bool isPool() const;
     bool isGlobalPool() const;
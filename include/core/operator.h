@@ -27,7 +27,7 @@ struct OpPerfKey {
         return true;
     }
 
-    // TODO: remove this function after we use unordered_map in PerfEngine
+    // Orders the records of PerfEngine::get_data
     bool operator<(const OpPerfKey &rhs) const {
         if (hash != rhs.hash)
             return hash < rhs.hash;
@@ -91,6 +91,12 @@ class OperatorObj : public Object {
     OpType getOpType() const { return type; }
     // HACK: set correct data type
     DataType getDType() const { return getInputs(0)->getDType(); }
+    /**
+     * @brief Whether this is a view operator whose output has been bound to
+     * the memory of its input by GraphObj::dataMalloc, possibly as a strided
+     * view, so that running it does nothing.
+     */
+    bool isAliasedView() const;
     virtual int numInputs() const = 0;
     virtual int numOutputs() const = 0;
 
@@ -1,22 +1,66 @@
 #pragma once
 #include "core/graph.h"
+#include "core/hash.h"
 #include "core/kernel.h"
+#include <array>
+#include <atomic>
+#include <functional>
+#include <future>
 #include <nlohmann/json_fwd.hpp>
+#include <shared_mutex>
+#include <unordered_map>
 using json = nlohmann::json;
 namespace infini {
 
+/**
+ * @brief The tuning records of all kernels. Records are spread over shards
+ * with their own readers-writer locks, so that graphs can run and tune from
+ * several threads at once.
+ */
 class PerfEngine {
   public:
-    // TODO: Key should be OpPerfKey + Context(maybe implicat) to support
-    // multiple candiate kernels.
+    // A record names the fastest of the kernels of its KernelAttrs
     using Key = std::pair<KernelAttrs, OpPerfKey>;
+    struct KeyHash {
+        size_t operator()(const Key &key) const {
+            auto &[device, opType, dataType] = key.first;
+            HashType h = hashAppend(enum_to_underlying(device), opType);
+            h = hashAppend(h, dataType.getIndex());
+            return hashAppend(h, std::hash<OpPerfKey>()(key.second));
+        }
+    };
+    using Map = std::unordered_map<Key, PerfRecord, KeyHash>;
+
+    /**
+     * @brief Version of the binary layout written by savePerfEngineData.
+     * Files of other versions are ignored by loadPerfEngineData.
+     */
+    static constexpr uint32_t SchemaVersion = 1;
+
     PerfEngine() = default;
     // PerfEngine is singleton
     PerfEngine(PerfEngine &other) = delete;
     PerfEngine &operator=(PerfEngine const &) = delete;
 
   private:
-    map<Key, PerfRecord> data;
+    static constexpr size_t NumShards = 16;
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        Map data;
+        // Tunings in progress, which other threads wait for
+        std::unordered_map<Key, std::shared_future<PerfRecord>, KeyHash>
+            tuning;
+    };
+    std::array<Shard, NumShards> shards;
+    // incremented on every change of the records
+    std::atomic<size_t> version{0};
+
+    Shard &getShard(const Key &key) {
+        return shards[KeyHash()(key) % NumShards];
+    }
+    const Shard &getShard(const Key &key) const {
+        return shards[KeyHash()(key) % NumShards];
+    }
 
   public:
     static PerfEngine &getInstance() {
@@ -29,22 +73,64 @@ class PerfEngine {
      *
      * @return PerfRecord nullptr if no record is fnoud.
      */
-    PerfRecord getPerfData(const Key &key) {
-        auto it = data.find(key);
-        if (it != data.end()) // find previous evaluating results
-            return data.at(key);
+    PerfRecord getPerfData(const Key &key) const {
+        auto &shard = getShard(key);
+        std::shared_lock lock(shard.mutex);
+        auto it = shard.data.find(key);
+        if (it != shard.data.end()) // find previous evaluating results
+            return it->second;
         else
             return nullptr;
     }
 
-    void setPerfData(const Key &key, PerfRecord record) {
-        IT_ASSERT(data.find(key) == data.end(), "Perf data already exist");
-        data.emplace(key, record);
+    /**
+     * @brief Store `record` unless there is a faster record of `key`, so that
+     * the results of several tuning runs can be merged.
+     *
+     * @return true if `record` is stored.
+     */
+    bool setPerfData(const Key &key, PerfRecord record);
+
+    /**
+     * @brief Get the record of `key`, calling `tune` to find and store it if
+     * there is none. If another thread is already tuning `key`, wait for its
+     * record instead of tuning again. An exception thrown by `tune` is
+     * rethrown in all waiting threads.
+     */
+    PerfRecord getOrTune(const Key &key,
+                         const std::function<PerfRecord()> &tune);
+    size_t getVersion() const {
+        return version.load(std::memory_order_acquire);
     }
-    map<Key, PerfRecord> get_data() { return data; }
-    void set_data(map<Key, PerfRecord> data) { this->data = data; }
-    void savePerfEngineData(std::string file_path);
-    void loadPerfEngineData(std::string file_path);
+    size_t size() const;
+    // The records ordered by key, e.g. for a stable JSON dump
+    map<Key, PerfRecord> get_data() const;
+    void set_data(const map<Key, PerfRecord> &data);
+    void clear();
+
+    /**
+     * @brief Append the records to the binary database `file_path`, which
+     * starts with a header of the schema version and the fingerprints of the
+     * host and the backends. Only the records that the file does not have,
+     * or has slower ones of, are written, so tuning processes can share a
+     * file: they take turns through an advisory lock of `file_path`.lock. A
+     * file with another header is replaced.
+     */
+    void savePerfEngineData(const string &file_path) const;
+    /**
+     * @brief Merge the records of the binary database `file_path`, keeping
+     * the fastest record of every key. A truncated last record, e.g. from an
+     * interrupted save, is ignored.
+     *
+     * @return false if the file does not exist, or was written with another
+     * schema version or on another host or build.
+     */
+    bool loadPerfEngineData(const string &file_path);
+
+    // CPU model and number of threads of this machine
+    static string getHostFingerprint();
+    // Compiler and the backends built into this library
+    static string getBackendFingerprint();
 };
 void to_json(json &j, const PerfEngine &p);
 void from_json(const json &j, PerfEngine &p);
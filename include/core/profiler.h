@@ -0,0 +1,143 @@
+#pragma once
+#include "core/common.h"
+#include "core/object.h"
+#include "core/op_type.h"
+#include "core/runtime.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace infini {
+
+/**
+ * @brief Records when every kernel of CpuRuntimeObj::run starts and ends.
+ *
+ * What an operator computes is described once per execution plan, so that
+ * recording a kernel only takes two steady-clock timestamps and appends them
+ * to a ring buffer without locking. Once the buffer is full, the oldest
+ * events are overwritten. The events can be exported as a Chrome trace or
+ * summarized per operator with the achieved GB/s and GFLOP/s.
+ */
+class Profiler {
+  public:
+    // What an operator computes, which the events refer to
+    struct OpInfo {
+        UidBaseType guid;
+        OpType type;
+        string kernel;
+        // input shapes, e.g. "[1,3,224,224],[64,3,7,7]"
+        string shapes;
+        size_t bytes;
+        double flops;
+    };
+
+    struct Event {
+        // steady-clock nanoseconds
+        int64_t begin, end;
+        // index of the OpInfo of the operator
+        uint32_t op;
+        // small number identifying the recording thread
+        uint32_t thread;
+    };
+
+  private:
+    // A seqlock: the writer makes `sequence` odd while it writes the fields,
+    // which are atomics so that a torn read is detected rather than racy
+    struct Slot {
+        // 2 * (index of the event in this slot) + 2, or + 1 while writing
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<int64_t> begin, end;
+        std::atomic<uint32_t> op, thread;
+    };
+
+    std::atomic<bool> enabled{false};
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity = 0; // a power of 2
+    std::atomic<uint64_t> head{0};
+    // Bumped whenever the descriptions are dropped, so that execution plans
+    // describe their operators again
+    size_t generation = 0;
+
+    mutable std::mutex mutex; // guards `ops`
+    vector<OpInfo> ops;
+
+    Profiler() = default;
+
+  public:
+    Profiler(Profiler &other) = delete;
+    Profiler &operator=(Profiler const &) = delete;
+
+    static Profiler &getInstance() {
+        static Profiler instance;
+        return instance;
+    }
+
+    /**
+     * @brief Drop all events and descriptions and start recording into a
+     * buffer of at least `capacity` events. Must not be called while a graph
+     * is running.
+     */
+    void enable(size_t capacity = 1 << 16);
+    void disable() { enabled.store(false, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    // Drop the recorded events but keep the descriptions
+    void clear();
+    size_t getGeneration() const { return generation; }
+
+    /**
+     * @brief Describe an operator run by `kernel` and return the index that
+     * its events refer to.
+     */
+    uint32_t describe(const Operator &op, const string &kernel);
+    OpInfo getOpInfo(uint32_t op) const;
+
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void record(uint32_t op, int64_t begin, int64_t end) {
+        const uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+        Slot &slot = slots[index & (capacity - 1)];
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.begin.store(begin, std::memory_order_relaxed);
+        slot.end.store(end, std::memory_order_relaxed);
+        slot.op.store(op, std::memory_order_relaxed);
+        slot.thread.store(getThreadId(), std::memory_order_relaxed);
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+    }
+
+    // Number of events recorded since enable() or clear(), including the
+    // overwritten ones
+    uint64_t getEventCount() const {
+        return head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief The events still in the buffer in the order of recording,
+     * starting from the `since`-th one. Events being recorded concurrently
+     * may be missing.
+     */
+    vector<Event> getEvents(uint64_t since = 0) const;
+
+    /**
+     * @brief The events in the Chrome trace event format, which can be
+     * opened in chrome://tracing or Perfetto.
+     */
+    string toChromeTrace() const;
+    void saveChromeTrace(const string &path) const;
+
+    /**
+     * @brief A table of the events from the `since`-th one, with one row per
+     * operator sorted by total time.
+     */
+    string summary(uint64_t since = 0) const;
+
+  private:
+    static uint32_t getThreadId();
+};
+
+} // namespace infini
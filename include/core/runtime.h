@@ -15,6 +15,8 @@ class GraphObj;
 class GraphHandlerObj;
 class RuntimeObj;
 class BlobObj;
+class ThreadPool;
+struct ExecutionPlanObj;
 
 using TensorBase = Ref<TensorBaseObj>;
 using Tensor = Ref<TensorObj>;
@@ -23,6 +25,7 @@ using Graph = Ref<GraphObj>;
 using GraphHandler = Ref<GraphHandlerObj>;
 using Runtime = Ref<RuntimeObj>;
 using Blob = Ref<BlobObj>;
+using ExecutionPlan = Ref<ExecutionPlanObj>;
 
 using TensorVec = vector<Tensor>;
 using OpVec = vector<Operator>;
@@ -51,7 +54,12 @@ class RuntimeObj : public std::enable_shared_from_this<RuntimeObj> {
      * @param graph
      * @param tune If there is no performance record, whether to tune it. These
      * can be independent method.
-     * @param profiling Whether to print breakdown of time
+     * @param profiling Whether to print breakdown of time. On the CPU, the
+     * kernels are recorded by Profiler, which is enabled for this run if it
+     * is not already.
+     *
+     * Different graphs may run at the same time from several threads, also
+     * with tuning. Each key is then tuned by only one of them.
      */
     virtual void run(const Graph &graph, bool tune = false,
                      bool profiling = false) const = 0;
@@ -80,6 +88,7 @@ class RuntimeObj : public std::enable_shared_from_this<RuntimeObj> {
                                size_t bytes) const = 0;
     virtual string toString() const = 0;
 
+    Device getDevice() const { return device; }
     int getDeviceId() const { return deviceId; }
 
     virtual void initComm(const string &name, int worldSize, int rank) = 0;
@@ -92,15 +101,45 @@ class RuntimeObj : public std::enable_shared_from_this<RuntimeObj> {
                             const std::map<OpType, int> &opCnt) const;
     virtual void copyBlobInsideRuntime(void *dst, const void *src,
                                        size_t bytes) const = 0;
+
+  protected:
+    /**
+     * @brief Get the execution plan of a graph on this runtime, building it
+     * if the graph has none and refreshing its records if PerfEngine has
+     * changed since.
+     */
+    ExecutionPlan getExecutionPlan(const Graph &graph) const;
+    /**
+     * @brief Describe the operators of `plan` to Profiler, unless they have
+     * been described since it was last enabled.
+     */
+    void describeSteps(ExecutionPlanObj &plan) const;
 };
 
 class CpuRuntimeObj : public RuntimeObj {
+    // Workers running independent operators concurrently, or null to run
+    // operators one by one in topological order
+    Ref<ThreadPool> interOpPool;
+
   public:
     CpuRuntimeObj(Device dev) : RuntimeObj(dev) {}
 
     void run(const Graph &graph, bool tune = false,
              bool profiling = false) const override;
 
+    /**
+     * @brief Split the cores between operators and kernels. With more than
+     * one inter-op thread, run() starts every operator once the operators
+     * producing its inputs, and those using memory it overwrites, have
+     * finished. Outputs are the same as in serial execution. Runs with
+     * tuning stay serial so that kernels are timed in isolation.
+     *
+     * @param interOpThreads Number of operators running at the same time.
+     * @param intraOpThreads Number of OpenMP threads of each operator. 0
+     * divides the cores evenly among the inter-op threads.
+     */
+    void setParallelism(int interOpThreads, int intraOpThreads = 0);
+
     void copyBlobFromCPU(void *dst, const void *src,
                          size_t bytes) const override;
     void copyBlobToCPU(void *dst, const void *src, size_t bytes) const override;
@@ -109,6 +148,10 @@ class CpuRuntimeObj : public RuntimeObj {
     void initComm(const string &, int, int) override { IT_TODO_HALT(); }
 
     CommunicatorObj &getCommunicator() const override { IT_TODO_HALT(); }
+
+  private:
+    void runSerial(const Graph &graph, bool tune) const;
+    void runParallel(const Graph &graph) const;
 };
 
 class NativeCpuRuntimeObj : public CpuRuntimeObj {
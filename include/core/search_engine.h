@@ -1,9 +1,12 @@
 #pragma once
 
 #include "common.h"
+#include "cost_model.h"
 #include "graph.h"
 #include "mutator.h"
+#include "thread_pool.h"
 
+#include <thread>
 #include <unordered_map>
 
 namespace infini {
@@ -23,6 +26,18 @@ class SearchEngine {
     size_t partitionThreshold =
         3;                  // cut nodes whose #in + #out >= partitionThreshold
     size_t GRAPH_SIZE = 16; // num of best graphs.
+    // threads hashing and costing candidates, and mutating subgraphs if the
+    // mutator is thread-safe
+    int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    // If set, candidates are ranked by it first and only the best
+    // numFinalists are measured
+    CostModel costModel;
+    size_t numFinalists = 32;
+
+  private: // State of a search
+    Ref<ThreadPool> pool; // created on first use
+    // Costs of the candidates by hashGraph, which are valid during a run()
+    std::unordered_map<HashType, double> costCache;
 
   private: // Composed objects
     std::shared_ptr<Mutator> mutationEngine;
@@ -53,6 +68,21 @@ class SearchEngine {
 
     Graph run(const Graph graph);                  // entrance of search engine.
     std::vector<Graph> search(const Graph &graph); // search for a partition.
+    void setNumThreads(int n) {
+        IT_ASSERT(n > 0);
+        numThreads = n;
+        pool = nullptr;
+    }
+    /**
+     * @brief Estimate candidates with `model` and measure only the best
+     * `finalists` of them, which have to be at least GRAPH_SIZE. nullptr
+     * measures every candidate.
+     */
+    void setCostModel(CostModel model, size_t finalists = 32) {
+        IT_ASSERT(finalists >= GRAPH_SIZE);
+        costModel = std::move(model);
+        numFinalists = finalists;
+    }
 
   private:
     std::vector<Graph> partitionGraph(const Graph graph);
@@ -70,6 +100,28 @@ class SearchEngine {
     std::vector<Graph>
     searchMutation(const std::shared_ptr<MetaGraph> &metaGraph);
 
+    /**
+     * @brief The sum of the perf times of the operators of every graph. The
+     * costs are memoized by hashGraph, and operators without a perf record
+     * are tuned on the calling thread, so that kernels are timed in
+     * isolation. Tensors are allocated only for tuning.
+     */
+    std::vector<double> getCosts(const std::vector<Graph> &graphs);
+    // Sort `graphs` by cost and keep the best GRAPH_SIZE ones
+    void prune(std::vector<Graph> &graphs);
+    // Sort `graphs` by `costs` and keep the best `n` ones
+    static void keepBest(std::vector<Graph> &graphs,
+                         const std::vector<double> &costs, size_t n);
+    // The sum of the perf times if every operator has a perf record
+    std::optional<double> getRecordedTime(const Graph &graph) const;
+    /**
+     * @brief Hash the workloads of the operators of `graph` in order and the
+     * producer of every input, which determine its cost.
+     */
+    static HashType hashGraph(const Graph &graph);
+    // Call `func` for [0, n) on the thread pool and wait for all calls
+    void parallelFor(size_t n, const std::function<void(size_t)> &func);
+
     void printMetaGraph(Ref<SearchEngine::MetaGraph> metaGraph);
     /**
      * @brief Check whether a multi-brach graph can be merged into a single
@@ -21,6 +21,12 @@ class TensorObj : public TensorBaseObj {
     Fuid fuid;    // Cloned tensors share the same id. Tensors constructed from
                   // scratch have a new id.
     TensorType tensorType = TensorType::others;
+    // Strides of a view into the memory of another tensor, whose data blob
+    // points at the first element. Empty if laid out in row-major order.
+    Shape stride;
+    // Bumped when the data is written through this tensor, so that copies
+    // derived from the data, e.g. reordered weights, can be refreshed
+    mutable size_t dataVersion = 0;
 
   public:
     TensorObj(Shape shape, DataType dtype, Runtime runtime);
@@ -31,11 +37,35 @@ class TensorObj : public TensorBaseObj {
     size_t getBytes() const { return _size * dtype.getSize(); }
 
     Shape getDims() const { return shape; }
+    /**
+     * @brief Change the shape, e.g. of a graph input to run the graph with
+     * another batch size. The data has to be allocated again.
+     */
+    void setShape(Shape shape_);
     size_t getRank() const { return shape.size(); }
+    /**
+     * @brief The strides of the view if set by setStride, or else those of
+     * the row-major layout.
+     */
     Shape getStride() const;
+    /**
+     * @brief Make the tensor a strided view, or a row-major tensor again if
+     * `stride` is empty. Kernels read a strided view only if they declare
+     * so with Kernel::supportsStridedInput.
+     */
+    void setStride(Shape stride_);
+    bool isStrided() const { return !stride.empty(); }
+    // Whether the elements are laid out in row-major order without gaps
+    bool isContiguous() const;
+    /**
+     * @brief Bytes from the first element to the end of the last one in
+     * memory, which exceed getBytes() for views with gaps.
+     */
+    size_t getSpanBytes() const;
     size_t getOffset(const vector<int> &ds) const;
     void dataMalloc();
     UidBaseType getFuid() const { return fuid; }
+    size_t getDataVersion() const { return dataVersion; }
     bool isWeight() const { return tensorType == TensorType::weight; }
     bool isInput() const { return tensorType == TensorType::input; }
     bool isOutput() const { return tensorType == TensorType::output; }
@@ -69,6 +99,7 @@ class TensorObj : public TensorBaseObj {
 
     void copyin(const void *ptr, size_t size) {
         runtime->copyBlobFromCPU(getRawDataPtr<void *>(), ptr, size);
+        ++dataVersion;
     }
     void copyout(void *ptr, size_t size) const {
         runtime->copyBlobToCPU(ptr, getRawDataPtr<void *>(), size);
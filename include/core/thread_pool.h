@@ -0,0 +1,58 @@
+#pragma once
+#include "core/common.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace infini {
+
+/**
+ * @brief A fixed set of worker threads with one task queue per worker.
+ *
+ * A task submitted from a worker goes to the back of that worker's queue and
+ * is taken from the back again, so a chain of dependent tasks tends to stay on
+ * one thread and keep its data in cache. Idle workers steal from the front of
+ * the other queues.
+ */
+class ThreadPool {
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    vector<std::unique_ptr<WorkQueue>> queues;
+    vector<std::thread> workers;
+
+    // Sleeping workers wait for `pending` to become positive
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t pending = 0;
+    bool stopping = false;
+
+    // Queue of the next task submitted from outside the pool
+    size_t nextQueue = 0;
+
+  public:
+    /**
+     * @param numThreads The number of workers.
+     * @param initWorker Called once at the start of every worker, e.g. to set
+     * up thread-local OpenMP settings.
+     */
+    explicit ThreadPool(int numThreads,
+                        const std::function<void()> &initWorker = {});
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ~ThreadPool();
+
+    int getNumThreads() const { return workers.size(); }
+
+    void submit(std::function<void()> task);
+
+  private:
+    void workerLoop(int index, const std::function<void()> &initWorker);
+    bool popTask(int index, std::function<void()> &task);
+};
+
+} // namespace infini
@@ -0,0 +1,77 @@
+#pragma once
+#include "core/tensor.h"
+#include <array>
+
+namespace infini {
+
+/**
+ * @brief Index arithmetic of an N-d broadcast for the native CPU backend.
+ *
+ * The inputs are aligned to the rank of the output, and adjacent dimensions
+ * along which every input is either broadcast or laid out contiguously are
+ * merged together. Same-shape operands thus become a single dimension, and a
+ * row broadcast becomes two. Each input gets a stride per merged dimension,
+ * which is 0 along the dimensions it is broadcast on. The innermost stride is
+ * therefore 0 or 1 unless an input is a strided view.
+ */
+class BroadcastShape {
+    // Merged output dimensions, at least one
+    Shape dims;
+    // strides[i][d] is the stride of input i along the merged dimension d
+    vector<vector<size_t>> strides;
+
+  public:
+    /**
+     * @param inputStrides The strides of the inputs in elements, or empty if
+     * all of them are row-major.
+     */
+    BroadcastShape(const Shape &output, const vector<Shape> &inputs,
+                   const vector<Shape> &inputStrides = {});
+
+    int getRank() const { return dims.size(); }
+    const Shape &getDims() const { return dims; }
+    size_t getStride(int input, int dim) const { return strides[input][dim]; }
+    // Whether input `i` moves along the innermost dimension
+    bool isInnerContiguous(int input) const {
+        return strides[input].back() != 0;
+    }
+    size_t getInnerStride(int input) const { return strides[input].back(); }
+    size_t getInnerSize() const { return dims.back(); }
+    size_t getOuterSize() const;
+
+    /**
+     * @brief Call `f(outOffset, inOffsets, len)` on runs of at most `len`
+     * consecutive output elements along the innermost dimension, in
+     * parallel. `inOffsets[i]` is the offset of the first element of input
+     * `i` used by the run.
+     */
+    template <size_t N, typename F> void forEachRun(F &&f) const {
+        // Runs of this many elements amortize the offset computation and are
+        // big enough to be split across threads.
+        constexpr size_t RUN = 1 << 14;
+        IT_ASSERT(N == strides.size());
+        const int rank = dims.size();
+        const size_t inner = dims.back();
+        const size_t runsPerRow = (inner + RUN - 1) / RUN;
+        const size_t nRuns = getOuterSize() * runsPerRow;
+#pragma omp parallel for if (nRuns > 1 && nRuns * std::min(inner, RUN) >      \
+                                                 (1 << 15))
+        for (size_t task = 0; task < nRuns; ++task) {
+            size_t row = task / runsPerRow;
+            const size_t begin = task % runsPerRow * RUN;
+            std::array<size_t, N> in{};
+            for (size_t i = 0; i < N; ++i)
+                in[i] = begin * strides[i][rank - 1];
+            for (int d = rank - 2; d >= 0; --d) {
+                const size_t idx = row % dims[d];
+                row /= dims[d];
+                for (size_t i = 0; i < N; ++i)
+                    in[i] += idx * strides[i][d];
+            }
+            f(task / runsPerRow * inner + begin, in,
+              std::min(RUN, inner - begin));
+        }
+    }
+};
+
+} // namespace infini
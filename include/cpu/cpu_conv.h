@@ -0,0 +1,41 @@
+#pragma once
+#include "core/kernel.h"
+
+namespace infini {
+
+/**
+ * @brief Tuning record of the native CPU convolution, which selects one of
+ * several algorithms for each convolution shape.
+ */
+struct ConvCpuPerfRecordObj : public PerfRecordObj {
+    enum Algo {
+        // Heuristic choice of the algorithms below, used without tuning
+        Auto,
+        // Unfold the input and multiply it with the weight by cpuGemm.
+        // Pointwise convolutions skip the unfolding. Always applicable.
+        Im2colGemm,
+        // Direct convolution vectorized over blocks of output channels with
+        // the weight pre-packed in FCRS[f] blocks. Only for ungrouped 1x1 and
+        // 3x3 convolutions.
+        DirectBlocked,
+        // Per-channel sliding window. Only for depthwise convolutions.
+        Depthwise,
+        NumAlgo,
+    };
+    int algo = Auto;
+
+    void to_json(json &j) override {
+        j["type"] = 3;
+        j["data"] = std::make_pair(algo, time);
+    }
+    static PerfRecord from_json(const json &j) {
+        ConvCpuPerfRecordObj tmp;
+        auto [algo, time] = j["data"].get<pair<int, double>>();
+        tmp.algo = algo;
+        tmp.time = time;
+        return make_ref<ConvCpuPerfRecordObj>(tmp);
+    }
+};
+using ConvCpuPerfRecord = Ref<ConvCpuPerfRecordObj>;
+
+} // namespace infini
@@ -0,0 +1,34 @@
+#pragma once
+#include "core/tensor.h"
+
+namespace infini {
+
+/**
+ * @brief Copy an N-d view to another for the native CPU backend:
+ * dst[sum(i[d] * dstStrides[d])] = src[sum(i[d] * srcStrides[d])] for every
+ * index i within `dims`. Strides are in elements. Source strides may be
+ * negative, or 0 to broadcast.
+ *
+ * Adjacent dimensions that are contiguous in both views are merged first.
+ * Rows that are contiguous in both become memcpy calls, a stride-1 dimension
+ * of one view that is strided in the other is copied by a cache-oblivious
+ * tiled transpose, and anything else by an element loop. The work is split
+ * across OpenMP threads.
+ *
+ * @param elemSize The size of an element in bytes, 1, 2, 4 or 8.
+ */
+void cpuStridedCopy(size_t elemSize, const Shape &dims, void *dst,
+                    const vector<int64_t> &dstStrides, const void *src,
+                    const vector<int64_t> &srcStrides);
+
+/**
+ * @brief The strides in elements of a contiguous row-major tensor.
+ */
+vector<int64_t> cpuContiguousStrides(const Shape &dims);
+
+/**
+ * @brief The strides in elements of a tensor, which may be a strided view.
+ */
+vector<int64_t> cpuStrides(const Tensor &tensor);
+
+} // namespace infini
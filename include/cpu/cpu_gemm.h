@@ -0,0 +1,36 @@
+#pragma once
+#include "core/op_type.h"
+#include <cstddef>
+
+namespace infini {
+
+/**
+ * @brief Row-major single-matrix GEMM for the native CPU backend:
+ * C = op(A) * op(B) (+ C if `accumulate`), followed by `act` applied to every
+ * element of C.
+ *
+ * A and B are packed into cache-sized panels and computed by a register-blocked
+ * microkernel. On x86-64, AVX-512 and AVX2 microkernels are selected at run
+ * time if the host supports them; other data types and hosts use a portable
+ * scalar microkernel. Output tiles are computed in parallel with OpenMP.
+ *
+ * @param transA If true, A is stored as [k, m] and transposed on the fly.
+ * @param transB If true, B is stored as [n, k] and transposed on the fly.
+ * @param lda Leading dimension (row stride in elements) of A as stored.
+ * @param ldb Leading dimension of B as stored.
+ * @param ldc Leading dimension of C.
+ * @param accumulate If true, the product is added to the existing content of
+ * C, which can be used to fuse a pre-filled bias.
+ * @param act The activation applied to C after the product.
+ */
+template <typename T>
+void cpuGemm(bool transA, bool transB, int m, int n, int k, const T *A,
+             int lda, const T *B, int ldb, T *C, int ldc,
+             bool accumulate = false, ActType act = ActType::None);
+
+/**
+ * @brief Apply an activation in place to `size` contiguous elements.
+ */
+template <typename T> void cpuApplyAct(T *data, size_t size, ActType act);
+
+} // namespace infini
@@ -0,0 +1,266 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace infini {
+
+// The functions below compute every value and then pick one with cpuSelect.
+// GCC sinks floating-point operations into the arm of a ?: that uses them,
+// and does not speculate them back under the default -ftrapping-math, which
+// would keep loops scalar.
+
+// cond ? a : b as a bit mask
+inline float cpuSelect(bool cond, float a, float b) {
+    int32_t ia, ib;
+    std::memcpy(&ia, &a, sizeof(ia));
+    std::memcpy(&ib, &b, sizeof(ib));
+    const int32_t mask = -static_cast<int32_t>(cond);
+    ia = (ia & mask) | (ib & ~mask);
+    std::memcpy(&a, &ia, sizeof(a));
+    return a;
+}
+
+inline float cpuClamp(float x, float lo, float hi) {
+    const bool below = x < lo, above = x > hi;
+    return cpuSelect(below, lo, cpuSelect(above, hi, x));
+}
+
+inline float cpuAbs(float x) {
+    int32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    bits &= 0x7fffffff;
+    std::memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+// |magnitude| with the sign of `sign`
+inline float cpuCopySign(float magnitude, float sign) {
+    int32_t m, s;
+    std::memcpy(&m, &magnitude, sizeof(m));
+    std::memcpy(&s, &sign, sizeof(s));
+    m = (m & 0x7fffffff) | (s & ~0x7fffffff);
+    std::memcpy(&magnitude, &m, sizeof(magnitude));
+    return magnitude;
+}
+
+/**
+ * @brief Splits x = n * ln2 + r with |r| <= ln2 / 2 for the exponential
+ * functions below. Returns expm1(r) and sets `scale` to 2^n. The input is
+ * clamped to [-87.3, 88.3], so that 2^n stays a normal float.
+ */
+inline float cpuExpSplit(float x, float &scale) {
+    constexpr float LOG2E = 1.44269504f, LN2_HI = 0.693359375f,
+                    LN2_LO = -2.12194440e-4f;
+    x = cpuClamp(x, -87.3f, 88.3f);
+    // Adding 0.5 and truncating rounds to the nearest n for both signs once
+    // the bias of 127 is added.
+    const int32_t n = static_cast<int32_t>(x * LOG2E + 127.5f) - 127;
+    const float fn = static_cast<float>(n);
+    const float r = x - fn * LN2_HI - fn * LN2_LO;
+    float p = 1.f / 5040;
+    p = p * r + 1.f / 720;
+    p = p * r + 1.f / 120;
+    p = p * r + 1.f / 24;
+    p = p * r + 1.f / 6;
+    p = p * r + 0.5f;
+    p = p * r + 1.f;
+    // 2^n built from the exponent bits
+    const int32_t bits = (n + 127) << 23;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * r;
+}
+
+/**
+ * @brief exp(x) in single precision, within 2 ulp of std::exp for normal
+ * results. It is written with plain arithmetic and selects, so that loops
+ * under `#pragma omp simd` are vectorized instead of calling libm for every
+ * element. The same holds for the other functions in this file. Results
+ * below the smallest normal float flush to zero and inputs above 88.3
+ * saturate at about 2^127.
+ */
+inline float cpuExp(float x) {
+    float scale;
+    const float e = (cpuExpSplit(x, scale) + 1.f) * scale;
+    const bool underflow = x < -87.3f;
+    return cpuSelect(underflow, 0.f, e);
+}
+
+/**
+ * @brief exp(x) - 1, within 3 ulp of std::expm1. Unlike cpuExp(x) - 1 it
+ * keeps full precision for small |x|.
+ */
+inline float cpuExpm1(float x) {
+    float scale;
+    const float e = cpuExpSplit(x, scale) * scale + (scale - 1.f);
+    const bool underflow = x < -87.3f;
+    return cpuSelect(underflow, -1.f, e);
+}
+
+/**
+ * @brief Natural logarithm, within 1 ulp of std::log. x = 2^e * (1 + f) with
+ * 1 + f in [sqrt(2) / 2, sqrt(2)), and log(1 + f) is evaluated from
+ * s = f / (2 + f) as in fdlibm. Returns -inf for 0, NaN for negative inputs
+ * and inf for inf.
+ */
+inline float cpuLog(float x) {
+    constexpr float LN2_HI = 0.693359375f, LN2_LO = -2.12194440e-4f;
+    // Subnormal inputs are scaled by 2^23 into the normal range
+    const float scaled = x * 8388608.f;
+    const bool subnormal = x < 1.17549435e-38f;
+    const float y = cpuSelect(subnormal, scaled, x);
+    int32_t bits;
+    std::memcpy(&bits, &y, sizeof(bits));
+    // Mantissas of at least sqrt(2) carry into the exponent, which moves
+    // the mantissa into [sqrt(2) / 2, sqrt(2)).
+    const int32_t ix = bits + (0x3f800000 - 0x3f3504f3);
+    const int32_t e = (ix >> 23) - 127 - (subnormal ? 23 : 0);
+    const int32_t mbits = (ix & 0x007fffff) + 0x3f3504f3;
+    float m;
+    std::memcpy(&m, &mbits, sizeof(m));
+    const float f = m - 1.f, s = f / (2.f + f), z = s * s;
+    float r = 2.f / 11;
+    r = r * z + 2.f / 9;
+    r = r * z + 2.f / 7;
+    r = r * z + 2.f / 5;
+    r = r * z + 2.f / 3;
+    r *= z;
+    const float hfsq = 0.5f * f * f, fe = static_cast<float>(e);
+    const float result =
+        fe * LN2_HI + ((f - (hfsq - s * (hfsq + r))) + fe * LN2_LO);
+    constexpr float INF = std::numeric_limits<float>::infinity(),
+                    NaN = std::numeric_limits<float>::quiet_NaN();
+    const bool positive = x > 0.f, inf = x == INF, zero = x == 0.f;
+    return cpuSelect(positive, cpuSelect(inf, INF, result),
+                     cpuSelect(zero, -INF, NaN));
+}
+
+/**
+ * @brief Hyperbolic tangent, within 4 ulp of std::tanh. It is computed as
+ * sign(x) * E / (E + 2) with E = expm1(2|x|), which has no cancellation near
+ * 0 and saturates at +-1.
+ */
+inline float cpuTanh(float x) {
+    const float e = cpuExpm1(2.f * cpuAbs(x));
+    return cpuCopySign(e / (e + 2.f), x);
+}
+
+/**
+ * @brief Logistic sigmoid 1 / (1 + exp(-x)), within 3 ulp for results above
+ * the smallest normal float. exp is only taken of -|x|, so it never
+ * overflows and the small results for negative x keep full precision.
+ */
+inline float cpuSigmoid(float x) {
+    const float e = cpuExp(-cpuAbs(x));
+    const float s = 1.f / (1.f + e), es = e * s;
+    const bool negative = x < 0.f;
+    return cpuSelect(negative, es, s);
+}
+
+/**
+ * @brief Splits x^2 = head + tail, where head is exact because it squares the
+ * upper 12 bits of the mantissa of x. exp(-x^2) is then taken as
+ * exp(-head) * exp(-tail) so that the large exponent loses no precision.
+ */
+inline float cpuSquareSplit(float x, float &tail) {
+    int32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    bits &= ~0xfff;
+    float head;
+    std::memcpy(&head, &bits, sizeof(head));
+    tail = (x - head) * (x + head);
+    return head * head;
+}
+
+/**
+ * @brief erfc(x) for 0.8 <= x <= 10 given x^2 = sqHead + sqTail, from the
+ * Chebyshev fit of erfc(x) * exp(x^2) in t = 1 / (1 + x / 2) given in
+ * Numerical Recipes. Its coefficients alternate in sign and cancel, so the
+ * polynomial is summed in double.
+ */
+inline float cpuErfcTail(float x, float sqHead, float sqTail) {
+    const double t = 1. / (1. + 0.5 * x);
+    double p = 0.17087277;
+    p = p * t - 0.82215223;
+    p = p * t + 1.48851587;
+    p = p * t - 1.13520398;
+    p = p * t + 0.27886807;
+    p = p * t - 0.18628806;
+    p = p * t + 0.09678418;
+    p = p * t + 0.37409196;
+    p = p * t + 1.00002368;
+    p = p * t - 1.26551223;
+    return static_cast<float>(t) * cpuExp(-sqHead) *
+           cpuExp(static_cast<float>(p - sqTail));
+}
+
+/**
+ * @brief erf(x) - x for |x| < 0.8 from the Taylor series, whose truncation
+ * error is below 2^-28 relative to erf(x). Leaving out the leading x keeps
+ * the rounding of the remaining terms small against the result.
+ */
+inline float cpuErfSmall(float x) {
+    const float z = x * x;
+    float p = 1.f / (40320 * 17);
+    p = -p * z + 1.f / (5040 * 15);
+    p = -p * z + 1.f / (720 * 13);
+    p = -p * z + 1.f / (120 * 11);
+    p = -p * z + 1.f / (24 * 9);
+    p = -p * z + 1.f / (6 * 7);
+    p = -p * z + 1.f / (2 * 5);
+    p = -p * z + 1.f / 3;
+    p *= -z;
+    // 2 / sqrt(pi) = 1 + 0.12837917
+    return x * (0.128379167f + 1.12837917f * p);
+}
+
+/**
+ * @brief erfc(x) for |x| <= 10 given x^2 = sqHead + sqTail. Large x has no
+ * cancellation, unlike 1 - erf(x).
+ */
+inline float cpuErfcSplit(float x, float sqHead, float sqTail) {
+    const float ax = cpuAbs(x);
+    const float small = 1.f - (x + cpuErfSmall(x)),
+                tail = cpuErfcTail(ax, sqHead, sqTail), reflected = 2.f - tail;
+    const bool isSmall = ax < 0.8f, negative = x < 0.f;
+    return cpuSelect(isSmall, small, cpuSelect(negative, reflected, tail));
+}
+
+/// @brief Error function, within 2 ulp of std::erf.
+inline float cpuErf(float x) {
+    x = cpuClamp(x, -10.f, 10.f);
+    const float ax = cpuAbs(x);
+    float sqTail;
+    const float sqHead = cpuSquareSplit(ax, sqTail);
+    const float small = x + cpuErfSmall(x),
+                large = cpuCopySign(1.f - cpuErfcTail(ax, sqHead, sqTail), x);
+    const bool isSmall = ax < 0.8f;
+    return cpuSelect(isSmall, small, large);
+}
+
+/**
+ * @brief Complementary error function, within 5 ulp of std::erfc for
+ * results above the smallest normal float.
+ */
+inline float cpuErfc(float x) {
+    x = cpuClamp(x, -10.f, 10.f);
+    float sqTail;
+    const float sqHead = cpuSquareSplit(x, sqTail);
+    return cpuErfcSplit(x, sqHead, sqTail);
+}
+
+/**
+ * @brief GELU with the exact erf form, x * erfc(-x / sqrt(2)) / 2, within
+ * 7 ulp for results above the smallest normal float. The square
+ * of the erfc argument is split from x itself, since rounding x / sqrt(2)
+ * would be amplified through exp(-x^2 / 2).
+ */
+inline float cpuGelu(float x) {
+    const float y = cpuClamp(x, -14.f, 14.f);
+    float sqTail;
+    const float sqHead = cpuSquareSplit(y, sqTail);
+    return 0.5f * x *
+           cpuErfcSplit(-0.707106781f * y, 0.5f * sqHead, 0.5f * sqTail);
+}
+
+} // namespace infini
@@ -0,0 +1,95 @@
+#pragma once
+#include "core/operator.h"
+#include "intelcpu/mkl_runtime.h"
+#include <mutex>
+
+namespace infini {
+
+/**
+ * @brief oneDNN primitives with their arguments, executed in order. The
+ * memory objects are bound to the buffers of the tensors, so the primitives
+ * can only be reused while the tensors stay at the same addresses.
+ */
+struct MklPrimitivesObj {
+    vector<dnnl::primitive> prims;
+    vector<std::unordered_map<int, dnnl::memory>> args;
+
+    void add(dnnl::primitive prim, std::unordered_map<int, dnnl::memory> arg) {
+        prims.emplace_back(std::move(prim));
+        args.emplace_back(std::move(arg));
+    }
+    void execute(const dnnl::stream &stream) const {
+        for (size_t i = 0; i < prims.size(); ++i)
+            prims[i].execute(stream, args[i]);
+    }
+};
+using MklPrimitives = Ref<MklPrimitivesObj>;
+
+/**
+ * @brief The primitives created by a kernel. Creating the descriptors and
+ * reorders often costs more than executing them, so they are created once
+ * per operator configuration and set of tensor addresses.
+ */
+class MklPrimitiveCache {
+  public:
+    struct Key {
+        OpPerfKey perfKey;
+        // What the OpPerfKey does not cover, e.g. the algorithm or the dims
+        // of broadcast inputs
+        vector<int> attrs;
+        vector<void *> ptrs;
+
+        bool operator<(const Key &rhs) const {
+            return std::tie(perfKey, attrs, ptrs) <
+                   std::tie(rhs.perfKey, rhs.attrs, rhs.ptrs);
+        }
+    };
+
+    /**
+     * @brief Build the key of `op` from its OpPerfKey, `attrs`, the dims of
+     * its inputs and the addresses of its inputs and outputs.
+     */
+    static Key getKey(const Operator &op, vector<int> attrs = {}) {
+        Key key{op->getOpPerfKey(), std::move(attrs), {}};
+        for (auto &input : op->getInputs()) {
+            auto dims = input->getDims();
+            key.attrs.emplace_back(dims.size());
+            key.attrs.insert(key.attrs.end(), dims.begin(), dims.end());
+            key.ptrs.emplace_back(input->getRawDataPtr<void *>());
+        }
+        for (auto &output : op->getOutputs())
+            key.ptrs.emplace_back(output->getRawDataPtr<void *>());
+        return key;
+    }
+
+    /**
+     * @brief Get the primitives of `key`, or call `create` to create them.
+     * Nothing is cached if `create` returns nullptr.
+     */
+    template <typename F>
+    MklPrimitives getOrCreate(const Key &key, F &&create) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = cache.find(key);
+            if (it != cache.end())
+                return it->second;
+        }
+        MklPrimitives prims = create();
+        if (!prims)
+            return nullptr;
+        std::lock_guard<std::mutex> lock(mutex);
+        // Entries of tensors that have moved, e.g. after the memory plan is
+        // changed, are never hit again
+        if (cache.size() >= MAX_ENTRIES)
+            cache.clear();
+        cache.emplace(key, prims);
+        return prims;
+    }
+
+  private:
+    static constexpr size_t MAX_ENTRIES = 256;
+    std::mutex mutex;
+    std::map<Key, MklPrimitives> cache;
+};
+
+} // namespace infini
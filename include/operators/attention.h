@@ -0,0 +1,50 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini {
+/**
+ * @brief Scaled dot-product attention,
+ * output = softmax(query * key^T * scale + mask) * value, where the softmax
+ * is taken along the last axis.
+ *
+ */
+class AttentionObj : public OperatorObj {
+    float scale;
+
+  public:
+    /**
+     * @brief Construct a new Attention object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param query The query tensor of shape [..., S_q, D].
+     * @param key The key tensor of shape [..., S_k, D].
+     * @param value The value tensor of shape [..., S_k, D_v].
+     * @param output The output tensor of shape [..., S_q, D_v].
+     * @param mask The optional mask added to the scores, which is
+     * unidirectionally broadcastable to [..., S_q, S_k].
+     * @param scale The factor of the scores. Default is 1 / sqrt(D).
+     */
+    AttentionObj(GraphObj *graph, Tensor query, Tensor key, Tensor value,
+                 Tensor output, Tensor mask = nullptr,
+                 optional<float> scale = std::nullopt);
+    OP_CLONE(AttentionObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+
+    std::string toString() const override;
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+
+    float getScale() const { return scale; }
+    Tensor getMask() const { return inputs.size() > 3 ? inputs[3] : nullptr; }
+
+    /**
+     * @brief Whether `mask` is unidirectionally broadcastable to the shape
+     * of the scores `scores`.
+     */
+    static bool isMaskShape(const Shape &mask, const Shape &scores);
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+};
+} // namespace infini
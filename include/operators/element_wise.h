@@ -51,6 +51,59 @@ class MSELossObj : public OperatorObj {
     vector<int> getOpAttrVector() const override;
 };
 
+/**
+ * @brief A chain of element-wise operators evaluated in a single loop, created
+ * by GraphObj::optimize(). The intermediate results stay in registers instead
+ * of being written to memory.
+ *
+ */
+class FusedElementWiseObj : public OperatorObj {
+  public:
+    /**
+     * @brief One step of the fused program. Operands are input indices if
+     * non-negative, or `~i` for the result of the i-th instruction. Unary
+     * instructions ignore `rhs`.
+     */
+    struct Instruction {
+        OpType type;
+        int lhs, rhs;
+    };
+    // The most inputs the CPU kernel supports
+    static constexpr int MAX_INPUTS = 8;
+
+  private:
+    vector<Instruction> program;
+
+  public:
+    /**
+     * @brief Construct a new FusedElementWise object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param inputs The input tensors, which are broadcast to the output.
+     * @param output The output tensor, i.e. the result of the last
+     * instruction.
+     * @param program The instructions in execution order.
+     */
+    FusedElementWiseObj(GraphObj *graph, TensorVec inputs, Tensor output,
+                        vector<Instruction> program);
+    OP_CLONE(FusedElementWiseObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+
+    std::string toString() const override;
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+    const vector<Instruction> &getProgram() const { return program; }
+
+    /**
+     * @brief Whether an operator of the type can be part of a fused program.
+     */
+    static bool isFusable(OpType type);
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+};
+
 #define DEFINE_ELEMENT_WISE_OBJ(prefix, type)                                  \
     class prefix##Obj : public ElementWiseObj {                                \
       public:                                                                  \
@@ -0,0 +1,77 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini {
+/**
+ * @brief The base class of normalizations over the trailing axes of the
+ * input, i.e. LayerNorm and RMSNorm. The scale and the bias either have the
+ * normalized shape, possibly with leading 1s, or a single element.
+ *
+ */
+class LayerNormBaseObj : public OperatorObj {
+    float eps;
+    int axis; // the first normalized axis
+
+  public:
+    /**
+     * @brief Construct a new normalization object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param opType Operator type of this normalization.
+     * @param inputs The input tensor, the scale tensor and the optional bias
+     * tensor.
+     * @param output The output tensor, which has the shape of the input.
+     * @param eps The epsilon added to the variance to avoid division by zero.
+     * @param axis The first normalized axis. All the axes from it on are
+     * normalized together.
+     */
+    LayerNormBaseObj(GraphObj *graph, OpType opType, TensorVec inputs,
+                     Tensor output, float eps, int axis);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+
+    std::string toString() const override;
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+
+    float getEps() const { return eps; }
+    int getAxis() const { return axis; }
+    Tensor getScale() const { return inputs[1]; }
+    Tensor getBias() const { return inputs.size() > 2 ? inputs[2] : nullptr; }
+    // Number of elements normalized together
+    size_t getNormalizedSize() const;
+
+    /**
+     * @brief Whether `param` can be the scale or the bias of a normalization
+     * over the trailing axes `normalized`.
+     */
+    static bool isParamShape(const Shape &param, const Shape &normalized);
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+};
+
+/**
+ * @brief Layer normalization, see https://arxiv.org/abs/1607.06450.
+ * y = (x - mean) / sqrt(var + eps) * scale + bias.
+ *
+ */
+class LayerNormObj : public LayerNormBaseObj {
+  public:
+    LayerNormObj(GraphObj *graph, Tensor input, Tensor scale, Tensor output,
+                 Tensor bias = nullptr, float eps = 1e-5, int axis = -1);
+    OP_CLONE(LayerNormObj);
+};
+
+/**
+ * @brief Root mean square normalization, see
+ * https://arxiv.org/abs/1910.07467. y = x / sqrt(mean(x^2) + eps) * scale.
+ *
+ */
+class RMSNormObj : public LayerNormBaseObj {
+  public:
+    RMSNormObj(GraphObj *graph, Tensor input, Tensor scale, Tensor output,
+               float eps = 1e-6, int axis = -1);
+    OP_CLONE(RMSNormObj);
+};
+} // namespace infini
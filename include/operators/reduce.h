@@ -0,0 +1,56 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini {
+/**
+ * @brief The base class for reductions of the input tensor's elements along
+ * certain axes, e.g. ReduceMean and ReduceSum.
+ *
+ */
+class ReduceBaseObj : public OperatorObj {
+    set<int> axes; // axis to reduce
+    bool keepDims;
+
+  public:
+    /**
+     * @brief Construct a new Reduce object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param opType Operator type of this reduction.
+     * @param input The input tensor.
+     * @param output The output tensor.
+     * @param axes Axes to reduce. All the axes are reduced if not given.
+     * @param keepDims Keep the reduced dimensions or not.
+     */
+    ReduceBaseObj(GraphObj *graph, OpType opType, Tensor input, Tensor output,
+                  const optional<vector<int>> &axes, bool keepDims);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+
+    std::string toString() const override;
+    int numInputs() const override { return 1; }
+    int numOutputs() const override { return 1; }
+
+    bool isReduced(int idx) const;
+    const set<int> &getAxes() const { return axes; }
+    bool getKeepDims() const { return keepDims; }
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+};
+
+#define DEFINE_REDUCE_OBJ(prefix, type)                                        \
+    class prefix##Obj : public ReduceBaseObj {                                 \
+      public:                                                                  \
+        prefix##Obj(GraphObj *graph, Tensor input, Tensor output,              \
+                    const optional<vector<int>> &axes, bool keepDims = true)   \
+            : ReduceBaseObj(graph, type, input, output, axes, keepDims) {}     \
+        OP_CLONE(prefix##Obj);                                                 \
+    };
+
+DEFINE_REDUCE_OBJ(ReduceMean, OpType::ReduceMean)
+DEFINE_REDUCE_OBJ(ReduceSum, OpType::ReduceSum)
+DEFINE_REDUCE_OBJ(ReduceMax, OpType::ReduceMax)
+DEFINE_REDUCE_OBJ(ReduceMin, OpType::ReduceMin)
+DEFINE_REDUCE_OBJ(ReduceL2, OpType::ReduceL2)
+}; // namespace infini
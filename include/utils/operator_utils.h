@@ -10,6 +10,12 @@ namespace infini {
 Shape infer_broadcast(const Shape &A, const Shape &B);
 // Launch the real axis based on rank and current axis
 int get_real_axis(const int &axis, const int &rank);
+// Estimate the floating-point operations of running `op`, e.g. 2mnk for a
+// MatMul and one per output element for element-wise operators
+double get_flops(const Operator &op);
+// The bytes of all inputs and outputs of `op`, which a kernel reads or writes
+// at least once
+size_t get_io_bytes(const Operator &op);
 } // namespace infini
 
 #endif
@@ -13,8 +13,11 @@ from onnx.helper import (
     make_tensor,
     make_graph,
     make_model,
+    make_opsetid,
 )
 from onnx.checker import (
+    C as checker_c,
+    DEFAULT_CONTEXT,
     check_graph,
     check_model,
     check_node,
@@ -22,6 +25,7 @@ from onnx.checker import (
     check_tensor,
     ValidationError,
 )
+from onnx.defs import onnx_opset_version
 from onnx.shape_inference import infer_shapes
 from onnx.numpy_helper import to_array
 from typing import Dict, List, Any, Tuple, Sequence, Union, Optional
@@ -29,6 +33,14 @@ from functools import reduce
 from onnxsim import simplify
 import copy
 
+# The domain of the contrib operators of ONNX Runtime, e.g.
+# SimplifiedLayerNormalization that RMSNorm is exported as
+MS_DOMAIN = "com.microsoft"
+_OPSET_IMPORTS = {"": onnx_opset_version(), MS_DOMAIN: 1}
+_checker_context = checker_c.CheckerContext()
+_checker_context.ir_version = DEFAULT_CONTEXT.ir_version
+_checker_context.opset_imports = _OPSET_IMPORTS
+
 
 class OnnxStub:
     """
@@ -231,6 +243,76 @@ class OnnxStub:
                         eps,
                         training != 0,
                     )
+                elif node.op_type in [
+                    "LayerNormalization",
+                    "SimplifiedLayerNormalization",
+                ]:
+                    # Only the normalized output is supported, not the saved
+                    # mean and inverse standard deviation.
+                    assert all(output == "" for output in node.output[1:])
+                    attributes = _parse_attribute(
+                        node, {"axis": -1, "epsilon": 1e-05}
+                    )
+                    (axis, eps) = (attributes[name] for name in ["axis", "epsilon"])
+                    if node.op_type == "LayerNormalization":
+                        tensors[node.output[0]] = self.handler.layerNormalization(
+                            tensors[node.input[0]],
+                            tensors[node.input[1]],
+                            tensors.get(node.output[0]),
+                            tensors[node.input[2]]
+                            if len(node.input) > 2 and node.input[2] != ""
+                            else None,
+                            eps,
+                            axis,
+                        )
+                    else:
+                        tensors[node.output[0]] = self.handler.rmsNorm(
+                            tensors[node.input[0]],
+                            tensors[node.input[1]],
+                            tensors.get(node.output[0]),
+                            eps,
+                            axis,
+                        )
+                elif node.op_type == "Attention":
+                    # Only the ONNX operator on 4D inputs without the causal
+                    # mask, the soft cap, the KV cache and the extra outputs
+                    # is supported, with a float mask of scores to add.
+                    assert node.domain == ""
+                    attributes = _parse_attribute(
+                        node,
+                        {
+                            "scale": None,
+                            "is_causal": 0,
+                            "softcap": 0.0,
+                            "qk_matmul_output_mode": 0,
+                        },
+                    )
+                    assert attributes["is_causal"] == 0
+                    assert attributes["softcap"] == 0.0
+                    assert attributes["qk_matmul_output_mode"] == 0
+                    # The heads of 3D inputs
+                    assert "q_num_heads" not in attributes
+                    assert "kv_num_heads" not in attributes
+                    assert len(node.input) <= 4
+                    assert all(output == "" for output in node.output[1:])
+                    assert all(
+                        len(tensors[name].shape()) == 4 for name in node.input[:3]
+                    )
+                    if len(node.input) > 3 and node.input[3] != "":
+                        assert (
+                            backend.tensor_dtype(tensors[node.input[3]])
+                            == TensorProto.FLOAT
+                        )
+                    tensors[node.output[0]] = self.handler.attention(
+                        tensors[node.input[0]],
+                        tensors[node.input[1]],
+                        tensors[node.input[2]],
+                        tensors.get(node.output[0]),
+                        tensors[node.input[3]]
+                        if len(node.input) > 3 and node.input[3] != ""
+                        else None,
+                        attributes["scale"],
+                    )
                 elif node.op_type == "MaxPool":
                     attributes = _parse_attribute(
                         node,
@@ -562,19 +644,34 @@ class OnnxStub:
                             0,
                         ),
                     )
-                elif node.op_type == "ReduceMean":
-                    tensors[node.output[0]] = self.handler.reduce_mean(
+                elif node.op_type in [
+                    "ReduceMean",
+                    "ReduceMax",
+                    "ReduceMin",
+                    "ReduceL2",
+                ] or (
+                    node.op_type == "ReduceSum"
+                    and not any(attr.name == "communicator" for attr in node.attribute)
+                ):
+                    reduce = {
+                        "ReduceMean": self.handler.reduce_mean,
+                        "ReduceSum": self.handler.reduce_sum,
+                        "ReduceMax": self.handler.reduce_max,
+                        "ReduceMin": self.handler.reduce_min,
+                        "ReduceL2": self.handler.reduce_l2,
+                    }[node.op_type]
+                    # `axes` is an attribute until opset 13 for ReduceSum and
+                    # until opset 18 for the others, and an input since then.
+                    axes = next(
+                        (attr.ints for attr in node.attribute if attr.name == "axes"),
+                        None,
+                    )
+                    if axes is None and len(node.input) > 1 and node.input[1] != "":
+                        axes = _parse_data(data[node.input[1]])
+                    tensors[node.output[0]] = reduce(
                         tensors[node.input[0]],
                         tensors.get(node.output[0]),
-                        # NOTE(constroy): `axes` is an attribute until opset version 13.
-                        next(
-                            (
-                                attr.ints
-                                for attr in node.attribute
-                                if attr.name == "axes"
-                            ),
-                            None,
-                        ),
+                        axes,
                         next(
                             (
                                 attr.i
@@ -632,8 +729,7 @@ class OnnxStub:
                         next((attr.i for attr in node.attribute if attr.name == "to")),
                     )
                 elif node.op_type == "ReduceSum":
-                    # ReduceSum is only implemented as allReduceSum.
-                    assert any(attr.name == "communicator" for attr in node.attribute)
+                    # ReduceSum with a communicator stands for allReduceSum.
                     tensors[node.output[0]] = self.handler.allReduceSum(
                         tensors[node.input[0]],
                         tensors.get(node.output[0]),
@@ -750,6 +846,11 @@ class OnnxStub:
                 #     assert False, "Unsupported Tensor Type: {}".format(tensor.data_type)
                 obj.copyin_numpy(to_array(tensor))
 
+        # evaluate the operators that only depend on initializers, e.g. shape
+        # computations, and remove the ones that reach no output
+        self.handler.fold_constants()
+        self.handler.data_malloc()
+
         for output in model.graph.output:
             self.outputs[output.name] = tensors[output.name]
 
@@ -822,16 +923,24 @@ class OnnxStub:
                 return name
 
             def push_node(self, node: NodeProto) -> None:
-                check_node(node)
+                check_node(node, _checker_context)
                 self.nodes.append(node)
 
             def build(self, name: str) -> ModelProto:
                 graph = make_graph(
                     self.nodes, name, self.inputs, self.outputs, self.initializers
                 )
-                check_graph(graph)
+                check_graph(graph, _checker_context)
 
-                model = make_model(graph)
+                # Only the domains of the nodes are imported
+                domains = {""} | {node.domain for node in self.nodes}
+                model = make_model(
+                    graph,
+                    opset_imports=[
+                        make_opsetid(domain, _OPSET_IMPORTS[domain])
+                        for domain in sorted(domains)
+                    ],
+                )
                 check_model(model)
 
                 return model
@@ -903,6 +1012,29 @@ class OnnxStub:
                         training_mode=training,
                     )
                 )
+            elif ty in [
+                backend.OpTypeId.LayerNormalization,
+                backend.OpTypeId.RMSNorm,
+            ]:
+                axis, eps = backend.layer_norm_attrs_of(op)
+                ctx.push_node(
+                    make_node(
+                        "LayerNormalization"
+                        if ty == backend.OpTypeId.LayerNormalization
+                        else "SimplifiedLayerNormalization",
+                        inputs,
+                        outputs,
+                        name,
+                        domain=None
+                        if ty == backend.OpTypeId.LayerNormalization
+                        else MS_DOMAIN,
+                        axis=axis,
+                        epsilon=eps,
+                    )
+                )
+            elif ty == backend.OpTypeId.Attention:
+                scale = backend.attention_scale_of(op)
+                ctx.push_node(make_node(ty.name, inputs, outputs, name, scale=scale))
             elif ty == backend.OpTypeId.MaxPool:
                 kh, kw, dh, dw, ph, pw, sh, sw, ceil_mode = backend.pool_attrs_of(op)
                 ctx.push_node(
@@ -999,8 +1131,14 @@ class OnnxStub:
             elif ty == backend.OpTypeId.Gather:
                 axis = backend.gather_axis_of(op)
                 ctx.push_node(make_node(ty.name, inputs, outputs, name, axis=axis))
-            elif ty == backend.OpTypeId.ReduceMean:
-                axes, keepdims = backend.reduce_mean_attrs_of(op)
+            elif ty in [
+                backend.OpTypeId.ReduceMean,
+                backend.OpTypeId.ReduceSum,
+                backend.OpTypeId.ReduceMax,
+                backend.OpTypeId.ReduceMin,
+                backend.OpTypeId.ReduceL2,
+            ]:
+                axes, keepdims = backend.reduce_attrs_of(op)
                 inputs.append(
                     ctx.push_data_input(
                         name, "axes", TensorProto.INT64, [len(axes)], axes
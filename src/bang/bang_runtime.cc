@@ -12,23 +12,25 @@ void BangRuntimeObj::runWithoutSync(const Graph &graph, bool tune = false,
     std::map<OpType, double> opTime;
     std::map<OpType, int> opCnt;
     for (auto &op : graph->getOperators()) {
+        if (op->isAliasedView())
+            continue;
         // HACK: set correct data type
         auto kernelAttrs =
             KernelAttrs{device, op->getOpType().underlying(), op->getDType()};
-        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
         auto perfKey = PerfEngine::Key{kernelAttrs, op->getOpPerfKey()};
         auto perfData = perfEngine.getPerfData(perfKey);
         if (!perfData && !tune) {
-            kernel->compute(op, this);
+            kernelRegistry.getKernel(kernelAttrs, op)->compute(op, this);
             continue;
         }
 
-        PerfRecord record;
-        if (!perfData) {
-            record = kernel->tune(op, this);
-            perfEngine.setPerfData(perfKey, record);
-        } else
-            record = perfData;
+        PerfRecord record = perfData;
+        if (!record)
+            record = perfEngine.getOrTune(perfKey, [&]() {
+                return kernelRegistry.tune(kernelAttrs, op, this);
+            });
+        Kernel *kernel =
+            std::get<0>(kernelRegistry.getKernelItem(kernelAttrs, op, record));
 
         double t = record->time;
         totalTime += t;
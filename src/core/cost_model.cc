@@ -0,0 +1,71 @@
+#include "core/cost_model.h"
+#include "core/runtime.h"
+#include "operators/matmul.h"
+#include "operators/unary.h"
+#include "utils/operator_utils.h"
+#include <algorithm>
+
+namespace infini {
+
+double CostModelObj::getCost(const Graph &graph) const {
+    double cost = 0;
+    for (auto &op : graph->getOperators())
+        if (!op->isAliasedView())
+            cost += getCost(op);
+    return cost;
+}
+
+RooflineCostModelObj::RooflineCostModelObj(double peakGflops,
+                                           double bandwidthGBps,
+                                           double overheadMs)
+    : peakGflops(peakGflops), bandwidthGBps(bandwidthGBps),
+      overheadMs(overheadMs) {
+    IT_ASSERT(peakGflops > 0 && bandwidthGBps > 0 && overheadMs >= 0);
+}
+
+double RooflineCostModelObj::getCost(const Operator &op) const {
+    // 1 GFLOP/s and 1 GB/s are 1e6 per millisecond
+    const double computeMs = get_flops(op) / (peakGflops * 1e6),
+                 memoryMs = get_io_bytes(op) / (bandwidthGBps * 1e6);
+    return std::max(computeMs, memoryMs) + overheadMs;
+}
+
+// The best of a few runs of `g` in milliseconds. The data are left as
+// allocated, since the time does not depend on them.
+static double timeGraph(const Runtime &runtime, const Graph &g) {
+    g->dataMalloc();
+    // The first run touches the memory
+    runtime->run(g);
+    double best = INFINITY;
+    for (int i = 0; i < 5; ++i)
+        best = std::min(best, timeit([&]() { runtime->run(g); }, {}, 0, 1));
+    return best;
+}
+
+Ref<RooflineCostModelObj>
+RooflineCostModelObj::calibrate(const Runtime &runtime) {
+    Graph tiny = make_ref<GraphObj>(runtime);
+    tiny->addOp<ReluObj>(tiny->addTensor(Shape{1}), nullptr);
+    const double overheadMs = timeGraph(runtime, tiny);
+    // The time of a graph with one operator, without the overhead
+    auto timeKernel = [&](const Graph &g) {
+        return std::max(timeGraph(runtime, g) - overheadMs, 1e-6);
+    };
+
+    Graph gemm = make_ref<GraphObj>(runtime);
+    auto a = gemm->addTensor({1024, 1024}), b = gemm->addTensor({1024, 1024});
+    auto matmul = gemm->addOp<MatmulObj>(a, b, nullptr);
+    const double gemmMs = timeKernel(gemm);
+
+    // 64 MiB in and out, far beyond the caches
+    Graph stream = make_ref<GraphObj>(runtime);
+    auto relu =
+        stream->addOp<ReluObj>(stream->addTensor(Shape{1 << 24}), nullptr);
+    const double streamMs = timeKernel(stream);
+
+    return make_ref<RooflineCostModelObj>(
+        get_flops(matmul) / (gemmMs * 1e6),
+        get_io_bytes(relu) / (streamMs * 1e6), overheadMs);
+}
+
+} // namespace infini
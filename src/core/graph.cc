@@ -1,5 +1,16 @@
 #include "core/graph.h"
+#include "core/graph_match.h"
+#include "core/kernel.h"
+#include "operators/attention.h"
+#include "operators/batch_norm.h"
+#include "operators/conv.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/slice.h"
+#include "operators/softmax.h"
+#include "operators/transpose.h"
 #include <algorithm>
+#include <numeric>
 #include <queue>
 
 namespace infini {
@@ -29,6 +40,7 @@ GraphObj::GraphObj(Runtime runtime, OpVec ops_in)
 
 void GraphObj::addOperatorAndConnect(const Operator &op) {
     sorted = false;
+    invalidateCaches();
     ops.push_back(op);
     for (auto &input : op->getInputs()) {
         input->addTarget(op);
@@ -115,10 +127,478 @@ bool GraphObj::topo_sort() {
 }
 
 void GraphObj::optimize() {
-    for (auto &op : ops) {
-        switch (op->getOpType().underlying()) {
+    foldConstants();
+    // Fused operators rely on the bias and activation support of the native
+    // CPU kernels
+    if (runtime->getDevice() != Device::CPU)
+        return;
+    IT_ASSERT(topo_sort() == true);
+    foldBatchNormIntoConv();
+    // Before fuseBiasAndActivation, which would take the mask for a bias
+    fuseAttention();
+    fuseBiasAndActivation();
+    // Before fuseElementWise, which would break up the chains
+    if (SubGraphRewriter(this).fuseNormalization() > 0)
+        IT_ASSERT(topo_sort() == true);
+    fuseElementWise();
+    IT_ASSERT(topo_sort() == true);
+}
+
+// Whether the outputs of `op` can be computed when the graph is loaded
+static bool isFoldable(const Operator &op) {
+    for (auto &output : op->getOutputs())
+        if (output->isInput() || output->isOutput())
+            return false;
+    if (op->getOpType() == OpType::Shape) {
+        // Only the dims are read, but a graph input must keep a target
+        auto input = op->getInputs(0);
+        if (input->isInput() && input->getTargets().size() == 1)
+            return false;
+    } else {
+        for (auto &input : op->getInputs())
+            if (!input->isWeight() || input->getSource() || !input->hasData())
+                return false;
+    }
+    return KernelRegistry::getInstance().hasKernel(
+        {Device::CPU, op->getOpType().underlying(), op->getDType()}, op);
+}
+
+void GraphObj::foldConstants() {
+    IT_ASSERT(topo_sort() == true);
+    // Folded outputs have their own memory, which the first dataMalloc would
+    // replace with the weight memory
+    if (weightAllocated)
+        for (auto op : OpVec(ops))
+            if (isFoldable(op))
+                foldOperator(op);
+    eliminateDeadCode();
+}
+
+void GraphObj::foldOperator(const Operator &op) {
+    auto cpu = NativeCpuRuntimeObj::getInstance();
+    TensorVec inputs, outputs;
+    for (auto &input : op->getInputs()) {
+        auto tensor =
+            make_ref<TensorObj>(input->getDims(), input->getDType(), cpu);
+        tensor->dataMalloc();
+        if (input->hasData())
+            input->copyout(tensor->getRawDataPtr<void *>(), input->getBytes());
+        inputs.emplace_back(tensor);
+    }
+    for (auto &output : op->getOutputs()) {
+        auto tensor =
+            make_ref<TensorObj>(output->getDims(), output->getDType(), cpu);
+        tensor->dataMalloc();
+        outputs.emplace_back(tensor);
+    }
+    auto cpuOp = op->clone(inputs, outputs);
+    KernelRegistry::getInstance()
+        .getKernel({Device::CPU, op->getOpType().underlying(), op->getDType()},
+                   cpuOp)
+        ->compute(cpuOp, cpu.get());
+
+    for (auto &input : op->getInputs())
+        if (std::find(input->getTargets().begin(), input->getTargets().end(),
+                      op) != input->getTargets().end())
+            deleteConnection(input, op);
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        auto output = op->getOutput(i);
+        for (auto &succ : output->getTargets())
+            succ->removePredecessors(op);
+        output->setSource(nullptr);
+        output->setWeight();
+        output->freeData();
+        output->dataMalloc();
+        output->copyin(outputs[i]->getRawDataPtr<void *>(),
+                       output->getBytes());
+    }
+    removeOperator(op);
+    for (auto &input : op->getInputs())
+        if (input->isWeight() && !input->hasTarget())
+            removeTensor(input);
+}
+
+void GraphObj::eliminateDeadCode() {
+    // Without marked outputs every tensor without targets is an output
+    TensorVec liveTensors;
+    for (auto &tensor : tensors)
+        if (tensor->isOutput())
+            liveTensors.emplace_back(tensor);
+    if (liveTensors.empty())
+        return;
+    std::unordered_set<Operator> liveOps;
+    while (!liveTensors.empty()) {
+        auto source = liveTensors.back()->getSource();
+        liveTensors.pop_back();
+        if (source && liveOps.insert(source).second)
+            for (auto &input : source->getInputs())
+                liveTensors.emplace_back(input);
+    }
+    if (liveOps.size() == ops.size())
+        return;
+    for (auto op : OpVec(ops)) {
+        if (liveOps.count(op))
+            continue;
+        for (auto &input : op->getInputs())
+            if (std::find(input->getTargets().begin(),
+                          input->getTargets().end(),
+                          op) != input->getTargets().end())
+                deleteConnection(input, op);
+        removeOperator(op);
+    }
+    for (auto tensor : TensorVec(tensors)) {
+        auto source = tensor->getSource();
+        if (!tensor->hasTarget() && !tensor->isInput() &&
+            !tensor->isOutput() && (!source || !liveOps.count(source)))
+            removeTensor(tensor);
+    }
+}
+
+// Whether `tensor` is only read by `op` and can be dropped once its source is
+// fused into `op`.
+static bool isOnlyUsedBy(const Tensor &tensor, const Operator &op) {
+    if (tensor->isOutput())
+        return false;
+    for (auto &target : tensor->getTargets())
+        if (target != op)
+            return false;
+    return true;
+}
+
+// A constant tensor whose data can be read on the host
+static bool isLoadedWeight(const Tensor &tensor) {
+    return tensor->isWeight() && !tensor->getSource() && tensor->hasData() &&
+           tensor->getDType() == DataType::Float32;
+}
+
+static Ref<ConvObj> cloneConv(const Ref<ConvObj> &conv, const Tensor &weight,
+                              const Tensor &output, const Tensor &bias,
+                              ActType act) {
+    auto input = conv->getInputs(0);
+    auto [ph, pw, sh, sw, dh, dw] = conv->getPadStrideDilation();
+    auto mode = conv->getPaddingMode();
+    if (mode == ConvObj::PaddingMode::Other)
+        return make_ref<ConvObj>(nullptr, input, weight, output, ph, pw, sh, sw,
+                                 dh, dw, bias, act);
+    return make_ref<ConvObj>(nullptr, input, weight, output, mode, sh, sw, dh,
+                             dw, bias, act);
+}
+
+void GraphObj::replaceOperators(const OpVec &oldOps, const Operator &newOp) {
+    auto contains = [](const auto &vec, const auto &item) {
+        return std::find(vec.begin(), vec.end(), item) != vec.end();
+    };
+    TensorVec dropped;
+    for (auto &op : oldOps) {
+        for (auto &input : op->getInputs()) {
+            if (contains(input->getTargets(), op))
+                deleteConnection(input, op);
+            if (!contains(newOp->getInputs(), input))
+                dropped.emplace_back(input);
+        }
+        for (auto &output : op->getOutputs()) {
+            for (auto &succ : output->getTargets())
+                succ->removePredecessors(op);
+            if (!contains(newOp->getOutputs(), output))
+                dropped.emplace_back(output);
+        }
+        removeOperator(op);
+    }
+    for (auto &tensor : dropped) {
+        auto source = tensor->getSource();
+        if (!tensor->hasTarget() && (!source || contains(oldOps, source)))
+            removeTensor(tensor);
+    }
+    addOperatorAndConnect(newOp);
+}
+
+void GraphObj::foldBatchNormIntoConv() {
+    for (auto op : OpVec(ops)) {
+        if (op->getOpType() != OpType::BatchNormalization)
+            continue;
+        auto bn = as<BatchNormObj>(op);
+        auto x = bn->getInputs(0);
+        auto source = x->getSource();
+        if (bn->getTrainingMode() || !source ||
+            source->getOpType() != OpType::Conv || !isOnlyUsedBy(x, bn))
+            continue;
+        auto conv = as<ConvObj>(source);
+        auto weight = conv->getInputs(1), convBias = conv->getBias();
+        // The weight is scaled and the shift of BatchNorm is written into its
+        // bias in place, so neither may be shared
+        auto mean = bn->getInputs(1), var = bn->getInputs(2),
+             scale = bn->getInputs(3), shift = bn->getInputs(4);
+        if (conv->getAct() != ActType::None || !isLoadedWeight(weight) ||
+            !isOnlyUsedBy(weight, conv) || !isLoadedWeight(shift) ||
+            !isOnlyUsedBy(shift, bn) ||
+            (convBias && !isLoadedWeight(convBias)))
+            continue;
+        const size_t f = weight->getDims()[0], k = weight->size() / f;
+        if (!isLoadedWeight(mean) || !isLoadedWeight(var) ||
+            !isLoadedWeight(scale) || mean->size() != f || var->size() != f ||
+            scale->size() != f || shift->size() != f)
+            continue;
+
+        float *w = weight->getRawDataPtr<float *>();
+        float *b = shift->getRawDataPtr<float *>();
+        const float *m = mean->getRawDataPtr<float *>(),
+                    *v = var->getRawDataPtr<float *>(),
+                    *g = scale->getRawDataPtr<float *>(),
+                    *cb = convBias ? convBias->getRawDataPtr<float *>()
+                                   : nullptr;
+        for (size_t i = 0; i < f; ++i) {
+            const float factor = g[i] / std::sqrt(v[i] + bn->getEps());
+            for (size_t j = 0; j < k; ++j)
+                w[i * k + j] *= factor;
+            b[i] += ((cb ? cb[i] : 0.f) - m[i]) * factor;
+        }
+        replaceOperators({conv, bn}, cloneConv(conv, weight, bn->getOutput(),
+                                               shift, ActType::None));
+    }
+}
+
+void GraphObj::fuseAttention() {
+    auto isPlainMatmul = [](const Operator &op) {
+        if (op->getOpType() != OpType::MatMul)
+            return false;
+        auto matmul = as<MatmulObj>(op);
+        return !matmul->getTransA() && !matmul->getBias() &&
+               matmul->getAct() == ActType::None;
+    };
+    for (auto op : OpVec(ops)) {
+        if (op->getOpType() != OpType::Softmax)
+            continue;
+        // Walk MatMul(softmax(MatMul(Q, K^T) [/ or * scale] [+ mask]), V)
+        // backwards from Softmax
+        auto probs = op->getOutput();
+        const int rank = probs->getRank();
+        auto targets = probs->getTargets();
+        if (as<SoftmaxObj>(op)->getAxis() != rank - 1 || targets.size() != 1 ||
+            !isOnlyUsedBy(probs, targets[0]) || !isPlainMatmul(targets[0]) ||
+            targets[0]->getInputs(0) != probs ||
+            as<MatmulObj>(targets[0])->getTransB())
+            continue;
+        auto matmulPV = targets[0];
+        OpVec chain{op, matmulPV};
+        auto scores = op->getInputs(0);
+        auto source = scores->getSource();
+        Tensor mask;
+        float scale = 1;
+        if (source && source->getOpType() == OpType::Add &&
+            isOnlyUsedBy(scores, op)) {
+            // The operand from the product is the one that is not the mask
+            auto a = source->getInputs(0), b = source->getInputs(1);
+            auto fromChain = [&](const Tensor &t) {
+                auto s = t->getSource();
+                return s && isOnlyUsedBy(t, source) &&
+                       (s->getOpType() == OpType::MatMul ||
+                        s->getOpType() == OpType::Div ||
+                        s->getOpType() == OpType::Mul);
+            };
+            if (!fromChain(a))
+                std::swap(a, b);
+            if (a == b || !fromChain(a) ||
+                !(b->getDType() == DataType::Float32) ||
+                !AttentionObj::isMaskShape(b->getDims(), a->getDims()))
+                continue;
+            chain.emplace_back(source);
+            mask = b;
+            scores = a;
+            source = scores->getSource();
+        }
+        if (source &&
+            (source->getOpType() == OpType::Div ||
+             source->getOpType() == OpType::Mul) &&
+            isOnlyUsedBy(scores, chain.back())) {
+            auto a = source->getInputs(0), b = source->getInputs(1);
+            if (source->getOpType() == OpType::Mul &&
+                !(b->size() == 1 && isLoadedWeight(b)))
+                std::swap(a, b);
+            if (b->size() != 1 || !isLoadedWeight(b))
+                continue;
+            const float factor = b->getRawDataPtr<float *>()[0];
+            scale = source->getOpType() == OpType::Div ? 1 / factor : factor;
+            chain.emplace_back(source);
+            scores = a;
+            source = scores->getSource();
+        }
+        if (!source || !isPlainMatmul(source) ||
+            !isOnlyUsedBy(scores, chain.back()))
+            continue;
+        chain.emplace_back(source);
+        auto query = source->getInputs(0), key = source->getInputs(1),
+             value = matmulPV->getInputs(1);
+        if (!as<MatmulObj>(source)->getTransB()) {
+            // K^T has to come from a Transpose of the last two axes of K
+            auto transpose = key->getSource();
+            if (!transpose || transpose->getOpType() != OpType::Transpose ||
+                !isOnlyUsedBy(key, source))
+                continue;
+            vector<int> perm(rank);
+            std::iota(perm.begin(), perm.end(), 0);
+            std::swap(perm[rank - 2], perm[rank - 1]);
+            if (as<TransposeObj>(transpose)->getPermute() != perm)
+                continue;
+            chain.emplace_back(transpose);
+            key = transpose->getInputs(0);
+        }
+        // The products may broadcast their batch dims, but Attention
+        // does not
+        auto q = query->getDims(), k = key->getDims(), v = value->getDims();
+        if (q.size() != size_t(rank) || k.size() != q.size() ||
+            v.size() != q.size() ||
+            !std::equal(q.begin(), q.end() - 2, k.begin()) ||
+            !std::equal(q.begin(), q.end() - 2, v.begin()) ||
+            !(query->getDType() == DataType::Float32))
+            continue;
+        replaceOperators(chain, make_ref<AttentionObj>(
+                                    nullptr, query, key, value,
+                                    matmulPV->getOutput(), mask, scale));
+    }
+}
+
+void GraphObj::fuseBiasAndActivation() {
+    auto toActType = [](OpType type) {
+        switch (type.underlying()) {
+        case OpType::Relu:
+            return ActType::Relu;
+        case OpType::Sigmoid:
+            return ActType::Sigmoid;
+        case OpType::Tanh:
+            return ActType::Tanh;
         default:
-            break;
+            return ActType::None;
+        }
+    };
+    for (auto op : OpVec(ops)) {
+        auto type = op->getOpType();
+        if (type != OpType::MatMul && type != OpType::Conv)
+            continue;
+        // Absorb the consumers one at a time: a bias-add into MatMul, then an
+        // activation into MatMul or Conv
+        while (true) {
+            auto output = op->getOutput();
+            auto targets = output->getTargets();
+            if (targets.size() != 1 || !isOnlyUsedBy(output, targets[0]))
+                break;
+            auto next = targets[0];
+            auto nextOutput = next->getOutput();
+            Operator fused;
+            if (type == OpType::MatMul) {
+                auto matmul = as<MatmulObj>(op);
+                if (matmul->getAct() != ActType::None)
+                    break;
+                auto A = matmul->getInputs(0), B = matmul->getInputs(1),
+                     bias = matmul->getBias();
+                if (next->getOpType() == OpType::Add && !bias) {
+                    auto other = next->getInputs(0) == output
+                                     ? next->getInputs(1)
+                                     : next->getInputs(0);
+                    // The bias has to be broadcast to the output of MatMul
+                    if (other == output ||
+                        !(other->getDType() == output->getDType()) ||
+                        nextOutput->getDims() != output->getDims())
+                        break;
+                    fused = make_ref<MatmulObj>(
+                        nullptr, A, B, nextOutput, matmul->getTransA(),
+                        matmul->getTransB(), other, ActType::None);
+                } else if (auto act = toActType(next->getOpType());
+                           act != ActType::None) {
+                    fused = make_ref<MatmulObj>(
+                        nullptr, A, B, nextOutput, matmul->getTransA(),
+                        matmul->getTransB(), bias, act);
+                } else {
+                    break;
+                }
+            } else {
+                auto conv = as<ConvObj>(op);
+                auto act = toActType(next->getOpType());
+                if (conv->getAct() != ActType::None || act == ActType::None)
+                    break;
+                fused = cloneConv(conv, conv->getInputs(1), nextOutput,
+                                  conv->getBias(), act);
+            }
+            replaceOperators({op, next}, fused);
+            op = fused;
+        }
+    }
+}
+
+// The inputs and the program of an element-wise operator, as if it were a
+// FusedElementWiseObj
+static pair<TensorVec, vector<FusedElementWiseObj::Instruction>>
+getFusedProgram(const Operator &op) {
+    if (op->getOpType() == OpType::FusedElementWise)
+        return {op->getInputs(), as<FusedElementWiseObj>(op)->getProgram()};
+    if (op->getOpType().isBinary())
+        return {op->getInputs(), {{op->getOpType(), 0, 1}}};
+    return {op->getInputs(), {{op->getOpType(), 0, 0}}};
+}
+
+void GraphObj::fuseElementWise() {
+    using Instruction = FusedElementWiseObj::Instruction;
+    auto isFusable = [](const Operator &op) {
+        auto type = op->getOpType();
+        return op->getDType() == DataType::Float32 &&
+               (type == OpType::FusedElementWise ||
+                FusedElementWiseObj::isFusable(type));
+    };
+    // Operators are visited in topological order, so every producer has been
+    // fused with its own producers already.
+    for (auto op : OpVec(ops)) {
+        if (!isFusable(op))
+            continue;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            auto output = op->getOutput();
+            for (auto &tensor : op->getInputs()) {
+                auto producer = tensor->getSource();
+                if (!producer || !isFusable(producer) ||
+                    !isOnlyUsedBy(tensor, op) ||
+                    tensor->getDims() != output->getDims())
+                    continue;
+
+                // The producer's program comes first and the consumer reads
+                // its last result instead of `tensor`
+                auto [producerInputs, producerProgram] =
+                    getFusedProgram(producer);
+                auto [consumerInputs, consumerProgram] = getFusedProgram(op);
+                TensorVec inputs;
+                auto addInput = [&](const Tensor &t) {
+                    auto it = std::find(inputs.begin(), inputs.end(), t);
+                    if (it != inputs.end())
+                        return int(it - inputs.begin());
+                    inputs.emplace_back(t);
+                    return int(inputs.size()) - 1;
+                };
+                vector<Instruction> program;
+                vector<int> mapping;
+                for (auto &t : producerInputs)
+                    mapping.emplace_back(addInput(t));
+                for (auto [type, lhs, rhs] : producerProgram)
+                    program.push_back(
+                        {type, lhs >= 0 ? mapping[lhs] : lhs,
+                         rhs >= 0 ? mapping[rhs] : rhs});
+                const int result = ~int(producerProgram.size() - 1),
+                          shift = producerProgram.size();
+                mapping.clear();
+                for (auto &t : consumerInputs)
+                    mapping.emplace_back(t == tensor ? result : addInput(t));
+                for (auto [type, lhs, rhs] : consumerProgram)
+                    program.push_back(
+                        {type, lhs >= 0 ? mapping[lhs] : ~(~lhs + shift),
+                         rhs >= 0 ? mapping[rhs] : ~(~rhs + shift)});
+                if ((int)inputs.size() > FusedElementWiseObj::MAX_INPUTS)
+                    continue;
+
+                auto fused = make_ref<FusedElementWiseObj>(nullptr, inputs,
+                                                           output, program);
+                replaceOperators({producer, op}, fused);
+                op = fused;
+                changed = true;
+                break;
+            }
         }
     }
 }
@@ -126,16 +606,39 @@ void GraphObj::optimize() {
 void GraphObj::dataMalloc(bool useNaiveAllocator) {
     // topological sorting first
     IT_ASSERT(topo_sort() == true);
+    // dependencies between operators are derived from their memory
+    executionPlan = nullptr;
     if (useNaiveAllocator) {
         // used for debugging memory out-of-bounds access, tensors will not be
         // released correctly
         // note: behavior may not match running in non-naive mode, and it may
         // not reproduce the bug
         for (auto &tensor : tensors) {
+            tensor->setStride({});
             tensor->dataMalloc();
         }
         return;
     }
+    // outputs of view operators take the memory of their inputs
+    auto views = planViews();
+    // switch to the plan of the same input shapes if it is still valid
+    vector<Shape> inputShapes;
+    TensorVec nonWeightTensors;
+    for (auto &tensor : tensors) {
+        if (!tensor->isWeight()) {
+            nonWeightTensors.emplace_back(tensor);
+            if (!tensor->getSource())
+                inputShapes.emplace_back(tensor->getDims());
+        }
+    }
+    if (auto offsets = allocator.getCache(inputShapes, nonWeightTensors)) {
+        auto ptr = static_cast<uint8_t *>(allocator.getPtr());
+        for (size_t i = 0; i < nonWeightTensors.size(); ++i)
+            nonWeightTensors[i]->setDataBlob(
+                make_ref<BlobObj>(runtime, ptr + (*offsets)[i]));
+        return;
+    }
+
     // count the number of times all tensors are used
     std::unordered_map<TensorObj *, size_t> tensorToRefCount;
     // record the memory address offsets of all tensors to be allocated
@@ -156,6 +659,10 @@ void GraphObj::dataMalloc(bool useNaiveAllocator) {
                 tensorToOffset[tensor.get()] =
                     allocator.allocWeight(tensor->getBytes());
             }
+        } else if (memoryPlanStrategy != MemoryPlanStrategy::Online ||
+                   views.count(tensor.get())) {
+            // planned together with all the other tensors below
+            continue;
         } else if (tensor->isInput() || tensor->isOutput()) {
             // allocate memory for all input and output tensors, and this memory
             // will not be reused later
@@ -182,29 +689,47 @@ void GraphObj::dataMalloc(bool useNaiveAllocator) {
                     tensorToOffset[tensor]));
         }
     }
-    // traverse in topological order and simulate memory allocation
-    for (auto &op : ops) {
-        // memory should be allocated for the op's output first
-        auto outputs = op->getOutputs();
-        for (auto &tensor : outputs) {
-            if (tensor->isOthers()) {
-                tensorToOffset[tensor.get()] =
-                    allocator.alloc(tensor->getBytes());
+    if (memoryPlanStrategy != MemoryPlanStrategy::Online) {
+        planMemory(views, tensorToOffset);
+    } else {
+        // the memory of a view is counted and freed with its owner
+        auto getOwner = [&](TensorObj *tensor) {
+            auto it = views.find(tensor);
+            return it == views.end() ? tensor : it->second.owner;
+        };
+        // traverse in topological order and simulate memory allocation
+        for (auto &op : ops) {
+            // memory should be allocated for the op's output first
+            auto outputs = op->getOutputs();
+            for (auto &tensor : outputs) {
+                auto owner = getOwner(tensor.get());
+                if (owner != tensor.get()) {
+                    tensorToOffset[tensor.get()] =
+                        tensorToOffset.at(owner) + views[tensor.get()].offset;
+                    // an extra use, which is never released, keeps the
+                    // memory of a graph output
+                    if (owner->isOthers())
+                        tensorToRefCount.at(owner) +=
+                            tensor->getTargets().size() + tensor->isOutput();
+                } else if (tensor->isOthers()) {
+                    tensorToOffset[tensor.get()] =
+                        allocator.alloc(tensor->getBytes());
+                }
             }
-        }
-        auto inputs = op->getInputs();
-        for (auto &tensor : inputs) {
-            if (tensor->isOthers()) {
-                auto tensorIter = tensorToRefCount.find(tensor.get());
-                IT_ASSERT(tensorIter != tensorToRefCount.end());
-                IT_ASSERT(tensorToRefCount[tensor.get()] > 0);
-                tensorToRefCount[tensor.get()] -= 1;
-                if (tensorToRefCount[tensor.get()] == 0) {
+            auto inputs = op->getInputs();
+            for (auto &tensor : inputs) {
+                auto owner = getOwner(tensor.get());
+                if (!owner->isOthers())
+                    continue;
+                auto ownerIter = tensorToRefCount.find(owner);
+                IT_ASSERT(ownerIter != tensorToRefCount.end());
+                IT_ASSERT(ownerIter->second > 0);
+                ownerIter->second -= 1;
+                if (ownerIter->second == 0) {
                     // indicate that this tensor will no longer be used and
                     // perform memory free
-                    tensorToRefCount.erase(tensor.get());
-                    allocator.free(tensorToOffset[tensor.get()],
-                                   tensor->getBytes());
+                    tensorToRefCount.erase(ownerIter);
+                    allocator.free(tensorToOffset[owner], owner->getBytes());
                 }
             }
         }
@@ -220,6 +745,214 @@ void GraphObj::dataMalloc(bool useNaiveAllocator) {
                                      tensorToOffset[tensor.get()]));
         }
     }
+    for (auto &tensor : weightTensors)
+        tensorToOffset.erase(tensor);
+    allocator.addCache(inputShapes, tensorToOffset);
+}
+
+void GraphObj::shape_infer() {
+    IT_ASSERT(topo_sort() == true);
+    executionPlan = nullptr;
+    for (auto &op : ops) {
+        auto shapes = op->inferShape();
+        IT_ASSERT(shapes.has_value());
+        auto outputs = op->getOutputs();
+        IT_ASSERT(shapes->size() == outputs.size());
+        for (size_t i = 0; i < outputs.size(); ++i)
+            if ((*shapes)[i] != outputs[i]->getDims())
+                outputs[i]->setShape((*shapes)[i]);
+    }
+}
+
+// The strides and the offset in elements of the output of Slice, Transpose
+// or Expand as a view into its input, if it can be one
+static optional<pair<Shape, size_t>> getStridedView(const Operator &op) {
+    auto input = op->getInputs(0), output = op->getOutput();
+    auto inDims = input->getDims(), outDims = output->getDims();
+    auto inStride = input->getStride();
+    size_t offset = 0;
+    switch (op->getOpType().underlying()) {
+    case OpType::Slice: {
+        auto slice = as<SliceObj>(op);
+        auto starts = slice->getStarts(), steps = slice->getSteps();
+        Shape stride(inDims.size());
+        for (size_t i = 0; i < inDims.size(); ++i) {
+            // a stride cannot step backwards
+            if (steps[i] <= 0)
+                return std::nullopt;
+            offset += size_t(starts[i]) * inStride[i];
+            stride[i] = inStride[i] * steps[i];
+        }
+        return pair(stride, offset);
+    }
+    case OpType::Transpose: {
+        auto permute = as<TransposeObj>(op)->getPermute();
+        Shape stride(permute.size());
+        for (size_t i = 0; i < permute.size(); ++i)
+            stride[i] = inStride[permute[i]];
+        return pair(stride, offset);
+    }
+    case OpType::Expand: {
+        // broadcast dimensions have stride 0
+        const size_t skip = outDims.size() - inDims.size();
+        Shape stride(outDims.size(), 0);
+        for (size_t i = 0; i < inDims.size(); ++i)
+            if (inDims[i] != 1)
+                stride[i + skip] = inStride[i];
+        return pair(stride, offset);
+    }
+    default:
+        return std::nullopt;
+    }
+}
+
+std::unordered_map<TensorObj *, GraphObj::View> GraphObj::planViews() {
+    const auto &kernelRegistry = KernelRegistry::getInstance();
+    // Whether every kernel reading `tensor` accepts it as a strided view.
+    // Tuning may choose any of the applicable kernels of an operator.
+    auto isReadStrided = [&](const Tensor &tensor) {
+        for (auto &target : tensor->getTargets()) {
+            auto kernelAttrs = KernelAttrs{runtime->getDevice(),
+                                           target->getOpType().underlying(),
+                                           target->getDType()};
+            auto items = kernelRegistry.getKernelItems(kernelAttrs, target);
+            if (items.empty())
+                return false;
+            const auto &inputs = target->getInputs();
+            for (auto item : items)
+                for (size_t i = 0; i < inputs.size(); ++i)
+                    if (inputs[i] == tensor &&
+                        !std::get<0>(*item)->supportsStridedInput(target, i))
+                        return false;
+        }
+        return true;
+    };
+
+    for (auto &tensor : tensors)
+        tensor->setStride({});
+    std::unordered_map<TensorObj *, View> views;
+    for (auto &op : ops) {
+        if (op->getInputs().empty() || op->getOutputs().size() != 1)
+            continue;
+        // weights live in a memory space of their own
+        auto input = op->getInputs(0), output = op->getOutput();
+        if (input->isWeight() || output->isWeight())
+            continue;
+        auto it = views.find(input.get());
+        auto view = it == views.end() ? View{input.get(), 0} : it->second;
+        if (op->getOpType().isView()) {
+            if (input->getBytes() == output->getBytes() &&
+                input->isContiguous())
+                views[output.get()] = view;
+            continue;
+        }
+        // A strided view is made contiguous, i.e. computed by its operator,
+        // unless all its readers accept the strides. A graph output is
+        // always contiguous.
+        auto strided = getStridedView(op);
+        if (!strided || !output->isOthers() || !output->hasTarget())
+            continue;
+        output->setStride(strided->first);
+        if (isReadStrided(output)) {
+            view.offset += strided->second * output->getDType().getSize();
+            views[output.get()] = view;
+        } else
+            output->setStride({});
+    }
+    return views;
+}
+
+void GraphObj::planMemory(
+    const std::unordered_map<TensorObj *, View> &views,
+    std::unordered_map<TensorObj *, size_t> &tensorToOffset) {
+    // Steps are positions in the topological order. As in the online
+    // allocation, only tensors marked as graph inputs or outputs and unused
+    // tensors outlive their last use, until `end`.
+    const size_t end = ops.size();
+    std::unordered_map<TensorObj *, size_t> lastUse;
+    for (size_t step = 0; step < ops.size(); ++step)
+        for (auto &tensor : ops[step]->getInputs())
+            lastUse[tensor.get()] = step;
+    auto getLastStep = [&](const Tensor &tensor) {
+        if (tensor->isInput() || tensor->isOutput() ||
+            tensor->getTargets().empty())
+            return end;
+        return lastUse.at(tensor.get());
+    };
+
+    // a view lies in the memory of its owner at an offset
+    auto getOwner = [&](TensorObj *tensor) {
+        auto it = views.find(tensor);
+        return it == views.end() ? tensor : it->second.owner;
+    };
+    auto getOffset = [&](TensorObj *tensor) {
+        auto it = views.find(tensor);
+        return it == views.end() ? size_t(0) : it->second.offset;
+    };
+
+    // tensors aliased by in-place or view operators share a block
+    vector<LazyAllocator::BlockLifetime> blocks;
+    std::unordered_map<TensorObj *, size_t> tensorToBlock;
+    for (auto &tensor : tensors)
+        if (!tensor->isWeight() && !tensor->getSource()) {
+            tensorToBlock[tensor.get()] = blocks.size();
+            blocks.push_back({tensor->getBytes(), 0, getLastStep(tensor)});
+        }
+    for (size_t step = 0; step < ops.size(); ++step) {
+        const auto &op = ops[step];
+        // These operators read each element of an input of the output size
+        // only before writing the same element of the output.
+        const bool inplace = op->getOpType().isElementWise();
+        for (auto &output : op->getOutputs()) {
+            if (output->isWeight())
+                continue;
+            if (auto it = views.find(output.get()); it != views.end()) {
+                auto block = tensorToBlock.at(it->second.owner);
+                tensorToBlock[output.get()] = block;
+                blocks[block].lastStep =
+                    std::max(blocks[block].lastStep, getLastStep(output));
+                continue;
+            }
+            std::optional<size_t> reuse;
+            for (auto &input : op->getInputs()) {
+                auto owner = getOwner(input.get());
+                // inputs fed by the user are kept intact until reused by
+                // a later tensor
+                if (!inplace || reuse || !input->isOthers() ||
+                    !owner->isOthers() || !owner->getSource() ||
+                    input->getBytes() != output->getBytes())
+                    continue;
+                auto block = tensorToBlock.at(input.get());
+                // the input dies here and no other output has taken it
+                if (blocks[block].lastStep != step ||
+                    getLastStep(input) != step)
+                    continue;
+                // each element is read where it is written unless any
+                // input in the block is laid out otherwise
+                bool aligned = true;
+                for (auto &other : op->getInputs()) {
+                    auto it = tensorToBlock.find(other.get());
+                    if (it != tensorToBlock.end() && it->second == block &&
+                        (other->isStrided() || getOffset(other.get()) != 0))
+                        aligned = false;
+                }
+                if (aligned)
+                    reuse = block;
+            }
+            if (reuse) {
+                tensorToBlock[output.get()] = *reuse;
+                blocks[*reuse].lastStep = getLastStep(output);
+            } else {
+                tensorToBlock[output.get()] = blocks.size();
+                blocks.push_back(
+                    {output->getBytes(), step, getLastStep(output)});
+            }
+        }
+    }
+
+    auto offsets = allocator.plan(blocks, memoryPlanStrategy);
+    for (auto &[tensor, block] : tensorToBlock)
+        tensorToOffset[tensor] = offsets[block] + getOffset(tensor);
 }
 
 Tensor GraphObj::addTensor(Shape dim, DataType dtype) {
@@ -254,6 +987,7 @@ void GraphObj::deleteConnection(Tensor tensor, Operator op) {
     IT_ASSERT(std::find(tensor->getTargets().begin(),
                         tensor->getTargets().end(),
                         op) != tensor->getTargets().end());
+    invalidateCaches();
     tensor->removeTarget(op);
     if (tensor->getSource()) {
         tensor->getSource()->removeSuccessors(op);
@@ -263,6 +997,7 @@ void GraphObj::deleteConnection(Tensor tensor, Operator op) {
 
 // add op as a target
 void GraphObj::addConnection(Tensor tensor, Operator op) {
+    invalidateCaches();
     tensor->addTarget(op);
     if (tensor->getSource()) {
         tensor->getSource()->addSuccessors(op);
@@ -1,6 +1,7 @@
 ﻿#include "core/graph_handler.h"
 #include "operators/all_gather.h"
 #include "operators/all_reduce.h"
+#include "operators/attention.h"
 #include "operators/batch_norm.h"
 #include "operators/broadcast.h"
 #include "operators/concat.h"
@@ -8,10 +9,11 @@
 #include "operators/element_wise.h"
 #include "operators/expand.h"
 #include "operators/gather.h"
+#include "operators/layer_norm.h"
 #include "operators/matmul.h"
 #include "operators/pad.h"
 #include "operators/pooling.h"
-#include "operators/reduce_mean.h"
+#include "operators/reduce.h"
 #include "operators/reshape.h"
 #include "operators/slice.h"
 #include "operators/softmax.h"
@@ -94,6 +96,52 @@ Tensor GraphHandlerObj::batchNormalization(Tensor input, Tensor output,
     }
 }
 
+Tensor GraphHandlerObj::layerNormalization(Tensor input, Tensor scale,
+                                           Tensor output, Tensor bias,
+                                           float eps, int axis) {
+    if (output) {
+        g->addOpWithOutputs<LayerNormObj>(std::move(input), std::move(scale),
+                                          output, std::move(bias), eps, axis);
+        return output;
+    } else {
+        return g
+            ->addOp<LayerNormObj>(std::move(input), std::move(scale), output,
+                                  std::move(bias), eps, axis)
+            ->getOutput();
+    }
+}
+
+Tensor GraphHandlerObj::rmsNorm(Tensor input, Tensor scale, Tensor output,
+                                float eps, int axis) {
+    if (output) {
+        g->addOpWithOutputs<RMSNormObj>(std::move(input), std::move(scale),
+                                        output, eps, axis);
+        return output;
+    } else {
+        return g
+            ->addOp<RMSNormObj>(std::move(input), std::move(scale), output,
+                                eps, axis)
+            ->getOutput();
+    }
+}
+
+Tensor GraphHandlerObj::attention(Tensor query, Tensor key, Tensor value,
+                                  Tensor output, Tensor mask,
+                                  std::optional<float> scale) {
+    if (output) {
+        g->addOpWithOutputs<AttentionObj>(std::move(query), std::move(key),
+                                          std::move(value), output,
+                                          std::move(mask), scale);
+        return output;
+    } else {
+        return g
+            ->addOp<AttentionObj>(std::move(query), std::move(key),
+                                  std::move(value), output, std::move(mask),
+                                  scale)
+            ->getOutput();
+    }
+}
+
 Tensor GraphHandlerObj::maxPool(Tensor input, Tensor output, int kh, int kw,
                                 int dh, int dw, int ph, int pw, int sh, int sw,
                                 int ceilMode) {
@@ -265,18 +313,27 @@ Tensor GraphHandlerObj::gather(Tensor data, Tensor indices, Tensor output,
     }
 }
 
-Tensor GraphHandlerObj::reduceMean(Tensor data, Tensor reduced,
-                                   const optional<vector<int>> &axes,
-                                   bool keepdims) {
-    if (reduced) {
-        g->addOpWithOutputs<ReduceMeanObj>(std::move(data), reduced, axes,
-                                           keepdims);
-        return reduced;
-    } else {
-        return g->addOp<ReduceMeanObj>(std::move(data), reduced, axes, keepdims)
-            ->getOutput();
+// see operators/reduce.h
+#define DEFINE_REDUCE_METHOD(name, obj)                                        \
+    Tensor GraphHandlerObj::name(Tensor data, Tensor reduced,                  \
+                                 const optional<vector<int>> &axes,            \
+                                 bool keepdims) {                              \
+        if (reduced) {                                                         \
+            g->addOpWithOutputs<obj##Obj>(std::move(data), reduced, axes,      \
+                                          keepdims);                           \
+            return reduced;                                                    \
+        } else {                                                               \
+            return g->addOp<obj##Obj>(std::move(data), reduced, axes,          \
+                                      keepdims)                                \
+                ->getOutput();                                                 \
+        }                                                                      \
     }
-}
+
+DEFINE_REDUCE_METHOD(reduceMean, ReduceMean)
+DEFINE_REDUCE_METHOD(reduceSum, ReduceSum)
+DEFINE_REDUCE_METHOD(reduceMax, ReduceMax)
+DEFINE_REDUCE_METHOD(reduceMin, ReduceMin)
+DEFINE_REDUCE_METHOD(reduceL2, ReduceL2)
 
 Tensor GraphHandlerObj::slice(Tensor input, Tensor output,
                               const vector<int> &starts,
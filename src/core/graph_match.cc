@@ -1,4 +1,8 @@
 #include "core/graph_match.h"
+#include "operators/element_wise.h"
+#include "operators/layer_norm.h"
+#include "operators/reduce.h"
+#include "operators/unary.h"
 
 namespace infini {
 Ref<GraphMatchObj> GraphMatchObj::clone() {
@@ -76,6 +80,7 @@ vector<MatchGraph> SubGraphRewriter::findMatch(const SubGraph &pattern) {
     this->pattern = pattern;
     vector<MatchGraph> matches;
     bool firstHead = true, retStatus = true;
+    std::unordered_set<Operator> visited;
     for (auto input : pattern->getInputsFromOutside()) {
         auto inputOf = input->getTargets();
         for (auto opHead : inputOf) {
@@ -85,6 +90,8 @@ vector<MatchGraph> SubGraphRewriter::findMatch(const SubGraph &pattern) {
                 continue;                             // not belongs to pattern
             if (opHead->getPredecessors().size() > 0) // not a head
                 continue;
+            if (!visited.insert(opHead).second) // reads several inputs
+                continue;
             if (firstHead) {
                 firstHead = false;
                 if (!findMatch(nullptr, nullptr, opHead, matches)) {
@@ -462,4 +469,169 @@ bool SubGraphRewriter::isReplacable(const Tensor &l, const Tensor &r) const {
     return (l->getDType() == r->getDType() && l->getDims() == r->getDims());
 }
 
+// Whether every operator of the match reads the anchors of the inputs of its
+// pattern operator in the same order. Matching by hash and connections does
+// not tell Sub(x, y) from Sub(y, x).
+static bool checkOperandOrder(const MatchGraph &match,
+                              const SubGraph &pattern) {
+    for (auto opPattern : pattern->getOperators()) {
+        auto opAnchor = match->getAnchorByPattern(opPattern);
+        if (opAnchor->getInputs().size() != opPattern->getInputs().size())
+            return false;
+        for (size_t i = 0; i < opPattern->getInputs().size(); ++i) {
+            auto t = opPattern->getInputs(i);
+            auto source = t->getSource();
+            auto anchor = source
+                              ? match->getAnchorByPattern(source)->getOutput()
+                              : match->getAnchorByPattern(t);
+            if (opAnchor->getInputs(i) != anchor)
+                return false;
+        }
+    }
+    return true;
+}
+
+// The value of a loaded float weight with a single element
+static optional<float> getScalarWeight(const Tensor &t) {
+    if (t->getSource() || !t->hasData() || t->size() != 1 ||
+        !(t->getDType() == DataType::Float32))
+        return std::nullopt;
+    return t->getRawDataPtr<float *>()[0];
+}
+
+// Whether the outputs of the matched operators other than `output` are only
+// used inside the match
+static bool isClosed(const MatchGraph &match, const Tensor &output) {
+    for (auto &op : match->getOps())
+        for (auto &t : op->getOutputs())
+            if (t != output && t->isOutput())
+                return false;
+    return true;
+}
+
+int SubGraphRewriter::fuseNormalization() {
+    // ReduceMean hashes its axes, so the chains are matched once for every
+    // rank and trailing axes that ReduceMean operators reduce
+    set<pair<int, vector<int>>> keys;
+    for (auto &op : graph->getOperators()) {
+        if (op->getOpType() != OpType::ReduceMean)
+            continue;
+        auto reduce = as<ReduceBaseObj>(op);
+        const int rank = reduce->getInputs(0)->getRank();
+        auto &axes = reduce->getAxes();
+        if (!reduce->getKeepDims() || axes.empty() ||
+            *axes.rbegin() != rank - 1 ||
+            *axes.rbegin() - *axes.begin() + 1 != int(axes.size()))
+            continue;
+        keys.emplace(rank, vector<int>(axes.begin(), axes.end()));
+    }
+    int fused = 0;
+    for (auto &[rank, axes] : keys) {
+        fused += fuseLayerNorm(rank, axes, true);
+        fused += fuseLayerNorm(rank, axes, false);
+        fused += fuseRMSNorm(rank, axes);
+    }
+    return fused;
+}
+
+int SubGraphRewriter::replaceMatches(
+    const SubGraph &pattern, const std::function<Operator(MatchGraph)> &fuse) {
+    int fused = 0;
+    std::unordered_set<Operator> replaced;
+    for (auto match : findMatch(pattern)) {
+        if (!checkOverlapsWithPreviousMatch(match, replaced) ||
+            !checkOperandOrder(match, pattern))
+            continue;
+        auto newOp = fuse(match);
+        if (!newOp)
+            continue;
+        auto ops = match->getOps();
+        replaced.insert(ops.begin(), ops.end());
+        graph->replaceOperators(OpVec(ops.begin(), ops.end()), newOp);
+        ++fused;
+    }
+    return fused;
+}
+
+int SubGraphRewriter::fuseLayerNorm(int rank, const vector<int> &axes,
+                                    bool withBias) {
+    auto runtime = graph->getRuntime();
+    auto scalar = [&]() {
+        return make_ref<TensorObj>(Shape{1}, DataType::Float32, runtime);
+    };
+    Tensor x = make_ref<TensorObj>(Shape(rank, 1), DataType::Float32, runtime);
+    Tensor two = scalar(), eps = scalar(), scale = scalar(), bias = scalar();
+    SubGraph p = make_ref<SubGraphObj>(
+        runtime, withBias ? TensorVec{x, two, eps, scale, bias}
+                          : TensorVec{x, two, eps, scale});
+    auto mean = p->addOp<ReduceMeanObj>(x, nullptr, axes, true)->getOutput();
+    auto d = p->addOp<SubObj>(x, mean, nullptr)->getOutput();
+    auto sq = p->addOp<PowObj>(d, two, nullptr)->getOutput();
+    auto var = p->addOp<ReduceMeanObj>(sq, nullptr, axes, true)->getOutput();
+    auto ve = p->addOp<AddObj>(var, eps, nullptr)->getOutput();
+    auto stddev = p->addOp<SqrtObj>(ve, nullptr)->getOutput();
+    auto norm = p->addOp<DivObj>(d, stddev, nullptr)->getOutput();
+    auto y = p->addOp<MulObj>(norm, scale, nullptr)->getOutput();
+    if (withBias)
+        y = p->addOp<AddObj>(y, bias, nullptr)->getOutput();
+    p->setOutputs({y});
+
+    return replaceMatches(p, [&](MatchGraph match) -> Operator {
+        auto input = match->getAnchorByPattern(x),
+             output = match->getAnchorByPattern(y),
+             gamma = match->getAnchorByPattern(scale),
+             beta = withBias ? match->getAnchorByPattern(bias) : nullptr;
+        auto exponent = getScalarWeight(match->getAnchorByPattern(two)),
+             epsilon = getScalarWeight(match->getAnchorByPattern(eps));
+        auto dims = input->getDims();
+        const Shape normalized(dims.begin() + axes[0], dims.end());
+        if (!(input->getDType() == DataType::Float32) ||
+            output->getDims() != dims || !exponent || *exponent != 2 ||
+            !epsilon || !isClosed(match, output) ||
+            !(gamma->getDType() == DataType::Float32) ||
+            !LayerNormBaseObj::isParamShape(gamma->getDims(), normalized) ||
+            (beta && (!(beta->getDType() == DataType::Float32) ||
+                      !LayerNormBaseObj::isParamShape(beta->getDims(),
+                                                      normalized))))
+            return nullptr;
+        return make_ref<LayerNormObj>(nullptr, input, gamma, output, beta,
+                                      *epsilon, axes[0]);
+    });
+}
+
+int SubGraphRewriter::fuseRMSNorm(int rank, const vector<int> &axes) {
+    auto runtime = graph->getRuntime();
+    auto scalar = [&]() {
+        return make_ref<TensorObj>(Shape{1}, DataType::Float32, runtime);
+    };
+    Tensor x = make_ref<TensorObj>(Shape(rank, 1), DataType::Float32, runtime);
+    Tensor two = scalar(), eps = scalar(), scale = scalar();
+    SubGraph p = make_ref<SubGraphObj>(runtime, TensorVec{x, two, eps, scale});
+    auto sq = p->addOp<PowObj>(x, two, nullptr)->getOutput();
+    auto ms = p->addOp<ReduceMeanObj>(sq, nullptr, axes, true)->getOutput();
+    auto mse = p->addOp<AddObj>(ms, eps, nullptr)->getOutput();
+    auto rms = p->addOp<SqrtObj>(mse, nullptr)->getOutput();
+    auto norm = p->addOp<DivObj>(x, rms, nullptr)->getOutput();
+    auto y = p->addOp<MulObj>(norm, scale, nullptr)->getOutput();
+    p->setOutputs({y});
+
+    return replaceMatches(p, [&](MatchGraph match) -> Operator {
+        auto input = match->getAnchorByPattern(x),
+             output = match->getAnchorByPattern(y),
+             gamma = match->getAnchorByPattern(scale);
+        auto exponent = getScalarWeight(match->getAnchorByPattern(two)),
+             epsilon = getScalarWeight(match->getAnchorByPattern(eps));
+        auto dims = input->getDims();
+        const Shape normalized(dims.begin() + axes[0], dims.end());
+        if (!(input->getDType() == DataType::Float32) ||
+            output->getDims() != dims || !exponent || *exponent != 2 ||
+            !epsilon || !isClosed(match, output) ||
+            !(gamma->getDType() == DataType::Float32) ||
+            !LayerNormBaseObj::isParamShape(gamma->getDims(), normalized))
+            return nullptr;
+        return make_ref<RMSNormObj>(nullptr, input, gamma, output, *epsilon,
+                                    axes[0]);
+    });
+}
+
 } // namespace infini
@@ -1,4 +1,6 @@
 #include "core/lazy_allocator.h"
+#include <algorithm>
+#include <numeric>
 #include <utility>
 
 namespace infini {
@@ -35,13 +37,12 @@ LazyAllocator::~LazyAllocator() {
 void LazyAllocator::init() {
     used = 0;
     peak = 0;
+    lowerBound = 0;
     freeBlocks.clear();
     headAddrToBlockSize.clear();
     tailAddrToBlockSize.clear();
-    if (this->ptr != nullptr) {
-        runtime->dealloc(this->ptr);
-    }
-    this->ptr = nullptr;
+    // the memory actually allocated is kept for reuse by getPtr
+    materialized = false;
 }
 
 size_t LazyAllocator::alloc(size_t size) {
@@ -103,7 +104,7 @@ size_t LazyAllocator::allocWeight(size_t size) {
 }
 
 void LazyAllocator::free(size_t addr, size_t size) {
-    IT_ASSERT(this->ptr == nullptr);
+    IT_ASSERT(!this->materialized);
     size = getAlignedSize(size);
     auto tailAddr = addr + size;
     freeBlockInfo block = {addr, tailAddr - addr};
@@ -142,9 +143,124 @@ void LazyAllocator::free(size_t addr, size_t size) {
     this->used -= size;
 }
 
+vector<size_t> LazyAllocator::plan(const vector<BlockLifetime> &blocks,
+                                   MemoryPlanStrategy strategy) {
+    IT_ASSERT(strategy != MemoryPlanStrategy::Online);
+    IT_ASSERT(!this->materialized && this->peak == 0);
+    const size_t n = blocks.size();
+    vector<size_t> sizes(n);
+    size_t numSteps = 0;
+    for (size_t i = 0; i < n; ++i) {
+        IT_ASSERT(blocks[i].firstStep <= blocks[i].lastStep);
+        sizes[i] = getAlignedSize(blocks[i].size);
+        numSteps = std::max(numSteps, blocks[i].lastStep + 1);
+    }
+
+    // live memory of every step, whose maximum no placement can go below
+    vector<size_t> liveSize(numSteps + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        liveSize[blocks[i].firstStep] += sizes[i];
+        liveSize[blocks[i].lastStep + 1] -= sizes[i];
+    }
+    std::partial_sum(liveSize.begin(), liveSize.end(), liveSize.begin());
+    this->lowerBound = 0;
+    for (size_t step = 0; step < numSteps; ++step)
+        this->lowerBound = std::max(this->lowerBound, liveSize[step]);
+
+    vector<size_t> offsets(n);
+    vector<bool> isPlaced(n, false);
+    vector<size_t> placed;
+    // place a block in the smallest gap between the placed blocks whose
+    // lifetimes overlap with it, or above all of them if no gap fits
+    auto place = [&](size_t id) {
+        vector<std::pair<size_t, size_t>> busy;
+        for (auto other : placed)
+            if (blocks[other].firstStep <= blocks[id].lastStep &&
+                blocks[id].firstStep <= blocks[other].lastStep)
+                busy.emplace_back(offsets[other],
+                                  offsets[other] + sizes[other]);
+        std::sort(busy.begin(), busy.end());
+        size_t best = SIZE_MAX, bestGap = SIZE_MAX, top = 0;
+        for (auto [head, tail] : busy) {
+            if (head > top && head - top >= sizes[id] && head - top < bestGap) {
+                best = top;
+                bestGap = head - top;
+            }
+            top = std::max(top, tail);
+        }
+        offsets[id] = best == SIZE_MAX ? top : best;
+        isPlaced[id] = true;
+        placed.emplace_back(id);
+        this->peak = std::max(this->peak, offsets[id] + sizes[id]);
+    };
+
+    vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    auto bySize = [&](size_t a, size_t b) {
+        return sizes[a] != sizes[b] ? sizes[a] > sizes[b]
+                                    : blocks[a].firstStep < blocks[b].firstStep;
+    };
+    std::stable_sort(order.begin(), order.end(), bySize);
+    if (strategy == MemoryPlanStrategy::GreedyBySize) {
+        for (auto id : order)
+            place(id);
+    } else {
+        vector<size_t> steps(numSteps);
+        std::iota(steps.begin(), steps.end(), 0);
+        std::stable_sort(steps.begin(), steps.end(), [&](size_t a, size_t b) {
+            return liveSize[a] > liveSize[b];
+        });
+        for (auto step : steps)
+            for (auto id : order)
+                if (!isPlaced[id] && blocks[id].firstStep <= step &&
+                    step <= blocks[id].lastStep)
+                    place(id);
+    }
+    return offsets;
+}
+
+void LazyAllocator::addCache(
+    const vector<Shape> &inputShapes,
+    const std::unordered_map<TensorObj *, size_t> &offsets) {
+    MemoryPlan plan{{}, this->peak, this->lowerBound};
+    for (auto &[tensor, offset] : offsets)
+        plan.tensors[tensor] = {offset, tensor->getBytes()};
+    inputShapesToPlan[inputShapes] = std::move(plan);
+}
+
+std::optional<vector<size_t>>
+LazyAllocator::getCache(const vector<Shape> &inputShapes,
+                        const TensorVec &tensors) {
+    auto it = inputShapesToPlan.find(inputShapes);
+    if (it == inputShapesToPlan.end())
+        return std::nullopt;
+    const auto &plan = it->second;
+    if (plan.tensors.size() != tensors.size())
+        return std::nullopt;
+    vector<size_t> ret;
+    ret.reserve(tensors.size());
+    for (auto &tensor : tensors) {
+        auto planned = plan.tensors.find(tensor.get());
+        if (planned == plan.tensors.end() ||
+            planned->second.second != tensor->getBytes())
+            return std::nullopt;
+        ret.emplace_back(planned->second.first);
+    }
+    init();
+    this->peak = plan.peak;
+    this->lowerBound = plan.lowerBound;
+    return ret;
+}
+
 void *LazyAllocator::getPtr() {
+    this->materialized = true;
+    if (this->ptr != nullptr && this->ptrSize < this->peak) {
+        runtime->dealloc(this->ptr);
+        this->ptr = nullptr;
+    }
     if (this->ptr == nullptr) {
         this->ptr = runtime->alloc(this->peak);
+        this->ptrSize = this->peak;
         // #ifdef DEBUG_MODE
         //         printf("LazyAllocator really alloc non-weight: %p %lu
         //         bytes\n", this->ptr, peak);
@@ -170,8 +286,11 @@ size_t LazyAllocator::getAlignedSize(size_t size) {
 
 void LazyAllocator::info() {
     std::cout << "Used memory: " << this->used + this->weightPeak
-              << ", peak memory: " << this->peak + this->weightPeak
-              << std::endl;
+              << ", peak memory: " << this->peak + this->weightPeak;
+    if (this->lowerBound != 0)
+        std::cout << ", planned peak memory: " << this->peak
+                  << " (lower bound " << this->lowerBound << ")";
+    std::cout << std::endl;
 }
 
 } // namespace infini
@@ -224,6 +224,11 @@ const char *OpType::toString() const {
         CASE(AllReduceAvg);
         CASE(AllGather);
         CASE(Broadcast);
+
+        // Fused
+        CASE(FusedElementWise);
+        CASE(RMSNorm);
+        CASE(Attention);
     default:
         return "Unknown";
     }
@@ -252,6 +257,15 @@ bool OpType::isBinary() const {
 
 bool OpType::isElementWise() const { return isUnary() || isBinary(); }
 
+// Operators whose output has the same bytes as their input in a new shape
+bool OpType::isView() const {
+    static const std::unordered_set<decltype(type)> set{
+        Reshape, Flatten, Identity, Squeeze, Unsqueeze,
+    };
+
+    return set.find(type) != set.end();
+}
+
 bool OpType::isCompair() const {
     static const std::unordered_set<decltype(type)> set{
         Equal, Greater, GreaterOrEqual, Less, LessOrEqual,
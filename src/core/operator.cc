@@ -36,6 +36,16 @@ void OperatorObj::replaceInput(Tensor t1, Tensor t2) {
     }
 }
 
+bool OperatorObj::isAliasedView() const {
+    // only dataMalloc makes an output a strided view
+    if (outputs.size() == 1 && outputs[0]->isStrided())
+        return true;
+    if (!type.isView() || !inputs[0]->hasData() || !outputs[0]->hasData())
+        return false;
+    return inputs[0]->getRawDataPtr<void *>() ==
+           outputs[0]->getRawDataPtr<void *>();
+}
+
 OpPerfKey OperatorObj::getOpPerfKey() const {
     auto workloadVector = getWorkloadVector();
     // Calculate hash of workload, i.e. hash with shape. This is different from
@@ -1,26 +1,17 @@
 #include "core/perf_engine.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
 #include <fstream>
+#include <sstream>
+#include <sys/file.h>
+#include <thread>
+#include <unistd.h>
 namespace infini {
 
 REGISTER_CONSTRUCTOR(0, PerfRecordObj::from_json);
 
-void PerfEngine::savePerfEngineData(std::string file_path) {
-    std::ofstream fileout(file_path,
-                          std::ios::out | std::ios::trunc | std::ios::binary);
-    json t = this->getInstance();
-    fileout << t << std::endl;
-    fileout.close();
-}
-
-void PerfEngine::loadPerfEngineData(std::string file_path) {
-    std::ifstream filein(file_path, std::ios::in | std::ios::binary);
-    string t;
-    filein >> t;
-    json j = json::parse(t);
-    from_json(j, this->getInstance());
-    filein.close();
-}
-
 /* json register should in the common namespace with corresponding type*/
 void to_json(json &j, const OpPerfKey &p) {
     j = json{{"hashType", p.hash}, {"opType", p.opType}, {"attrs", p.attrs}};
@@ -32,10 +23,386 @@ void from_json(const json &j, OpPerfKey &p) {
 }
 void to_json(json &j, const DataType &p) { j = p.getIndex(); }
 void from_json(const json &j, DataType &p) { p = DataType(j.get<int>()); }
-void to_json(json &j, const PerfRecord &p) { p->to_json(j); }
+void to_json(json &j, const PerfRecord &p) {
+    p->to_json(j);
+    if (!p->kernel.empty())
+        j["kernel"] = p->kernel;
+}
 void from_json(const json &j, PerfRecord &p) {
     int type = j["type"].get<int>();
     p = PerfRecordRegistry::getInstance().getConstructor(type)(j);
+    if (j.contains("kernel"))
+        j.at("kernel").get_to(p->kernel);
+}
+
+bool PerfEngine::setPerfData(const Key &key, PerfRecord record) {
+    IT_ASSERT(record != nullptr);
+    auto &shard = getShard(key);
+    std::unique_lock lock(shard.mutex);
+    auto [it, inserted] = shard.data.try_emplace(key, record);
+    if (!inserted) {
+        if (it->second->time <= record->time)
+            return false;
+        it->second = std::move(record);
+    }
+    version.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+PerfRecord PerfEngine::getOrTune(const Key &key,
+                                 const std::function<PerfRecord()> &tune) {
+    auto &shard = getShard(key);
+    std::promise<PerfRecord> promise;
+    {
+        std::unique_lock lock(shard.mutex);
+        auto it = shard.data.find(key);
+        if (it != shard.data.end())
+            return it->second;
+        auto tuning = shard.tuning.find(key);
+        if (tuning != shard.tuning.end()) {
+            auto future = tuning->second;
+            lock.unlock();
+            return future.get();
+        }
+        shard.tuning.emplace(key, promise.get_future().share());
+    }
+
+    // Tune without holding the lock, which would block the other keys of
+    // the shard
+    PerfRecord record;
+    try {
+        record = tune();
+    } catch (...) {
+        {
+            std::unique_lock lock(shard.mutex);
+            shard.tuning.erase(key);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+    {
+        std::unique_lock lock(shard.mutex);
+        // A record may have been stored by setPerfData meanwhile
+        auto [it, inserted] = shard.data.try_emplace(key, record);
+        if (!inserted && record->time < it->second->time)
+            it->second = record;
+        record = it->second;
+        shard.tuning.erase(key);
+    }
+    version.fetch_add(1, std::memory_order_release);
+    promise.set_value(record);
+    return record;
+}
+
+size_t PerfEngine::size() const {
+    size_t n = 0;
+    for (auto &shard : shards) {
+        std::shared_lock lock(shard.mutex);
+        n += shard.data.size();
+    }
+    return n;
+}
+
+map<PerfEngine::Key, PerfRecord> PerfEngine::get_data() const {
+    map<Key, PerfRecord> data;
+    for (auto &shard : shards) {
+        std::shared_lock lock(shard.mutex);
+        data.insert(shard.data.begin(), shard.data.end());
+    }
+    return data;
+}
+
+void PerfEngine::set_data(const map<Key, PerfRecord> &data) {
+    clear();
+    for (auto &[key, record] : data) {
+        auto &shard = getShard(key);
+        std::unique_lock lock(shard.mutex);
+        shard.data.insert_or_assign(key, record);
+    }
+    version.fetch_add(1, std::memory_order_release);
+}
+
+void PerfEngine::clear() {
+    for (auto &shard : shards) {
+        std::unique_lock lock(shard.mutex);
+        shard.data.clear();
+    }
+    version.fetch_add(1, std::memory_order_release);
+}
+
+/*
+ * The binary database is a header followed by records appended in any order:
+ *
+ *   header: "ITPERFDB", u32 schema version, string host, string backend
+ *   record: u32 size of the rest of the record,
+ *           u32 device, u16 op type, u32 data type,
+ *           u64 hash, u16 op type, u32 number of attrs, i32 attrs[],
+ *           the record in the JSON of to_json(json &, const PerfRecord &),
+ *           encoded as CBOR
+ *   string: u32 size, chars
+ *
+ * Integers are in the byte order of the host, which the host fingerprint
+ * pins down.
+ */
+namespace {
+
+constexpr char Magic[8] = {'I', 'T', 'P', 'E', 'R', 'F', 'D', 'B'};
+
+template <typename T> void put(string &buf, T value) {
+    buf.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void putString(string &buf, const string &s) {
+    put<uint32_t>(buf, s.size());
+    buf += s;
+}
+
+class Reader {
+    const string &buf;
+    size_t pos = 0;
+
+  public:
+    explicit Reader(const string &buf) : buf(buf) {}
+    size_t remaining() const { return buf.size() - pos; }
+    size_t position() const { return pos; }
+
+    template <typename T> bool get(T &value) {
+        if (remaining() < sizeof(T))
+            return false;
+        std::memcpy(&value, buf.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+    bool getBytes(size_t n, string &s) {
+        if (remaining() < n)
+            return false;
+        s = buf.substr(pos, n);
+        pos += n;
+        return true;
+    }
+    bool getString(string &s) {
+        uint32_t n;
+        return get(n) && getBytes(n, s);
+    }
+};
+
+string encodeHeader() {
+    string buf(Magic, sizeof(Magic));
+    put<uint32_t>(buf, PerfEngine::SchemaVersion);
+    putString(buf, PerfEngine::getHostFingerprint());
+    putString(buf, PerfEngine::getBackendFingerprint());
+    return buf;
+}
+
+// Whether `reader` starts with the header of this process
+bool checkHeader(Reader &reader) {
+    string magic, host, backend;
+    uint32_t schema;
+    return reader.getBytes(sizeof(Magic), magic) &&
+           magic == string(Magic, sizeof(Magic)) && reader.get(schema) &&
+           schema == PerfEngine::SchemaVersion && reader.getString(host) &&
+           host == PerfEngine::getHostFingerprint() &&
+           reader.getString(backend) &&
+           backend == PerfEngine::getBackendFingerprint();
+}
+
+string encodeRecord(const PerfEngine::Key &key, const PerfRecord &record) {
+    auto &[device, opType, dataType] = key.first;
+    auto &opKey = key.second;
+    string payload;
+    put<uint32_t>(payload, enum_to_underlying(device));
+    put<OpType::underlying_t>(payload, opType);
+    put<uint32_t>(payload, dataType.getIndex());
+    put<uint64_t>(payload, opKey.hash);
+    put<OpType::underlying_t>(payload, opKey.opType);
+    put<uint32_t>(payload, opKey.attrs.size());
+    for (int attr : opKey.attrs)
+        put<int32_t>(payload, attr);
+    auto cbor = json::to_cbor(json(record));
+    payload.append(cbor.begin(), cbor.end());
+
+    string buf;
+    put<uint32_t>(buf, payload.size());
+    return buf + payload;
+}
+
+/**
+ * @brief Decode the next record into `key` and `record`. `record` is nullptr
+ * if its type is not registered in this build or its payload is mistyped.
+ *
+ * @return false at the end of the records or at a truncated record.
+ */
+bool decodeRecord(Reader &reader, PerfEngine::Key &key, PerfRecord &record) {
+    uint32_t size;
+    string payload;
+    if (!reader.get(size) || !reader.getBytes(size, payload))
+        return false;
+    Reader fields(payload);
+    uint32_t device, dataType, numAttrs;
+    OpType::underlying_t opType;
+    auto &opKey = key.second;
+    if (!fields.get(device) || !fields.get(opType) ||
+        !fields.get(dataType) || !fields.get(opKey.hash) ||
+        !fields.get(opKey.opType) || !fields.get(numAttrs) ||
+        fields.remaining() < size_t(numAttrs) * sizeof(int32_t))
+        return false;
+    opKey.attrs.resize(numAttrs);
+    for (auto &attr : opKey.attrs) {
+        int32_t value = 0;
+        fields.get(value);
+        attr = value;
+    }
+    key.first = KernelAttrs{Device(device), opType, DataType(dataType)};
+
+    string cbor;
+    fields.getBytes(fields.remaining(), cbor);
+    json j = json::from_cbor(cbor, true, false);
+    if (j.is_discarded())
+        return false;
+    // The framing is intact, so a payload that is not a record only skips
+    // this record
+    record = nullptr;
+    if (!j.is_object() || !j.contains("type") ||
+        !j["type"].is_number_integer() ||
+        !PerfRecordRegistry::getInstance().hasConstructor(
+            j["type"].get<int>()))
+        return true;
+    try {
+        record = j.get<PerfRecord>();
+    } catch (const json::exception &) {
+        record = nullptr;
+    }
+    return true;
+}
+
+// The whole file, or an empty string if it cannot be read
+string readFile(const string &file_path) {
+    std::ifstream filein(file_path, std::ios::in | std::ios::binary);
+    if (!filein.is_open())
+        return {};
+    std::ostringstream os;
+    os << filein.rdbuf();
+    return os.str();
+}
+
+// An advisory lock of `file_path`.lock, held by a process while it saves to
+// `file_path`
+class FileLock {
+    int fd;
+
+  public:
+    explicit FileLock(const string &file_path)
+        : fd(open((file_path + ".lock").c_str(), O_RDWR | O_CREAT, 0644)) {
+        IT_ASSERT(fd >= 0, "Cannot open " + file_path + ".lock");
+        while (flock(fd, LOCK_EX) != 0)
+            IT_ASSERT(errno == EINTR, "Cannot lock " + file_path);
+    }
+    FileLock(const FileLock &) = delete;
+    FileLock &operator=(const FileLock &) = delete;
+    ~FileLock() { close(fd); }
+};
+
+} // namespace
+
+void PerfEngine::savePerfEngineData(const string &file_path) const {
+    // Other processes saving to the file wait until it is written
+    FileLock lock(file_path);
+    // The fastest time of every key that the file already has
+    std::unordered_map<Key, double, KeyHash> saved;
+    const string existing = readFile(file_path);
+    Reader reader(existing);
+    const bool append = checkHeader(reader);
+    // Where the records end, dropping a truncated last record
+    size_t end = reader.position();
+    if (append) {
+        Key key;
+        PerfRecord record;
+        while (decodeRecord(reader, key, record)) {
+            end = reader.position();
+            if (!record)
+                continue;
+            auto [it, inserted] = saved.try_emplace(key, record->time);
+            if (!inserted)
+                it->second = std::min(it->second, record->time);
+        }
+    }
+
+    string buf = append ? existing.substr(0, end) : encodeHeader();
+    const size_t kept = buf.size();
+    for (auto &[key, record] : get_data()) {
+        auto it = saved.find(key);
+        if (it == saved.end() || record->time < it->second)
+            buf += encodeRecord(key, record);
+    }
+    // Only a file with another header or a truncated last record has to be
+    // rewritten
+    const bool rewrite = !append || end != existing.size();
+    if (!rewrite && buf.size() == kept)
+        return;
+    if (!rewrite) {
+        // A process loading the file meanwhile sees at most a truncated last
+        // record
+        std::ofstream fileout(file_path,
+                              std::ios::out | std::ios::binary | std::ios::app);
+        IT_ASSERT(fileout.is_open(), "Cannot open " + file_path);
+        fileout << buf.substr(kept);
+        IT_ASSERT(fileout.good(), "Cannot write " + file_path);
+        return;
+    }
+    // A rewritten file is renamed into place, so that it is never seen half
+    // written
+    const string temp_path = file_path + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream fileout(temp_path, std::ios::out | std::ios::binary |
+                                             std::ios::trunc);
+        IT_ASSERT(fileout.is_open(), "Cannot open " + temp_path);
+        fileout << buf;
+        fileout.close();
+        IT_ASSERT(fileout.good(), "Cannot write " + temp_path);
+    }
+    IT_ASSERT(std::rename(temp_path.c_str(), file_path.c_str()) == 0,
+              "Cannot replace " + file_path);
+}
+
+bool PerfEngine::loadPerfEngineData(const string &file_path) {
+    const string buf = readFile(file_path);
+    Reader reader(buf);
+    if (!checkHeader(reader))
+        return false;
+    Key key;
+    PerfRecord record;
+    while (decodeRecord(reader, key, record))
+        if (record)
+            setPerfData(key, record);
+    return true;
+}
+
+string PerfEngine::getHostFingerprint() {
+    string cpu = "unknown";
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    for (string line; std::getline(cpuinfo, line);)
+        if (line.rfind("model name", 0) == 0) {
+            cpu = line.substr(line.find(':') + 2);
+            break;
+        }
+    return cpu + " x" + std::to_string(std::thread::hardware_concurrency());
+}
+
+string PerfEngine::getBackendFingerprint() {
+    string backends = "cpu";
+#ifdef USE_CUDA
+    backends += ",cuda";
+#endif
+#ifdef USE_BANG
+    backends += ",bang";
+#endif
+#ifdef USE_INTELCPU
+    backends += ",intelcpu";
+#endif
+#ifdef USE_MKL
+    backends += ",mkl";
+#endif
+    return backends + "; " + __VERSION__;
 }
 
 void to_json(json &j, const PerfEngine &p) {
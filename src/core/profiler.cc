@@ -0,0 +1,163 @@
+#include "core/profiler.h"
+#include "core/operator.h"
+#include "utils/operator_utils.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <unordered_map>
+using json = nlohmann::json;
+
+namespace infini {
+
+void Profiler::enable(size_t minCapacity) {
+    IT_ASSERT(minCapacity > 0);
+    size_t newCapacity = 1;
+    while (newCapacity < minCapacity)
+        newCapacity <<= 1;
+    if (newCapacity != capacity) {
+        slots = std::make_unique<Slot[]>(newCapacity);
+        capacity = newCapacity;
+    }
+    clear();
+    {
+        std::lock_guard lock(mutex);
+        ops.clear();
+        ++generation;
+    }
+    enabled.store(true, std::memory_order_release);
+}
+
+void Profiler::clear() {
+    for (size_t i = 0; i < capacity; ++i)
+        slots[i].sequence.store(0, std::memory_order_relaxed);
+    head.store(0, std::memory_order_relaxed);
+}
+
+uint32_t Profiler::describe(const Operator &op, const string &kernel) {
+    string shapes;
+    for (auto &input : op->getInputs())
+        shapes += vecToString(input->getDims()) + ",";
+    if (!shapes.empty())
+        shapes.pop_back();
+    OpInfo info{op->getGuid(), op->getOpType(),   kernel,
+                shapes,        get_io_bytes(op), get_flops(op)};
+    std::lock_guard lock(mutex);
+    ops.emplace_back(std::move(info));
+    return ops.size() - 1;
+}
+
+Profiler::OpInfo Profiler::getOpInfo(uint32_t op) const {
+    std::lock_guard lock(mutex);
+    return ops.at(op);
+}
+
+uint32_t Profiler::getThreadId() {
+    static std::atomic<uint32_t> numThreads{0};
+    thread_local uint32_t id = numThreads++;
+    return id;
+}
+
+vector<Profiler::Event> Profiler::getEvents(uint64_t since) const {
+    vector<Event> events;
+    const uint64_t end = getEventCount();
+    const uint64_t begin = std::max(since, end > capacity ? end - capacity : 0);
+    for (uint64_t i = begin; i < end; ++i) {
+        const Slot &slot = slots[i & (capacity - 1)];
+        // Skip the slots still being written or already overwritten, also
+        // when that happens while they are copied
+        const uint64_t sequence = 2 * i + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != sequence)
+            continue;
+        Event event{slot.begin.load(std::memory_order_relaxed),
+                    slot.end.load(std::memory_order_relaxed),
+                    slot.op.load(std::memory_order_relaxed),
+                    slot.thread.load(std::memory_order_relaxed)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+            events.emplace_back(event);
+    }
+    return events;
+}
+
+string Profiler::toChromeTrace() const {
+    auto events = getEvents();
+    json trace = json::array();
+    if (!events.empty()) {
+        const int64_t origin = events.front().begin;
+        std::lock_guard lock(mutex);
+        for (auto &event : events) {
+            const auto &info = ops.at(event.op);
+            // Chrome traces count in microseconds
+            trace.push_back({{"name", info.type.toString()},
+                             {"cat", "op"},
+                             {"ph", "X"},
+                             {"ts", (event.begin - origin) / 1e3},
+                             {"dur", (event.end - event.begin) / 1e3},
+                             {"pid", 0},
+                             {"tid", event.thread},
+                             {"args",
+                              {{"guid", info.guid},
+                               {"kernel", info.kernel},
+                               {"shapes", info.shapes},
+                               {"bytes", info.bytes},
+                               {"flops", info.flops}}}});
+        }
+    }
+    return json{{"traceEvents", trace}, {"displayTimeUnit", "ms"}}.dump();
+}
+
+void Profiler::saveChromeTrace(const string &path) const {
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    IT_ASSERT(file.is_open(), "Cannot open " + path);
+    file << toChromeTrace() << std::endl;
+}
+
+string Profiler::summary(uint64_t since) const {
+    struct Row {
+        uint32_t op;
+        size_t count = 0;
+        double totalMs = 0;
+    };
+    vector<Row> rows;
+    std::unordered_map<size_t, size_t> rowOfOp;
+    double totalMs = 0;
+    for (auto &event : getEvents(since)) {
+        auto [it, inserted] = rowOfOp.try_emplace(event.op, rows.size());
+        if (inserted)
+            rows.push_back({event.op});
+        auto &row = rows[it->second];
+        const double ms = (event.end - event.begin) / 1e6;
+        ++row.count;
+        row.totalMs += ms;
+        totalMs += ms;
+    }
+    std::stable_sort(rows.begin(), rows.end(), [](auto &a, auto &b) {
+        return a.totalMs > b.totalMs;
+    });
+
+    std::ostringstream os;
+    os << std::fixed;
+    os << std::setw(6) << "Guid" << std::setw(20) << "Op" << std::setw(5)
+       << "Cnt" << std::setw(10) << "T_mean" << std::setw(8) << "Percent"
+       << std::setw(9) << "GB/s" << std::setw(9) << "GFLOP/s"
+       << "  Kernel  Shapes\n";
+    std::lock_guard lock(mutex);
+    for (auto &row : rows) {
+        const auto &info = ops.at(row.op);
+        const double meanMs = row.totalMs / row.count,
+                     seconds = std::max(meanMs, 1e-9) / 1e3;
+        os << std::setw(6) << info.guid << std::setw(20) << info.type.toString()
+           << std::setw(5) << row.count << std::setprecision(4)
+           << std::setw(10) << meanMs << std::setprecision(1) << std::setw(8)
+           << row.totalMs / std::max(totalMs, 1e-12) * 100 << std::setw(9)
+           << info.bytes / seconds / 1e9 << std::setw(9)
+           << info.flops / seconds / 1e9 << "  " << info.kernel << "  "
+           << info.shapes << "\n";
+    }
+    os << std::setprecision(4) << "Total " << totalMs << " ms\n";
+    return os.str();
+}
+
+} // namespace infini
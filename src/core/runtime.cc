@@ -1,60 +1,300 @@
 #include "core/runtime.h"
 #include "core/blob.h"
+#include "core/execution_plan.h"
 #include "core/kernel.h"
 #include "core/perf_engine.h"
+#include "core/profiler.h"
+#include "core/thread_pool.h"
 #include "utils/data_generator.h"
+#include <atomic>
 #include <chrono>
 #include <cstring>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 namespace infini {
 void CpuRuntimeObj::run(const Graph &graph, bool tune, bool profiling) const {
-    if (!tune && profiling)
-        IT_TODO_HALT();
-    const auto &kernelRegistry = KernelRegistry::getInstance();
+    auto &profiler = Profiler::getInstance();
+    const bool enabledHere = profiling && !profiler.isEnabled();
+    if (enabledHere)
+        profiler.enable();
+    const uint64_t firstEvent = profiler.getEventCount();
+    if (interOpPool && !tune)
+        runParallel(graph);
+    else
+        runSerial(graph, tune);
+    if (profiling) {
+        std::cout << profiler.summary(firstEvent);
+        if (enabledHere)
+            profiler.disable();
+    }
+}
+
+void CpuRuntimeObj::runSerial(const Graph &graph, bool tune) const {
     auto &perfEngine = PerfEngine::getInstance();
-    // Statistics
-    double totalTime = 0;
-    std::map<OpType, double> opTime;
-    std::map<OpType, int> opCnt;
+    const auto &kernelRegistry = KernelRegistry::getInstance();
+    auto plan = getExecutionPlan(graph);
+    auto &profiler = Profiler::getInstance();
+    const bool recording = profiler.isEnabled();
+    if (recording)
+        describeSteps(*plan);
 
-    for (auto &op : graph->getOperators()) {
-        auto kernelAttrs =
-            KernelAttrs{device, op->getOpType().underlying(), op->getDType()};
-        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
-        auto perfKey = PerfEngine::Key{kernelAttrs, op->getOpPerfKey()};
-        auto perfData = perfEngine.getPerfData(perfKey);
+    for (auto &step : plan->steps) {
+        // Structured bindings cannot be captured by lambdas in C++17
+        Kernel *kernel = step.kernel;
+        PerfRecord &record = step.record;
+        const Operator &op = step.op;
+        // Tune the kernels if there is no record, unless an operator with
+        // the same key has been tuned earlier in this run or is being tuned
+        // by another thread. Without a record and tuning, the default kernel
+        // runs with the default argument.
+        if (!record && tune) {
+            auto kernelAttrs = KernelAttrs{
+                device, op->getOpType().underlying(), op->getDType()};
+            record = perfEngine.getOrTune(
+                PerfEngine::Key{kernelAttrs, op->getOpPerfKey()},
+                [&]() { return kernelRegistry.tune(kernelAttrs, op, this); });
+            // The record may be of another kernel than the default one,
+            // which the description has to name
+            const auto &item =
+                kernelRegistry.getKernelItem(kernelAttrs, op, record);
+            if (std::get<0>(item) != kernel) {
+                step.kernel = kernel = std::get<0>(item);
+                if (recording)
+                    step.profileId = profiler.describe(op, std::get<1>(item));
+                else
+                    plan->profilerGeneration = 0;
+            }
+        }
 
-        // If no record and disable tuning, run with the default argument
-        if (!perfData && !tune) {
+        const int64_t begin = recording ? Profiler::now() : 0;
+        if (record)
+            kernel->compute(op, record, this);
+        else
             kernel->compute(op, this);
-            continue;
+        if (recording)
+            profiler.record(step.profileId, begin, Profiler::now());
+    }
+}
+
+void RuntimeObj::describeSteps(ExecutionPlanObj &plan) const {
+    auto &profiler = Profiler::getInstance();
+    if (plan.profilerGeneration == profiler.getGeneration())
+        return;
+    const auto &kernelRegistry = KernelRegistry::getInstance();
+    for (auto &step : plan.steps) {
+        auto kernelAttrs = KernelAttrs{device, step.op->getOpType().underlying(),
+                                       step.op->getDType()};
+        step.profileId = profiler.describe(
+            step.op, std::get<1>(kernelRegistry.getKernelItem(
+                         kernelAttrs, step.op, step.record)));
+    }
+    plan.profilerGeneration = profiler.getGeneration();
+}
+
+void CpuRuntimeObj::setParallelism(int interOpThreads, int intraOpThreads) {
+    IT_ASSERT(interOpThreads > 0 && intraOpThreads >= 0);
+    if (interOpThreads == 1) {
+        interOpPool = nullptr;
+        return;
+    }
+#ifdef _OPENMP
+    if (intraOpThreads == 0)
+        intraOpThreads = std::max(1, omp_get_num_procs() / interOpThreads);
+#endif
+    interOpPool = make_ref<ThreadPool>(interOpThreads, [intraOpThreads]() {
+#ifdef _OPENMP
+        omp_set_num_threads(intraOpThreads);
+#endif
+    });
+}
+
+// Returns the successors of every operator in `ops`, which must be in
+// topological order, and counts the predecessors of each. Besides reading
+// the output of its producer, an operator has to wait for every earlier
+// operator accessing memory it overwrites, as the allocator reuses memory
+// between tensors that are not connected.
+static vector<vector<size_t>>
+getExecutionDependencies(const OpVec &ops, vector<int> &numPredecessors) {
+    struct Access {
+        uintptr_t begin, end;
+        size_t op;
+        bool write;
+    };
+    auto getRange = [](const Tensor &tensor) {
+        auto begin = reinterpret_cast<uintptr_t>(
+            tensor->getRawDataPtr<void *>());
+        return std::make_pair(begin, begin + tensor->getSpanBytes());
+    };
+    // Weights are never written during a run and are left out.
+    vector<Access> accesses;
+    vector<vector<size_t>> successors(ops.size());
+    numPredecessors.assign(ops.size(), 0);
+    for (size_t i = 0; i < ops.size(); ++i) {
+        vector<size_t> deps;
+        for (auto &input : ops[i]->getInputs()) {
+            if (input->isWeight())
+                continue;
+            auto [begin, end] = getRange(input);
+            for (auto &access : accesses)
+                if (access.write && access.begin < end && begin < access.end)
+                    deps.emplace_back(access.op);
+        }
+        for (auto &output : ops[i]->getOutputs()) {
+            auto [begin, end] = getRange(output);
+            for (auto &access : accesses)
+                if (access.begin < end && begin < access.end)
+                    deps.emplace_back(access.op);
+        }
+        std::sort(deps.begin(), deps.end());
+        deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+        for (auto dep : deps) {
+            successors[dep].emplace_back(i);
+            ++numPredecessors[i];
         }
 
-        // TODO: The copy of record should be eliminated
-        PerfRecord record;
-        // Tune the kernel if there is no record
-        if (!perfData) {
-            // TODO: record is not used
-            // printf("no record data\n");
-            record = kernel->tune(op, this);
-            perfEngine.setPerfData(perfKey, record);
-        } else
-            record = perfData;
-
-        if (!profiling) {
-            kernel->compute(op, record, this);
-            continue;
-        } else {
-            double t = timeit([&]() { kernel->compute(op, record, this); },
-                              []() {}, 1, 1);
-            op->print();
-            printf(" op_time %lf\n", t);
-            totalTime += t;
-            opTime[op->getOpType()] += t;
-            opCnt[op->getOpType()]++;
+        for (auto &input : ops[i]->getInputs())
+            if (!input->isWeight()) {
+                auto [begin, end] = getRange(input);
+                accesses.push_back({begin, end, i, false});
+            }
+        for (auto &output : ops[i]->getOutputs()) {
+            auto [begin, end] = getRange(output);
+            // Later accesses to memory covered by this write depend on this
+            // operator, which already depends on the covered accesses.
+            accesses.erase(std::remove_if(accesses.begin(), accesses.end(),
+                                          [&](const Access &access) {
+                                              return begin <= access.begin &&
+                                                     access.end <= end;
+                                          }),
+                           accesses.end());
+            accesses.push_back({begin, end, i, true});
         }
     }
-    if (profiling)
-        printProfilingData(totalTime, opTime, opCnt);
+    return successors;
+}
+
+void CpuRuntimeObj::runParallel(const Graph &graph) const {
+    auto plan = getExecutionPlan(graph);
+    const auto &steps = plan->steps;
+    if (steps.empty())
+        return;
+    if (!plan->hasDependencies) {
+        OpVec ops;
+        for (auto &step : steps)
+            ops.emplace_back(step.op);
+        plan->successors =
+            getExecutionDependencies(ops, plan->numPredecessors);
+        plan->hasDependencies = true;
+    }
+    const auto &successors = plan->successors;
+    const auto &numPredecessors = plan->numPredecessors;
+    auto &profiler = Profiler::getInstance();
+    const bool recording = profiler.isEnabled();
+    if (recording)
+        describeSteps(*plan);
+
+    vector<std::atomic<int>> waiting(steps.size());
+    for (size_t i = 0; i < steps.size(); ++i)
+        waiting[i] = numPredecessors[i];
+    std::mutex mutex;
+    std::condition_variable done;
+    // Guarded by `mutex`: the tasks submitted but not finished, plus one
+    // held by this thread until the first tasks are submitted, and the first
+    // exception thrown by a kernel
+    size_t running = 1;
+    std::exception_ptr error;
+
+    // Nothing on the stack of run() may be touched once `running` is 0,
+    // so it is decremented and notified under the lock
+    auto finish = [&]() {
+        std::lock_guard lock(mutex);
+        if (--running == 0)
+            done.notify_all();
+    };
+    std::function<void(size_t)> launch = [&](size_t i) {
+        {
+            std::lock_guard lock(mutex);
+            ++running;
+        }
+        interOpPool->submit([&, i]() {
+            try {
+                auto &[kernel, record, op, profileId] = steps[i];
+                const int64_t begin = recording ? Profiler::now() : 0;
+                if (record)
+                    kernel->compute(op, record, this);
+                else
+                    kernel->compute(op, this);
+                if (recording)
+                    profiler.record(profileId, begin, Profiler::now());
+            } catch (...) {
+                std::lock_guard lock(mutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+            bool failed;
+            {
+                std::lock_guard lock(mutex);
+                failed = error != nullptr;
+            }
+            // After an exception, no more operators are started, as they
+            // would read outputs that were never computed
+            if (!failed)
+                for (auto succ : successors[i])
+                    if (--waiting[succ] == 0)
+                        launch(succ);
+            finish();
+        });
+    };
+    for (size_t i = 0; i < steps.size(); ++i)
+        if (numPredecessors[i] == 0)
+            launch(i);
+    finish();
+    std::unique_lock lock(mutex);
+    done.wait(lock, [&]() { return running == 0; });
+    if (error)
+        std::rethrow_exception(error);
+}
+
+ExecutionPlan RuntimeObj::getExecutionPlan(const Graph &graph) const {
+    auto &perfEngine = PerfEngine::getInstance();
+    auto plan = graph->getExecutionPlan();
+    if (plan && plan->runtime == this &&
+        plan->perfVersion == perfEngine.getVersion())
+        return plan;
+
+    const auto &kernelRegistry = KernelRegistry::getInstance();
+    if (!plan || plan->runtime != this) {
+        plan = make_ref<ExecutionPlanObj>();
+        plan->runtime = this;
+        for (auto &op : graph->getOperators()) {
+            // a view sharing the memory of its input has nothing to do
+            if (op->isAliasedView())
+                continue;
+            auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying(),
+                                           op->getDType()};
+            plan->steps.push_back(
+                {kernelRegistry.getKernel(kernelAttrs, op), nullptr, op});
+        }
+        graph->setExecutionPlan(plan);
+    }
+    for (auto &step : plan->steps) {
+        auto &op = step.op;
+        auto kernelAttrs =
+            KernelAttrs{device, op->getOpType().underlying(), op->getDType()};
+        step.record = perfEngine.getPerfData(
+            PerfEngine::Key{kernelAttrs, op->getOpPerfKey()});
+        // Dispatch to the kernel found fastest for the shape of the operator
+        Kernel *kernel = std::get<0>(
+            kernelRegistry.getKernelItem(kernelAttrs, op, step.record));
+        if (kernel != step.kernel) {
+            step.kernel = kernel;
+            // The descriptions name the kernels
+            plan->profilerGeneration = 0;
+        }
+    }
+    plan->perfVersion = perfEngine.getVersion();
+    return plan;
 }
 
 double RuntimeObj::getPerfTime(const Graph &graph, bool profiling) const {
@@ -66,15 +306,14 @@ double RuntimeObj::getPerfTime(const Graph &graph, bool profiling) const {
     std::map<OpType, int> opCnt;
 
     for (auto &op : graph->getOperators()) {
+        if (op->isAliasedView())
+            continue;
         auto kernelAttrs =
             KernelAttrs{device, op->getOpType().underlying(), op->getDType()};
-        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
         auto perfKey = PerfEngine::Key{kernelAttrs, op->getOpPerfKey()};
-        auto perfData = perfEngine.getPerfData(perfKey);
 
-        PerfRecord record;
-        // Tune the kernel if there is no record
-        if (!perfData) {
+        // Tune the kernels if there is no record
+        PerfRecord record = perfEngine.getOrTune(perfKey, [&]() {
             // TODO: should tenosrs automatically allocate when access data?
             // allocate memory for empty tensors and release it after profiling
             TensorVec allocatedTensors;
@@ -90,14 +329,13 @@ double RuntimeObj::getPerfTime(const Graph &graph, bool profiling) const {
             }
 
             // Profile operators and record the results
-            record = kernel->tune(op, this);
-            perfEngine.setPerfData(perfKey, record);
+            auto record = kernelRegistry.tune(kernelAttrs, op, this);
 
             // Free allocated memory
             for (auto t : allocatedTensors)
                 t->freeData();
-        } else
-            record = perfData;
+            return record;
+        });
 
         double t = record->time;
         totalTime += t;
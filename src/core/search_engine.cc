@@ -1,9 +1,12 @@
 #include "core/search_engine.h"
 #include "core/hash.h"
+#include "core/perf_engine.h"
 #include "core/runtime.h"
 
 #include <algorithm>
+#include <condition_variable>
 #include <iostream>
+#include <numeric>
 #include <unordered_set>
 
 namespace infini {
@@ -30,6 +33,7 @@ void SearchEngine::printMetaGraph(Ref<SearchEngine::MetaGraph> metaGraph) {
 
 Graph SearchEngine::run(const Graph graph) {
     IT_ASSERT(runtimeExec == graph->getRuntime());
+    costCache.clear();
     std::cout << "[INFO] original graph: " << std::endl;
     std::cout << graph->toString();
     std::cout << "[INFO] perf: " << runtimeExec->getPerfTime(graph)
@@ -60,22 +64,15 @@ Graph SearchEngine::run(const Graph graph) {
                         ops.emplace_back(op);
                     }
                 }
-                auto tmp = make_ref<GraphObj>(runtimeExec, ops);
-                tmp->dataMalloc();
-                nextGraphs.emplace_back(tmp);
+                nextGraphs.emplace_back(make_ref<GraphObj>(runtimeExec, ops));
             }
         }
-        std::sort(nextGraphs.begin(), nextGraphs.end(), [&](Graph x, Graph y) {
-            return runtimeExec->getPerfTime(x) < runtimeExec->getPerfTime(y);
-        });
-        if (nextGraphs.size() > GRAPH_SIZE) {
-            nextGraphs.resize(GRAPH_SIZE);
-        }
-        bestGraphs.clear();
-        for (size_t i = 0; i < nextGraphs.size(); i++) {
-            bestGraphs.emplace_back(nextGraphs[i]);
-        }
+        prune(nextGraphs);
+        bestGraphs = nextGraphs;
     }
+    // Only the survivors need memory
+    for (auto &bestGraph : bestGraphs)
+        bestGraph->dataMalloc();
 
     std::cout << "[INFO] unfused graph: " << std::endl;
     for (size_t i = 0; i < bestGraphs.size(); i++) {
@@ -102,15 +99,133 @@ std::vector<Graph> SearchEngine::search(const Graph &graph) {
         }
     }
 
-    sort(results.begin(), results.end(), [&](Graph x, Graph y) {
-        return runtimeExec->getPerfTime(x) < runtimeExec->getPerfTime(y);
-    }); // compare with perf time
-    if (results.size() > GRAPH_SIZE) {
-        results.resize(GRAPH_SIZE);
-    }
+    prune(results); // compare with perf time
     return results;
 }
 
+std::vector<double>
+SearchEngine::getCosts(const std::vector<Graph> &graphs) {
+    std::vector<HashType> hashes(graphs.size());
+    parallelFor(graphs.size(),
+                [&](size_t i) { hashes[i] = hashGraph(graphs[i]); });
+    // The first graph of every structure without a cost
+    std::vector<size_t> uncached;
+    std::unordered_set<HashType> seen;
+    for (size_t i = 0; i < graphs.size(); i++)
+        if (costCache.find(hashes[i]) == costCache.end() &&
+            seen.insert(hashes[i]).second)
+            uncached.emplace_back(i);
+    // Only reads PerfEngine, so it can run in parallel
+    std::vector<std::optional<double>> recorded(uncached.size());
+    parallelFor(uncached.size(), [&](size_t i) {
+        recorded[i] = getRecordedTime(graphs[uncached[i]]);
+    });
+    for (size_t i = 0; i < uncached.size(); i++) {
+        auto &graph = graphs[uncached[i]];
+        costCache[hashes[uncached[i]]] =
+            recorded[i] ? *recorded[i] : runtimeExec->getPerfTime(graph);
+    }
+
+    std::vector<double> costs;
+    for (auto hash : hashes)
+        costs.emplace_back(costCache.at(hash));
+    return costs;
+}
+
+void SearchEngine::prune(std::vector<Graph> &graphs) {
+    if (costModel && graphs.size() > numFinalists) {
+        std::vector<double> estimates(graphs.size());
+        parallelFor(graphs.size(), [&](size_t i) {
+            estimates[i] = costModel->getCost(graphs[i]);
+        });
+        keepBest(graphs, estimates, numFinalists);
+    }
+    keepBest(graphs, getCosts(graphs), GRAPH_SIZE);
+}
+
+void SearchEngine::keepBest(std::vector<Graph> &graphs,
+                            const std::vector<double> &costs, size_t n) {
+    std::vector<size_t> order(graphs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t x, size_t y) { return costs[x] < costs[y]; });
+    if (order.size() > n)
+        order.resize(n);
+    std::vector<Graph> best;
+    for (auto i : order)
+        best.emplace_back(graphs[i]);
+    graphs = std::move(best);
+}
+
+std::optional<double> SearchEngine::getRecordedTime(const Graph &graph) const {
+    auto &perfEngine = PerfEngine::getInstance();
+    double time = 0;
+    for (auto &op : graph->getOperators()) {
+        if (op->isAliasedView())
+            continue;
+        auto kernelAttrs = KernelAttrs{runtimeExec->getDevice(),
+                                       op->getOpType().underlying(),
+                                       op->getDType()};
+        auto record =
+            perfEngine.getPerfData(PerfEngine::Key{kernelAttrs,
+                                                   op->getOpPerfKey()});
+        if (!record)
+            return std::nullopt;
+        time += record->time;
+    }
+    return time;
+}
+
+HashType SearchEngine::hashGraph(const Graph &graph) {
+    // Tensors are numbered by the order in which operators produce them, and
+    // graph inputs are 0
+    std::unordered_map<TensorObj *, HashType> tensorIds;
+    HashType hash = 0;
+    for (auto &op : graph->getOperators()) {
+        hash = hashAppend(hash, op->getOpPerfKey().hash);
+        for (auto &input : op->getInputs()) {
+            auto it = tensorIds.find(input.get());
+            hash = hashAppend(hash, it == tensorIds.end() ? 0 : it->second);
+        }
+        for (auto &output : op->getOutputs())
+            tensorIds.emplace(output.get(), tensorIds.size() + 1);
+    }
+    return hash;
+}
+
+void SearchEngine::parallelFor(size_t n,
+                               const std::function<void(size_t)> &func) {
+    if (numThreads == 1 || n < 2) {
+        for (size_t i = 0; i < n; i++)
+            func(i);
+        return;
+    }
+    if (!pool)
+        pool = make_ref<ThreadPool>(numThreads);
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t remaining = n;
+    std::exception_ptr error;
+    for (size_t i = 0; i < n; i++)
+        pool->submit([&, i]() {
+            try {
+                func(i);
+            } catch (...) {
+                std::lock_guard lock(mutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+            // Nothing on the stack of parallelFor may be touched after this
+            std::lock_guard lock(mutex);
+            if (--remaining == 0)
+                done.notify_all();
+        });
+    std::unique_lock lock(mutex);
+    done.wait(lock, [&]() { return remaining == 0; });
+    if (error)
+        std::rethrow_exception(error);
+}
+
 // Build metagraph with a graph, each operator is a node.
 std::shared_ptr<SearchEngine::MetaGraph>
 SearchEngine::buildMetaGraphWithGraph(const Graph graph) {
@@ -322,12 +437,26 @@ void SearchEngine::searchMergeDfs(std::shared_ptr<MetaGraph> &metaGraph,
 // Search mutation for each compute op.
 std::vector<Graph> SearchEngine::searchMutation(
     const std::shared_ptr<SearchEngine::MetaGraph> &metaGraph) {
+    // Mutate the subgraphs with computing OPs, which are independent
+    auto &nodes = metaGraph->nodes;
+    std::vector<std::vector<Graph>> mutations(nodes.size());
+    auto mutate = [&](size_t i) {
+        if (nodes[i].type == 1)
+            mutations[i] = mutator->run(nodes[i].graph);
+    };
+    if (mutator->isThreadSafe())
+        parallelFor(nodes.size(), mutate);
+    else
+        for (size_t i = 0; i < nodes.size(); i++)
+            mutate(i);
+
     std::vector<Graph> graphs = {nullptr};
     // Append a node to all existing candidates
-    for (auto &node : metaGraph->nodes) {
+    for (size_t i = 0; i < nodes.size(); i++) {
+        auto &node = nodes[i];
         std::vector<Graph> nextGraphs;
         if (node.type == 1) { // If it has computing OPs
-            auto mutatedGraphs = mutator->run(node.graph);
+            auto &mutatedGraphs = mutations[i];
             for (auto graph : graphs) {
                 for (auto mutatedGraph : mutatedGraphs) {
                     std::vector<Operator> ops;
@@ -357,15 +486,7 @@ std::vector<Graph> SearchEngine::searchMutation(
                 nextGraphs.emplace_back(make_ref<GraphObj>(runtimeExec, ops));
             }
         }
-        for (auto g : nextGraphs) {
-            g->dataMalloc();
-        }
-        std::sort(nextGraphs.begin(), nextGraphs.end(), [&](Graph x, Graph y) {
-            return runtimeExec->getPerfTime(x) < runtimeExec->getPerfTime(y);
-        });
-        if (nextGraphs.size() > GRAPH_SIZE) {
-            nextGraphs.resize(GRAPH_SIZE);
-        }
+        prune(nextGraphs);
         graphs = nextGraphs;
     }
     return graphs;
@@ -13,6 +13,13 @@ TensorObj::TensorObj(Shape shape_, DataType dtype, Runtime runtime)
       _size(std::accumulate(shape.begin(), shape.end(), 1, std::multiplies{})) {
 }
 
+void TensorObj::setShape(Shape shape_) {
+    dim = shape_.size();
+    shape = std::move(shape_);
+    stride.clear();
+    _size = std::accumulate(shape.begin(), shape.end(), 1, std::multiplies{});
+}
+
 string TensorObj::toString() const {
     // Convert data pointer to string
     std::stringstream ss;
@@ -50,13 +57,42 @@ size_t TensorObj::getOffset(const vector<int> &pos) const {
 }
 
 Shape TensorObj::getStride() const {
-    Shape stride(getRank());
+    if (isStrided())
+        return stride;
+    Shape ret(getRank());
     ShapeElem p = 1;
     for (auto i = getRank(); i > 0; --i) {
-        stride[i - 1] = p;
+        ret[i - 1] = p;
         p = p * shape[i - 1];
     }
-    return stride;
+    return ret;
+}
+
+void TensorObj::setStride(Shape stride_) {
+    IT_ASSERT(stride_.empty() || stride_.size() == shape.size());
+    for (auto s : stride_)
+        IT_ASSERT(s >= 0);
+    stride = std::move(stride_);
+}
+
+bool TensorObj::isContiguous() const {
+    ShapeElem p = 1;
+    for (auto i = getRank(); isStrided() && i > 0; --i) {
+        // the stride of a dim of size 1 is never used
+        if (shape[i - 1] != 1 && stride[i - 1] != p)
+            return false;
+        p *= shape[i - 1];
+    }
+    return true;
+}
+
+size_t TensorObj::getSpanBytes() const {
+    if (!isStrided() || _size == 0)
+        return getBytes();
+    size_t last = 0;
+    for (size_t i = 0; i < shape.size(); ++i)
+        last += size_t(shape[i] - 1) * stride[i];
+    return (last + 1) * dtype.getSize();
 }
 
 void TensorObj::printData() const {
@@ -131,6 +167,7 @@ void TensorObj::copyData(const TensorObj *src) {
     IT_ASSERT(dtype == src->getDType());
     IT_ASSERT(size() == src->size());
     runtime->copyBlob(this, src);
+    ++dataVersion;
 }
 
 void TensorObj::setData(
@@ -147,9 +184,13 @@ void TensorObj::setData(
         runtime->copyBlobFromCPU(getRawDataPtr<void *>(),
                                  buffer->getPtr<void *>(), nBytes);
     }
+    ++dataVersion;
 }
 
-void TensorObj::setDataBlob(const Blob &blob) { this->data = blob; }
+void TensorObj::setDataBlob(const Blob &blob) {
+    this->data = blob;
+    ++dataVersion;
+}
 
 void TensorObj::load(std::string file_path) { loadTensorData(this, file_path); }
 
@@ -0,0 +1,96 @@
+#include "core/thread_pool.h"
+
+namespace infini {
+
+namespace {
+// The pool and the queue index of the current thread, if it is a worker
+thread_local const ThreadPool *currentPool = nullptr;
+thread_local int currentIndex = -1;
+} // namespace
+
+ThreadPool::ThreadPool(int numThreads,
+                       const std::function<void()> &initWorker) {
+    IT_ASSERT(numThreads > 0);
+    for (int i = 0; i < numThreads; ++i)
+        queues.emplace_back(std::make_unique<WorkQueue>());
+    for (int i = 0; i < numThreads; ++i)
+        workers.emplace_back([this, i, initWorker]() {
+            workerLoop(i, initWorker);
+        });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    size_t index;
+    {
+        // counted before it is queued so that `pending` never underflows
+        std::lock_guard lock(mutex);
+        index = currentPool == this ? currentIndex
+                                    : nextQueue++ % queues.size();
+        ++pending;
+    }
+    {
+        std::lock_guard lock(queues[index]->mutex);
+        queues[index]->tasks.emplace_back(std::move(task));
+    }
+    cv.notify_one();
+}
+
+bool ThreadPool::popTask(int index, std::function<void()> &task) {
+    {
+        auto &own = *queues[index];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); ++i) {
+        auto &other = *queues[(index + i) % queues.size()];
+        std::lock_guard lock(other.mutex);
+        if (!other.tasks.empty()) {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(int index,
+                            const std::function<void()> &initWorker) {
+    currentPool = this;
+    currentIndex = index;
+    if (initWorker)
+        initWorker();
+    std::function<void()> task;
+    while (true) {
+        if (popTask(index, task)) {
+            {
+                std::lock_guard lock(mutex);
+                --pending;
+            }
+            task();
+            task = nullptr;
+            continue;
+        }
+        // A task counted in `pending` may have been taken by another worker
+        // already, in which case this worker goes through the loop again.
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [this]() { return stopping || pending > 0; });
+        if (stopping && pending == 0)
+            return;
+    }
+}
+
+} // namespace infini
@@ -24,12 +24,15 @@ void CudaRuntimeObj::runWithoutSync(const Graph &graph) const {
     const auto &kernelRegistry = KernelRegistry::getInstance();
     auto &perfEngine = PerfEngine::getInstance();
     for (auto &op : graph->getOperators()) {
+        if (op->isAliasedView())
+            continue;
         // HACK: set correct data type
         auto kernelAttrs =
             KernelAttrs{device, op->getOpType().underlying(), op->getDType()};
-        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
         auto perfKey = PerfEngine::Key{kernelAttrs, op->getOpPerfKey()};
         auto perfData = perfEngine.getPerfData(perfKey);
+        Kernel *kernel = std::get<0>(
+            kernelRegistry.getKernelItem(kernelAttrs, op, perfData));
         // IT_ASSERT(perfData, "No perf data for OP " + op->toString());
         if (perfData) {
             kernel->compute(op, perfData, this);
@@ -50,15 +53,12 @@ void CudaRuntimeObj::tune(const Graph &graph, bool profiling = false) const {
         // HACK: set correct data type
         auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying(),
                                        DataType::Float32};
-        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
         auto perfKey = PerfEngine::Key{kernelAttrs, op->getOpPerfKey()};
-        auto perfData = perfEngine.getPerfData(perfKey);
-        PerfRecord record;
-        if (!perfData) {
-            record = kernel->tune(op, this);
-            perfEngine.setPerfData(perfKey, record);
-        } else
-            record = perfData;
+        PerfRecord record = perfEngine.getOrTune(perfKey, [&]() {
+            return kernelRegistry.tune(kernelAttrs, op, this);
+        });
+        Kernel *kernel =
+            std::get<0>(kernelRegistry.getKernelItem(kernelAttrs, op, record));
         double t = record->time;
         totalTime += t;
         json j;
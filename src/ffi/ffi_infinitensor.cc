@@ -1,14 +1,17 @@
 #include "core/data_type.h"
 #include "core/graph_handler.h"
+#include "core/profiler.h"
+#include "operators/attention.h"
 #include "operators/batch_norm.h"
 #include "operators/concat.h"
 #include "operators/conv.h"
 #include "operators/expand.h"
 #include "operators/gather.h"
+#include "operators/layer_norm.h"
 #include "operators/matmul.h"
 #include "operators/pad.h"
 #include "operators/pooling.h"
-#include "operators/reduce_mean.h"
+#include "operators/reduce.h"
 #include "operators/reshape.h"
 #include "operators/split.h"
 #include "operators/transpose.h"
@@ -86,10 +89,17 @@ void export_values(py::module &m) {
         .VALUE(OpType, Pow)
         .VALUE(OpType, Gather)
         .VALUE(OpType, ReduceMean)
+        .VALUE(OpType, ReduceSum)
+        .VALUE(OpType, ReduceMax)
+        .VALUE(OpType, ReduceMin)
+        .VALUE(OpType, ReduceL2)
         .VALUE(OpType, Reshape)
         .VALUE(OpType, Flatten)
         .VALUE(OpType, Identity)
         .VALUE(OpType, BatchNormalization)
+        .VALUE(OpType, LayerNormalization)
+        .VALUE(OpType, RMSNorm)
+        .VALUE(OpType, Attention)
         .VALUE(OpType, Softmax)
         .VALUE(OpType, Relu)
         .VALUE(OpType, Gelu)
@@ -191,6 +201,17 @@ static std::tuple<float, float, bool> batch_norm_attrs_of(Operator op) {
                            batchnorm->getTrainingMode());
 }
 
+static std::tuple<int, float> layer_norm_attrs_of(Operator op) {
+    auto norm = dynamic_cast<const LayerNormBaseObj *>(op.get());
+    IT_ASSERT(norm);
+    return std::make_tuple(norm->getAxis(), norm->getEps());
+}
+
+static float attention_scale_of(Operator op) {
+    IT_ASSERT(op->getOpType() == OpType::Attention);
+    return dynamic_cast<const AttentionObj *>(op.get())->getScale();
+}
+
 static std::tuple<int, int, int, int, int, int, int, int, int>
 pool_attrs_of(Operator op) {
     IT_ASSERT(op->getOpType() == OpType::MaxPool ||
@@ -208,12 +229,12 @@ clip_attrs_of(Operator op) {
     return std::make_tuple(clip->getMin(), clip->getMax());
 }
 
-static std::tuple<vector<int>, bool> reduce_mean_attrs_of(Operator op) {
-    IT_ASSERT(op->getOpType() == OpType::ReduceMean);
-    auto reduce_mean = dynamic_cast<const ReduceMeanObj *>(op.get());
-    auto &set = reduce_mean->getAxes();
+static std::tuple<vector<int>, bool> reduce_attrs_of(Operator op) {
+    auto reduce = dynamic_cast<const ReduceBaseObj *>(op.get());
+    IT_ASSERT(reduce);
+    auto &set = reduce->getAxes();
     return std::make_tuple(vector(set.begin(), set.end()),
-                           reduce_mean->getKeepDims());
+                           reduce->getKeepDims());
 }
 
 static int concat_axis_of(Operator op) {
@@ -275,6 +296,20 @@ static int cast_to_of(Operator op) {
     return castOutputDtype.getIndex();
 }
 
+static void start_profiling(size_t capacity) {
+    Profiler::getInstance().enable(capacity);
+}
+
+static void stop_profiling() { Profiler::getInstance().disable(); }
+
+static std::string profiling_summary() {
+    return Profiler::getInstance().summary();
+}
+
+static void save_chrome_trace(const std::string &path) {
+    Profiler::getInstance().saveChromeTrace(path);
+}
+
 void export_functions(py::module &m) {
 #define FUNCTION(NAME) def(#NAME, &NAME)
     m.def("cpu_runtime", &NativeCpuRuntimeObj::getInstance)
@@ -294,9 +329,11 @@ void export_functions(py::module &m) {
         .FUNCTION(conv_trans_attrs_of)
         .FUNCTION(matmul_attrs_of)
         .FUNCTION(batch_norm_attrs_of)
+        .FUNCTION(layer_norm_attrs_of)
+        .FUNCTION(attention_scale_of)
         .FUNCTION(pool_attrs_of)
         .FUNCTION(clip_attrs_of)
-        .FUNCTION(reduce_mean_attrs_of)
+        .FUNCTION(reduce_attrs_of)
         .FUNCTION(tensor_dtype)
         .FUNCTION(reshape_shape_of)
         .FUNCTION(expand_shape_of)
@@ -306,7 +343,11 @@ void export_functions(py::module &m) {
         .FUNCTION(split_axis_of)
         .FUNCTION(gather_axis_of)
         .FUNCTION(flatten_axis_of)
-        .FUNCTION(cast_to_of);
+        .FUNCTION(cast_to_of)
+        .def("start_profiling", &start_profiling, py::arg("capacity") = 1 << 16)
+        .FUNCTION(stop_profiling)
+        .FUNCTION(profiling_summary)
+        .FUNCTION(save_chrome_trace);
 #undef FUNCTION
 }
 
@@ -433,6 +474,9 @@ void init_graph_builder(py::module &m) {
         .def("convTransposed2d", &Handler::convTransposed2d, policy::move)
         .def("matmul", &Handler::matmul, policy::move)
         .def("batchNormalization", &Handler::batchNormalization, policy::move)
+        .def("layerNormalization", &Handler::layerNormalization, policy::move)
+        .def("rmsNorm", &Handler::rmsNorm, policy::move)
+        .def("attention", &Handler::attention, policy::move)
         .def("maxPool", &Handler::maxPool, policy::move)
         .def("avgPool", &Handler::avgPool, policy::move)
         .def("add", &Handler::add, policy::move)
@@ -463,6 +507,10 @@ void init_graph_builder(py::module &m) {
         .def("split", &Handler::split, policy::move)
         .def("gather", &Handler::gather, policy::move)
         .def("reduce_mean", &Handler::reduceMean, policy::move)
+        .def("reduce_sum", &Handler::reduceSum, policy::move)
+        .def("reduce_max", &Handler::reduceMax, policy::move)
+        .def("reduce_min", &Handler::reduceMin, policy::move)
+        .def("reduce_l2", &Handler::reduceL2, policy::move)
         .def("slice", &Handler::slice, policy::move)
         .def("pad", &Handler::pad, policy::move)
         .def("allReduceSum", &Handler::allReduceSum, policy::move)
@@ -478,6 +526,7 @@ void init_graph_builder(py::module &m) {
         .def("where", &Handler::where, policy::move)
         .def("topo_sort", &Handler::topo_sort, policy::automatic)
         .def("optimize", &Handler::optimize, policy::automatic)
+        .def("fold_constants", &Handler::fold_constants, policy::automatic)
         .def("operators", &Handler::operators, policy::move)
         .def("data_malloc", &Handler::data_malloc, policy::automatic)
         .def("get_perf_time", &Handler::get_perf_time, policy::automatic)
@@ -0,0 +1,174 @@
+#include "operators/attention.h"
+#include "core/kernel.h"
+#include "cpu/cpu_gemm.h"
+#include "cpu/cpu_math.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace infini {
+
+namespace {
+
+// Query rows that share the loads of a block of keys and values
+constexpr size_t QUERY_BLOCK = 32;
+// Keys whose scores are held at once, so that a [QUERY_BLOCK, KEY_BLOCK]
+// score tile stays in L1/L2 between the two products
+constexpr size_t KEY_BLOCK = 128;
+// Below this many multiply-adds the OpenMP fork costs more than it saves.
+constexpr size_t PARALLEL_WORKLOAD = 1 << 15;
+
+struct AttentionShape {
+    size_t sq, sk, d, dv;
+    float scale;
+    // The mask element of score (i, j) of a batch is at
+    // offset + i * maskRowStride + j * maskColStride.
+    size_t maskRowStride, maskColStride;
+};
+
+// Per-thread buffers of a query block
+struct AttentionScratch {
+    std::vector<float> query, scores, rowMax, rowSum;
+    AttentionScratch(size_t d)
+        : query(QUERY_BLOCK * d), scores(QUERY_BLOCK * KEY_BLOCK),
+          rowMax(QUERY_BLOCK), rowSum(QUERY_BLOCK) {}
+};
+
+// Attention of `rows` queries against all keys. The keys are visited a block
+// at a time, and every row keeps the running maximum and sum of the online
+// softmax, rescaling its partial output whenever the maximum grows.
+void attentionBlock(const AttentionShape &s, const float *q, const float *k,
+                    const float *v, const float *mask, float *o, size_t i0,
+                    size_t rows, AttentionScratch &buf) {
+    float *qs = buf.query.data(), *scores = buf.scores.data(),
+          *rowMax = buf.rowMax.data(), *rowSum = buf.rowSum.data();
+    const float scale = s.scale;
+#pragma omp simd
+    for (size_t i = 0; i < rows * s.d; ++i)
+        qs[i] = q[i] * scale;
+    std::fill_n(rowMax, rows, -INFINITY);
+    std::fill_n(rowSum, rows, 0.f);
+    std::fill_n(o, rows * s.dv, 0.f);
+
+    for (size_t j0 = 0; j0 < s.sk; j0 += KEY_BLOCK) {
+        const size_t cols = std::min(KEY_BLOCK, s.sk - j0);
+        cpuGemm(false, true, rows, cols, s.d, qs, s.d, k + j0 * s.d, s.d,
+                scores, cols);
+        for (size_t i = 0; i < rows; ++i) {
+            float *row = scores + i * cols;
+            if (mask) {
+                const float *m = mask + (i0 + i) * s.maskRowStride +
+                                 j0 * s.maskColStride;
+                const size_t stride = s.maskColStride;
+#pragma omp simd
+                for (size_t j = 0; j < cols; ++j)
+                    row[j] += m[j * stride];
+            }
+            float maxVal = rowMax[i];
+#pragma omp simd reduction(max : maxVal)
+            for (size_t j = 0; j < cols; ++j)
+                maxVal = std::max(maxVal, row[j]);
+            // Rows masked out so far keep 0 as the base of the exponent
+            const float base = maxVal == -INFINITY ? 0.f : maxVal;
+            const float alpha = std::exp(rowMax[i] - base);
+            float sum = 0;
+#pragma omp simd reduction(+ : sum)
+            for (size_t j = 0; j < cols; ++j) {
+                row[j] = cpuExp(row[j] - base);
+                sum += row[j];
+            }
+            rowSum[i] = rowSum[i] * alpha + sum;
+            rowMax[i] = maxVal;
+            if (alpha != 1.f) {
+                float *out = o + i * s.dv;
+#pragma omp simd
+                for (size_t j = 0; j < s.dv; ++j)
+                    out[j] *= alpha;
+            }
+        }
+        cpuGemm(false, false, rows, s.dv, cols, scores, cols, v + j0 * s.dv,
+                s.dv, o, s.dv, true);
+    }
+    for (size_t i = 0; i < rows; ++i) {
+        const float inv = rowSum[i] > 0 ? 1.f / rowSum[i] : 0.f;
+        float *out = o + i * s.dv;
+#pragma omp simd
+        for (size_t j = 0; j < s.dv; ++j)
+            out[j] *= inv;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Flash-style attention. Every block of queries walks the keys in
+ * blocks with an online softmax, so that only a [QUERY_BLOCK, KEY_BLOCK]
+ * tile of the scores exists at a time instead of the [..., S_q, S_k] score
+ * tensor. Both products of a tile go through cpuGemm, and the batches and
+ * query blocks are distributed over OpenMP threads.
+ */
+class AttentionCpu : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<AttentionObj>(_op);
+        auto query = op->getInputs(0), key = op->getInputs(1),
+             value = op->getInputs(2), mask = op->getMask();
+        const auto qDims = query->getDims();
+        const size_t rank = qDims.size();
+        AttentionShape s;
+        s.sq = qDims[rank - 2];
+        s.d = qDims[rank - 1];
+        s.sk = key->getDims()[rank - 2];
+        s.dv = value->getDims().back();
+        s.scale = op->getScale();
+        const size_t batch = query->size() / (s.sq * s.d);
+
+        // Strides of the mask along the axes of the scores, 0 for the
+        // broadcast ones
+        vector<size_t> maskStrides(rank, 0);
+        if (mask) {
+            const auto mDims = mask->getDims();
+            size_t stride = 1;
+            for (size_t i = 1; i <= mDims.size(); ++i) {
+                if (mDims[mDims.size() - i] != 1)
+                    maskStrides[rank - i] = stride;
+                stride *= mDims[mDims.size() - i];
+            }
+        }
+        s.maskRowStride = maskStrides[rank - 2];
+        s.maskColStride = maskStrides[rank - 1];
+        vector<size_t> maskOffsets(batch, 0);
+        if (mask)
+            for (size_t b = 0; b < batch; ++b)
+                for (size_t rest = b, i = rank - 2; i-- > 0;
+                     rest /= qDims[i])
+                    maskOffsets[b] += rest % qDims[i] * maskStrides[i];
+
+        const float *q = query->getRawDataPtr<float *>(),
+                    *k = key->getRawDataPtr<float *>(),
+                    *v = value->getRawDataPtr<float *>(),
+                    *m = mask ? mask->getRawDataPtr<float *>() : nullptr;
+        float *o = op->getOutput()->getRawDataPtr<float *>();
+        const size_t qBlocks = (s.sq + QUERY_BLOCK - 1) / QUERY_BLOCK;
+        const bool parallel =
+            batch * s.sq * s.sk * (s.d + s.dv) > PARALLEL_WORKLOAD;
+#pragma omp parallel if (parallel)
+        {
+            AttentionScratch buf(s.d);
+#pragma omp for collapse(2) schedule(static)
+            for (size_t b = 0; b < batch; ++b)
+                for (size_t qb = 0; qb < qBlocks; ++qb) {
+                    const size_t i0 = qb * QUERY_BLOCK,
+                                 rows = std::min(QUERY_BLOCK, s.sq - i0);
+                    attentionBlock(s, q + (b * s.sq + i0) * s.d,
+                                   k + b * s.sk * s.d, v + b * s.sk * s.dv,
+                                   m ? m + maskOffsets[b] : nullptr,
+                                   o + (b * s.sq + i0) * s.dv, i0, rows, buf);
+                }
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Attention, DataType::Float32,
+                AttentionCpu, "attention_CPU_float32");
+} // namespace infini
@@ -0,0 +1,65 @@
+#include "cpu/cpu_broadcast.h"
+
+namespace infini {
+
+BroadcastShape::BroadcastShape(const Shape &output,
+                               const vector<Shape> &inputs,
+                               const vector<Shape> &inputStrides) {
+    const int rank = output.size(), nInputs = inputs.size();
+    IT_ASSERT(inputStrides.empty() || (int)inputStrides.size() == nInputs);
+    // Align the strides of every input to the output rank, with 0 along the
+    // broadcast dimensions
+    vector<vector<size_t>> aligned;
+    for (int i = 0; i < nInputs; ++i) {
+        const auto &in = inputs[i];
+        IT_ASSERT((int)in.size() <= rank);
+        const int offset = rank - in.size();
+        vector<size_t> s(rank, 0);
+        size_t stride = 1;
+        for (int d = rank - 1; d >= offset; --d) {
+            const int dim = in[d - offset];
+            IT_ASSERT(dim == output[d] || dim == 1,
+                      "Input is not broadcastable to the output");
+            if (!inputStrides.empty())
+                stride = inputStrides[i][d - offset];
+            if (dim != 1)
+                s[d] = stride;
+            stride *= dim;
+        }
+        aligned.emplace_back(std::move(s));
+    }
+
+    // Drop unit dimensions and merge a dimension into the previous one if
+    // every input steps over the previous one as over `output[d]` elements
+    // of this one, i.e. it is broadcast along both or contiguous across them.
+    strides.resize(nInputs);
+    for (int d = 0; d < rank; ++d) {
+        if (output[d] == 1)
+            continue;
+        bool canMerge = !dims.empty();
+        for (int i = 0; i < nInputs && canMerge; ++i)
+            canMerge = strides[i].back() == aligned[i][d] * output[d];
+        if (canMerge) {
+            dims.back() *= output[d];
+            for (int i = 0; i < nInputs; ++i)
+                strides[i].back() = aligned[i][d];
+        } else {
+            dims.emplace_back(output[d]);
+            for (int i = 0; i < nInputs; ++i)
+                strides[i].emplace_back(aligned[i][d]);
+        }
+    }
+    if (dims.empty()) {
+        dims = {1};
+        strides.assign(nInputs, {0});
+    }
+}
+
+size_t BroadcastShape::getOuterSize() const {
+    size_t ret = 1;
+    for (size_t d = 0; d + 1 < dims.size(); ++d)
+        ret *= dims[d];
+    return ret;
+}
+
+} // namespace infini
@@ -0,0 +1,38 @@
+#include "operators/concat.h"
+#include "core/kernel.h"
+#include "cpu/cpu_copy.h"
+
+namespace infini {
+
+// Each input is copied into its slice of the output along the axis
+class ConcatCpu : public CpuKernelWithoutConfig {
+    bool supportsStridedInput(const Operator &op, int index) const override {
+        return true;
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<ConcatObj>(_op);
+        auto output = op->getOutput();
+        const int dim = op->getDim();
+        const auto dstStrides = cpuContiguousStrides(output->getDims());
+        const size_t elemSize = output->getDType().getSize();
+        auto dst = output->getRawDataPtr<uint8_t *>();
+        for (auto &input : op->getInputs()) {
+            cpuStridedCopy(elemSize, input->getDims(), dst, dstStrides,
+                           input->getRawDataPtr<void *>(), cpuStrides(input));
+            dst += input->getDims()[dim] * dstStrides[dim] * elemSize;
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Concat, DataType::Float32, ConcatCpu,
+                "concat_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Concat, DataType::Float16, ConcatCpu,
+                "concat_CPU_float16");
+REGISTER_KERNEL(Device::CPU, OpType::Concat, DataType::Int32, ConcatCpu,
+                "concat_CPU_int32");
+REGISTER_KERNEL(Device::CPU, OpType::Concat, DataType::Int64, ConcatCpu,
+                "concat_CPU_int64");
+
+} // namespace infini
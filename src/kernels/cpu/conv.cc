@@ -1,60 +1,272 @@
 #include "operators/conv.h"
 #include "core/kernel.h"
+#include "cpu/cpu_conv.h"
+#include "cpu/cpu_gemm.h"
+#include <limits>
 
 namespace infini {
 
-template <typename T> class NaiveConv : public CpuKernelWithoutConfig {
-    void compute(const Operator &_op,
-                 const RuntimeObj *context) const override {
-        auto op = as<ConvObj>(_op);
-        T *iptr = op->getInputs(0)->getRawDataPtr<T *>();
-        T *wptr = op->getInputs(1)->getRawDataPtr<T *>();
-        T *optr = op->getOutput()->getRawDataPtr<T *>();
-        //  Clang will give an error of " reference to local binding 'sh'
-        //  declared in enclosing function" if we write like this:
-        //        auto [n, c, h, w, f, r, s] = op->getNCHWFRS();
+template <typename T> class ConvCpu : public Kernel {
+    using Algo = ConvCpuPerfRecordObj::Algo;
+    // Output channels computed together by the blocked direct algorithm
+    static constexpr int FB = 16;
+    // Output columns computed together by the blocked direct algorithm
+    static constexpr int OWB = 8;
+
+    struct ConvArgs {
         int n, c, h, w, f, r, s;
-        std::tie(n, c, h, w, f, r, s) = op->getNCHWFRS();
         int ph, pw, sh, sw, dh, dw;
-        std::tie(ph, pw, sh, sw, dh, dw) = op->getPadStrideDilation();
-        int cpg = op->getChannelPerGroup();
-        int g = op->getNumGroups();
-        IT_ASSERT(f % g == 0, "Illegal number of channel");
+        int oh, ow, g, cpg;
+        ActType act;
+    };
+
+    static ConvArgs getArgs(const Ref<ConvObj> &op) {
+        ConvArgs a;
+        std::tie(a.n, a.c, a.h, a.w, a.f, a.r, a.s) = op->getNCHWFRS();
+        std::tie(a.ph, a.pw, a.sh, a.sw, a.dh, a.dw) =
+            op->getPadStrideDilation();
         auto outDim = op->getOutput()->getDims();
-        int oh = outDim[2], ow = outDim[3];
-        for (int nn = 0; nn < n; nn++) {
-#pragma omp parallel for
-            for (int ff = 0; ff < f; ff++) {
-                for (int hh = 0; hh < oh; hh++)
-                    for (int ww = 0; ww < ow; ww++) {
-                        int gidx = ff / (f / g);
-                        T val = 0;
-                        for (int cc = 0; cc < cpg; cc++)
-                            for (int rr = 0; rr < r; rr++)
-                                for (int ss = 0; ss < s; ss++) {
-                                    // clang-format off
-                                int posH = hh * sh + rr * dh - ph;
-                                int posW = ww * sw + ss * dw - pw;
-                                if (posH < 0 || posH >= h || posW < 0 || posW >= w)
+        a.oh = outDim[2], a.ow = outDim[3];
+        a.g = op->getNumGroups();
+        a.cpg = op->getChannelPerGroup();
+        a.act = op->getAct();
+        IT_ASSERT(a.f % a.g == 0, "Illegal number of channel");
+        return a;
+    }
+
+    static const T *getBiasPtr(const Ref<ConvObj> &op) {
+        auto bias = op->getBias();
+        return bias ? bias->getRawDataPtr<T *>() : nullptr;
+    }
+
+    static bool isApplicable(const ConvArgs &a, int algo) {
+        switch (algo) {
+        case Algo::Auto:
+        case Algo::Im2colGemm:
+            return true;
+        case Algo::DirectBlocked:
+            return a.g == 1 && a.r == a.s && (a.r == 1 || a.r == 3);
+        case Algo::Depthwise:
+            return a.g > 1 && a.g == a.c && a.cpg == 1;
+        default:
+            return false;
+        }
+    }
+
+    static int chooseAlgo(const ConvArgs &a) {
+        if (isApplicable(a, Algo::Depthwise))
+            return Algo::Depthwise;
+        // Few input channels give GEMM a short reduction; filters over a
+        // narrow image are then better served from registers directly.
+        if (isApplicable(a, Algo::DirectBlocked) && a.c * a.r * a.s < 64)
+            return Algo::DirectBlocked;
+        return Algo::Im2colGemm;
+    }
+
+    // Unfolds one group of one image into a [cpg * r * s, oh * ow] matrix.
+    static void im2col(const ConvArgs &a, const T *in, T *col) {
+        const int rows = a.cpg * a.r * a.s, spatial = a.oh * a.ow;
+#pragma omp parallel for if ((size_t)rows * spatial > (1 << 16))
+        for (int row = 0; row < rows; ++row) {
+            const int cc = row / (a.r * a.s), rr = row / a.s % a.r,
+                      ss = row % a.s;
+            const T *src = in + (size_t)cc * a.h * a.w;
+            T *dst = col + (size_t)row * spatial;
+            for (int y = 0; y < a.oh; ++y, dst += a.ow) {
+                const int ih = y * a.sh + rr * a.dh - a.ph;
+                if (ih < 0 || ih >= a.h) {
+                    std::fill_n(dst, a.ow, T(0));
+                    continue;
+                }
+                const T *srcRow = src + (size_t)ih * a.w;
+                for (int x = 0; x < a.ow; ++x) {
+                    const int iw = x * a.sw + ss * a.dw - a.pw;
+                    dst[x] = (iw >= 0 && iw < a.w) ? srcRow[iw] : T(0);
+                }
+            }
+        }
+    }
+
+    static void im2colGemm(const ConvArgs &a, const T *in, const T *wt,
+                           const T *bias, T *out) {
+        const int fpg = a.f / a.g, kdim = a.cpg * a.r * a.s,
+                  spatial = a.oh * a.ow;
+        const bool pointwise = a.r == 1 && a.s == 1 && a.sh == 1 &&
+                               a.sw == 1 && a.ph == 0 && a.pw == 0;
+        vector<T> col(pointwise ? 0 : (size_t)kdim * spatial);
+        for (int nn = 0; nn < a.n; ++nn)
+            for (int gg = 0; gg < a.g; ++gg) {
+                const T *src = in + ((size_t)nn * a.c + gg * a.cpg) * a.h * a.w;
+                T *dst = out + ((size_t)nn * a.f + gg * fpg) * spatial;
+                if (!pointwise)
+                    im2col(a, src, col.data());
+                // The bias is filled into the output and accumulated onto
+                if (bias)
+                    for (int ff = 0; ff < fpg; ++ff)
+                        std::fill_n(dst + (size_t)ff * spatial, spatial,
+                                    bias[gg * fpg + ff]);
+                cpuGemm<T>(false, false, fpg, spatial, kdim,
+                           wt + (size_t)gg * fpg * kdim, kdim,
+                           pointwise ? src : col.data(), spatial, dst, spatial,
+                           bias != nullptr, a.act);
+            }
+    }
+
+    static void directBlocked(const ConvArgs &a, const T *in, const T *wt,
+                              const T *bias, T *out) {
+        const int nfb = (a.f + FB - 1) / FB, rs = a.r * a.s;
+        // Pack the weight into [f / FB, c, r, s, FB] so that each input
+        // element is multiplied with FB contiguous output channels.
+        vector<T> packed((size_t)nfb * a.c * rs * FB, T(0));
+        for (int ff = 0; ff < a.f; ++ff)
+            for (int i = 0; i < a.c * rs; ++i)
+                packed[((size_t)(ff / FB) * a.c * rs + i) * FB + ff % FB] =
+                    wt[(size_t)ff * a.c * rs + i];
+        const size_t spatial = (size_t)a.oh * a.ow;
+#pragma omp parallel for collapse(3)
+        for (int nn = 0; nn < a.n; ++nn)
+            for (int fb = 0; fb < nfb; ++fb)
+                for (int y = 0; y < a.oh; ++y) {
+                    const int nf = std::min(FB, a.f - fb * FB);
+                    const T *src = in + (size_t)nn * a.c * a.h * a.w;
+                    const T *wBlock =
+                        packed.data() + (size_t)fb * a.c * rs * FB;
+                    T *dst = out + ((size_t)nn * a.f + fb * FB) * spatial +
+                             (size_t)y * a.ow;
+                    for (int x0 = 0; x0 < a.ow; x0 += OWB) {
+                        const int nx = std::min(OWB, a.ow - x0);
+                        T acc[OWB][FB] = {};
+                        if (bias)
+                            for (int x = 0; x < OWB; ++x)
+                                std::copy_n(bias + fb * FB, nf, acc[x]);
+                        for (int cc = 0; cc < a.c; ++cc)
+                            for (int rr = 0; rr < a.r; ++rr) {
+                                const int ih = y * a.sh + rr * a.dh - a.ph;
+                                if (ih < 0 || ih >= a.h)
                                     continue;
-                                auto iOffset = posW + w * (posH + h * ((cc + gidx * cpg) + c * nn)),
-                                    wOffset = ss + s * (rr + r * (cc + cpg * ff));
-                                auto inputVal = iptr[iOffset], weightVal = wptr[wOffset];
-                                val += weightVal * inputVal;
-                                    // clang-format on
+                                const T *srcRow =
+                                    src + ((size_t)cc * a.h + ih) * a.w;
+                                for (int ss = 0; ss < a.s; ++ss) {
+                                    const T *wv =
+                                        wBlock + ((cc * a.r + rr) * a.s + ss) *
+                                                     FB;
+                                    for (int x = 0; x < nx; ++x) {
+                                        const int iw = (x0 + x) * a.sw +
+                                                       ss * a.dw - a.pw;
+                                        if (iw < 0 || iw >= a.w)
+                                            continue;
+                                        const T v = srcRow[iw];
+#pragma omp simd
+                                        for (int j = 0; j < FB; ++j)
+                                            acc[x][j] += v * wv[j];
+                                    }
                                 }
-                        // TODO: check correctness, oh & ow or h & w?
-                        auto oOffset = ww + ow * (hh + oh * (ff + f * nn));
-                        optr[oOffset] = val;
+                            }
+                        for (int j = 0; j < nf; ++j) {
+                            T *o = dst + j * spatial + x0;
+                            for (int x = 0; x < nx; ++x)
+                                o[x] = acc[x][j];
+                            cpuApplyAct(o, nx, a.act);
+                        }
+                    }
+                }
+    }
+
+    static void depthwise(const ConvArgs &a, const T *in, const T *wt,
+                          const T *bias, T *out) {
+        const int multiplier = a.f / a.c;
+        const size_t spatial = (size_t)a.oh * a.ow;
+#pragma omp parallel for collapse(2)
+        for (int nn = 0; nn < a.n; ++nn)
+            for (int ff = 0; ff < a.f; ++ff) {
+                const T *src =
+                    in + ((size_t)nn * a.c + ff / multiplier) * a.h * a.w;
+                const T *wv = wt + (size_t)ff * a.r * a.s;
+                T *dst = out + ((size_t)nn * a.f + ff) * spatial;
+                std::fill_n(dst, spatial, bias ? bias[ff] : T(0));
+                for (int y = 0; y < a.oh; ++y) {
+                    T *o = dst + (size_t)y * a.ow;
+                    for (int rr = 0; rr < a.r; ++rr) {
+                        const int ih = y * a.sh + rr * a.dh - a.ph;
+                        if (ih < 0 || ih >= a.h)
+                            continue;
+                        const T *srcRow = src + (size_t)ih * a.w;
+                        for (int ss = 0; ss < a.s; ++ss) {
+                            // Output columns whose input column is in range
+                            const int off = ss * a.dw - a.pw;
+                            const int lo =
+                                std::max(0, (-off + a.sw - 1) / a.sw);
+                            const int hi =
+                                std::min(a.ow, (a.w - off + a.sw - 1) / a.sw);
+                            const T k = wv[rr * a.s + ss];
+#pragma omp simd
+                            for (int x = lo; x < hi; ++x)
+                                o[x] += k * srcRow[x * a.sw + off];
+                        }
                     }
+                }
+                cpuApplyAct(dst, spatial, a.act);
+            }
+    }
+
+    // `bias` is nullptr if the convolution has no bias
+    static void run(const ConvArgs &a, int algo, const T *in, const T *wt,
+                    const T *bias, T *out) {
+        IT_ASSERT(isApplicable(a, algo));
+        if (algo == Algo::Auto)
+            algo = chooseAlgo(a);
+        if (algo == Algo::Im2colGemm)
+            im2colGemm(a, in, wt, bias, out);
+        else if (algo == Algo::DirectBlocked)
+            directBlocked(a, in, wt, bias, out);
+        else if (algo == Algo::Depthwise)
+            depthwise(a, in, wt, bias, out);
+        else
+            IT_TODO_HALT();
+    }
+
+    void compute(const Operator &_op, const PerfRecord &_record,
+                 const RuntimeObj *context) const override {
+        auto op = as<ConvObj>(_op);
+        auto record = as<ConvCpuPerfRecordObj>(_record);
+        run(getArgs(op), record ? record->algo : int(Algo::Auto),
+            op->getInputs(0)->getRawDataPtr<T *>(),
+            op->getInputs(1)->getRawDataPtr<T *>(), getBiasPtr(op),
+            op->getOutput()->getRawDataPtr<T *>());
+    }
+
+    void compute(const Operator &op, const RuntimeObj *context) const override {
+        compute(op, make_ref<ConvCpuPerfRecordObj>(), context);
+    }
+
+    PerfRecord tune(const Operator &_op,
+                    const RuntimeObj *context) const override {
+        auto op = as<ConvObj>(_op);
+        const auto args = getArgs(op);
+        const T *in = op->getInputs(0)->getRawDataPtr<T *>();
+        const T *wt = op->getInputs(1)->getRawDataPtr<T *>();
+        const T *bias = getBiasPtr(op);
+        T *out = op->getOutput()->getRawDataPtr<T *>();
+        ConvCpuPerfRecordObj ret;
+        ret.time = std::numeric_limits<double>::max();
+        for (int algo = Algo::Im2colGemm; algo < Algo::NumAlgo; ++algo) {
+            if (!isApplicable(args, algo))
+                continue;
+            double t = timeit([&]() { run(args, algo, in, wt, bias, out); },
+                              []() {}, 1, 3);
+            if (t < ret.time) {
+                ret.time = t;
+                ret.algo = algo;
             }
         }
+        return make_ref<ConvCpuPerfRecordObj>(ret);
     }
 };
 
-REGISTER_KERNEL(Device::CPU, OpType::Conv, DataType::UInt32,
-                NaiveConv<uint32_t>, "ConvNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Conv, DataType::Float32, NaiveConv<float>,
-                "ConvNaive_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Conv, DataType::UInt32, ConvCpu<uint32_t>,
+                "Conv_CPU_uint32");
+REGISTER_KERNEL(Device::CPU, OpType::Conv, DataType::Float32, ConvCpu<float>,
+                "Conv_CPU_float32");
 
+REGISTER_CONSTRUCTOR(3, ConvCpuPerfRecordObj::from_json);
 } // namespace infini
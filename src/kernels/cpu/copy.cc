@@ -0,0 +1,231 @@
+#include "cpu/cpu_copy.h"
+#include <algorithm>
+#include <cstring>
+
+namespace infini {
+
+namespace {
+
+// Below this many bytes the OpenMP fork costs more than it saves.
+constexpr size_t PARALLEL_BYTES = 1 << 16;
+// Contiguous copies are split into chunks of this many bytes.
+constexpr size_t CHUNK_BYTES = 1 << 16;
+// Edge of the tiles of a transpose that are distributed over threads, and of
+// the leaves that the recursion copies element by element.
+constexpr int64_t TASK_TILE = 256;
+constexpr int64_t LEAF_TILE = 16;
+// Both dims of a transpose have to be this long for tiling to pay off.
+constexpr int64_t MIN_TRANSPOSE = 4;
+
+// Dims that are iterated as rows, with the strides of both views.
+struct Rows {
+    vector<int64_t> dims, dst, src;
+
+    size_t count() const {
+        size_t ret = 1;
+        for (auto d : dims)
+            ret *= d;
+        return ret;
+    }
+    void offsets(size_t row, int64_t &dstOff, int64_t &srcOff) const {
+        dstOff = srcOff = 0;
+        for (int d = (int)dims.size() - 1; d >= 0; --d) {
+            const int64_t idx = row % dims[d];
+            row /= dims[d];
+            dstOff += idx * dst[d];
+            srcOff += idx * src[d];
+        }
+    }
+    void add(int64_t dim, int64_t dstStride, int64_t srcStride) {
+        dims.emplace_back(dim);
+        dst.emplace_back(dstStride);
+        src.emplace_back(srcStride);
+    }
+};
+
+// Drops unit dims and merges dims that are contiguous in both views.
+Rows simplify(const Shape &dims, const vector<int64_t> &dst,
+              const vector<int64_t> &src) {
+    Rows ret;
+    for (size_t d = 0; d < dims.size(); ++d) {
+        if (dims[d] == 1)
+            continue;
+        if (!ret.dims.empty() && ret.dst.back() == dst[d] * dims[d] &&
+            ret.src.back() == src[d] * dims[d]) {
+            ret.dims.back() *= dims[d];
+            ret.dst.back() = dst[d];
+            ret.src.back() = src[d];
+        } else {
+            ret.add(dims[d], dst[d], src[d]);
+        }
+    }
+    if (ret.dims.empty())
+        ret.add(1, 1, 1);
+    return ret;
+}
+
+// Recursively halves the longer side so that the leaves fit in L1 for any
+// cache size.
+template <typename E>
+void transposeTile(E *dst, const E *src, int64_t nb, int64_t na,
+                   int64_t dstB, int64_t dstA, int64_t srcB, int64_t srcA) {
+    if (nb <= LEAF_TILE && na <= LEAF_TILE) {
+        for (int64_t i = 0; i < nb; ++i)
+            for (int64_t j = 0; j < na; ++j)
+                dst[i * dstB + j * dstA] = src[i * srcB + j * srcA];
+    } else if (nb >= na) {
+        const int64_t h = nb / 2;
+        transposeTile(dst, src, h, na, dstB, dstA, srcB, srcA);
+        transposeTile(dst + h * dstB, src + h * srcB, nb - h, na, dstB, dstA,
+                      srcB, srcA);
+    } else {
+        const int64_t h = na / 2;
+        transposeTile(dst, src, nb, h, dstB, dstA, srcB, srcA);
+        transposeTile(dst + h * dstA, src + h * srcA, nb, na - h, dstB, dstA,
+                      srcB, srcA);
+    }
+}
+
+void copyContiguous(uint8_t *dst, const uint8_t *src, const Rows &rows,
+                    size_t rowBytes) {
+    const size_t nRows = rows.count();
+    if (nRows == 1) {
+        const size_t nChunks = (rowBytes + CHUNK_BYTES - 1) / CHUNK_BYTES;
+#pragma omp parallel for if (nChunks > 1)
+        for (size_t c = 0; c < nChunks; ++c) {
+            const size_t begin = c * CHUNK_BYTES;
+            std::memcpy(dst + begin, src + begin,
+                        std::min(CHUNK_BYTES, rowBytes - begin));
+        }
+        return;
+    }
+#pragma omp parallel for if (nRows * rowBytes > PARALLEL_BYTES)
+    for (size_t r = 0; r < nRows; ++r) {
+        int64_t dstOff, srcOff;
+        rows.offsets(r, dstOff, srcOff);
+        std::memcpy(dst + dstOff, src + srcOff, rowBytes);
+    }
+}
+
+template <typename E>
+void stridedCopy(const Rows &plan, E *dst, const E *src) {
+    const int rank = plan.dims.size();
+    const int64_t len = plan.dims.back(), dstStride = plan.dst.back(),
+                  srcStride = plan.src.back();
+    if (dstStride == 1 && srcStride == 1) {
+        Rows rows{{plan.dims.begin(), plan.dims.end() - 1},
+                  {plan.dst.begin(), plan.dst.end() - 1},
+                  {plan.src.begin(), plan.src.end() - 1}};
+        for (auto &s : rows.dst)
+            s *= sizeof(E);
+        for (auto &s : rows.src)
+            s *= sizeof(E);
+        copyContiguous(reinterpret_cast<uint8_t *>(dst),
+                       reinterpret_cast<const uint8_t *>(src), rows,
+                       len * sizeof(E));
+        return;
+    }
+
+    // A dim other than the innermost one with stride 1 in the view that is
+    // strided along the innermost dim makes a transpose
+    int b = -1;
+    for (int d = 0; d < rank - 1 && (dstStride == 1 || srcStride == 1); ++d)
+        if ((dstStride == 1 ? plan.src[d] : plan.dst[d]) == 1 &&
+            plan.dims[d] >= MIN_TRANSPOSE && len >= MIN_TRANSPOSE)
+            b = d;
+    const bool parallel = plan.count() * sizeof(E) > PARALLEL_BYTES;
+    if (b >= 0) {
+        Rows rows;
+        for (int d = 0; d < rank - 1; ++d)
+            if (d != b)
+                rows.add(plan.dims[d], plan.dst[d], plan.src[d]);
+        const int64_t nb = plan.dims[b], dstB = plan.dst[b],
+                      srcB = plan.src[b];
+        const int64_t tilesB = (nb + TASK_TILE - 1) / TASK_TILE,
+                      tilesA = (len + TASK_TILE - 1) / TASK_TILE;
+        const int64_t nTasks = rows.count() * tilesB * tilesA;
+#pragma omp parallel for if (parallel)
+        for (int64_t t = 0; t < nTasks; ++t) {
+            const int64_t i = t / tilesA % tilesB * TASK_TILE,
+                          j = t % tilesA * TASK_TILE;
+            int64_t dstOff, srcOff;
+            rows.offsets(t / (tilesA * tilesB), dstOff, srcOff);
+            transposeTile(dst + dstOff + i * dstB + j * dstStride,
+                          src + srcOff + i * srcB + j * srcStride,
+                          std::min(TASK_TILE, nb - i),
+                          std::min(TASK_TILE, len - j), dstB, dstStride,
+                          srcB, srcStride);
+        }
+        return;
+    }
+
+    Rows rows{{plan.dims.begin(), plan.dims.end() - 1},
+              {plan.dst.begin(), plan.dst.end() - 1},
+              {plan.src.begin(), plan.src.end() - 1}};
+    const size_t nRows = rows.count();
+#pragma omp parallel for if (parallel)
+    for (size_t r = 0; r < nRows; ++r) {
+        int64_t dstOff, srcOff;
+        rows.offsets(r, dstOff, srcOff);
+        E *d = dst + dstOff;
+        const E *s = src + srcOff;
+        if (srcStride == 0) {
+            const E value = *s;
+            for (int64_t i = 0; i < len; ++i)
+                d[i * dstStride] = value;
+        } else {
+            for (int64_t i = 0; i < len; ++i)
+                d[i * dstStride] = s[i * srcStride];
+        }
+    }
+}
+
+} // namespace
+
+void cpuStridedCopy(size_t elemSize, const Shape &dims, void *dst,
+                    const vector<int64_t> &dstStrides, const void *src,
+                    const vector<int64_t> &srcStrides) {
+    IT_ASSERT(dims.size() == dstStrides.size() &&
+              dims.size() == srcStrides.size());
+    for (auto d : dims)
+        if (d == 0)
+            return;
+    auto plan = simplify(dims, dstStrides, srcStrides);
+    switch (elemSize) {
+    case 1:
+        stridedCopy(plan, static_cast<uint8_t *>(dst),
+                    static_cast<const uint8_t *>(src));
+        break;
+    case 2:
+        stridedCopy(plan, static_cast<uint16_t *>(dst),
+                    static_cast<const uint16_t *>(src));
+        break;
+    case 4:
+        stridedCopy(plan, static_cast<uint32_t *>(dst),
+                    static_cast<const uint32_t *>(src));
+        break;
+    case 8:
+        stridedCopy(plan, static_cast<uint64_t *>(dst),
+                    static_cast<const uint64_t *>(src));
+        break;
+    default:
+        IT_TODO_HALT();
+    }
+}
+
+vector<int64_t> cpuContiguousStrides(const Shape &dims) {
+    vector<int64_t> ret(dims.size());
+    int64_t stride = 1;
+    for (int d = (int)dims.size() - 1; d >= 0; --d) {
+        ret[d] = stride;
+        stride *= dims[d];
+    }
+    return ret;
+}
+
+vector<int64_t> cpuStrides(const Tensor &tensor) {
+    auto stride = tensor->getStride();
+    return vector<int64_t>(stride.begin(), stride.end());
+}
+
+} // namespace infini
@@ -1,63 +1,262 @@
 #include "operators/element_wise.h"
 #include "core/kernel.h"
+#include "cpu/cpu_broadcast.h"
+#include "cpu/cpu_math.h"
+#include <cmath>
+#include <type_traits>
 
 namespace infini {
-template <typename T> class NativeElementWise : public CpuKernelWithoutConfig {
-    virtual T doCompute(T val0, T val1) const = 0;
+// The binary function is a template parameter rather than a virtual call so
+// that the loops over each run can be vectorized.
+template <typename T, typename Op>
+class NativeElementWise : public CpuKernelWithoutConfig {
+    bool supportsStridedInput(const Operator &op, int index) const override {
+        return true;
+    }
+
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
         auto op = as<ElementWiseObj>(_op);
-        T *inptr0 = op->getInputs(0)->getRawDataPtr<T *>();
-        T *inptr1 = op->getInputs(1)->getRawDataPtr<T *>();
+        auto input0 = op->getInputs(0), input1 = op->getInputs(1);
+        const T *inptr0 = input0->getRawDataPtr<T *>();
+        const T *inptr1 = input1->getRawDataPtr<T *>();
         T *outptr = op->getOutput()->getRawDataPtr<T *>();
 
-        int a[4] = {1, 1, 1, 1};
-        int b[4] = {1, 1, 1, 1};
-        int c[4] = {1, 1, 1, 1};
-        auto a_input = op->getInputs(0)->getDims();
-        auto b_input = op->getInputs(1)->getDims();
-        auto c_output = op->getOutput()->getDims();
-        std::copy(a_input.begin(), a_input.end(), a + (4 - a_input.size()));
-        std::copy(b_input.begin(), b_input.end(), b + (4 - b_input.size()));
-        std::copy(c_output.begin(), c_output.end(), c + (4 - c_output.size()));
-
-        auto n = op->getOutput()->size();
-        for (size_t i = 0; i < n; ++i) {
-            int c0_index = i / (c[1] * c[2] * c[3]);
-            int c1_index = (i % (c[1] * c[2] * c[3])) / (c[2] * c[3]);
-            int c2_index = ((i % (c[1] * c[2] * c[3])) % (c[2] * c[3])) / c[3];
-            int c3_index = ((i % (c[1] * c[2] * c[3])) % (c[2] * c[3])) % c[3];
-
-            int a0_index = c0_index % a[0];
-            int a1_index = c1_index % a[1];
-            int a2_index = c2_index % a[2];
-            int a3_index = c3_index % a[3];
+        BroadcastShape shape(op->getOutput()->getDims(),
+                             {input0->getDims(), input1->getDims()},
+                             {input0->getStride(), input1->getStride()});
+        const size_t stride0 = shape.getInnerStride(0),
+                     stride1 = shape.getInnerStride(1);
+        shape.forEachRun<2>([&](size_t o, const std::array<size_t, 2> &in,
+                                size_t len) {
+            const T *a = inptr0 + in[0], *b = inptr1 + in[1];
+            T *c = outptr + o;
+            Op f;
+            if (stride0 == 1 && stride1 == 1) {
+#pragma omp simd
+                for (size_t i = 0; i < len; ++i)
+                    c[i] = f(a[i], b[i]);
+            } else if (stride0 == 1 && stride1 == 0) {
+                const T val1 = *b;
+#pragma omp simd
+                for (size_t i = 0; i < len; ++i)
+                    c[i] = f(a[i], val1);
+            } else if (stride0 == 0 && stride1 == 1) {
+                const T val0 = *a;
+#pragma omp simd
+                for (size_t i = 0; i < len; ++i)
+                    c[i] = f(val0, b[i]);
+            } else if (stride0 == 0 && stride1 == 0) {
+                std::fill_n(c, len, f(*a, *b));
+            } else {
+                // strided views
+                for (size_t i = 0; i < len; ++i)
+                    c[i] = f(a[i * stride0], b[i * stride1]);
+            }
+        });
+    }
+};
 
-            int b0_index = c0_index % b[0];
-            int b1_index = c1_index % b[1];
-            int b2_index = c2_index % b[2];
-            int b3_index = c3_index % b[3];
-            outptr[i] = doCompute(
-                inptr0[a0_index * a[1] * a[2] * a[3] + a1_index * a[2] * a[3] +
-                       a2_index * a[3] + a3_index],
-                inptr1[b0_index * b[1] * b[2] * b[3] + b1_index * b[2] * b[3] +
-                       b2_index * b[3] + b3_index]);
-        }
+struct AddFunc {
+    template <typename T> T operator()(T a, T b) const { return a + b; }
+};
+struct SubFunc {
+    template <typename T> T operator()(T a, T b) const { return a - b; }
+};
+struct MulFunc {
+    template <typename T> T operator()(T a, T b) const { return a * b; }
+};
+struct DivFunc {
+    template <typename T> T operator()(T a, T b) const { return (T)(a / b); }
+};
+struct PowFunc {
+    template <typename T> T operator()(T a, T b) const {
+        return (T)std::pow(a, b);
     }
 };
+struct MinFunc {
+    template <typename T> T operator()(T a, T b) const {
+        return std::min(a, b);
+    }
+};
+struct MaxFunc {
+    template <typename T> T operator()(T a, T b) const {
+        return std::max(a, b);
+    }
+};
+// The output has the data type of the inputs, holding 1 for equal elements
+// and 0 otherwise.
+struct EqualFunc {
+    template <typename T> T operator()(T a, T b) const { return a == b; }
+};
 
-template <typename T> class NaiveAdd : public NativeElementWise<T> {
-    T doCompute(T val0, T val1) const override { return val0 + val1; }
+struct ReluFunc {
+    template <typename T> T operator()(T a) const { return std::max(T(0), a); }
 };
-template <typename T> class NaiveSub : public NativeElementWise<T> {
-    T doCompute(T val0, T val1) const override { return val0 - val1; }
+struct SigmoidFunc {
+    template <typename T> T operator()(T a) const {
+        if constexpr (std::is_same_v<T, float>)
+            return cpuSigmoid(a);
+        else
+            return 1 / (1 + std::exp(-a));
+    }
+};
+struct TanhFunc {
+    template <typename T> T operator()(T a) const {
+        if constexpr (std::is_same_v<T, float>)
+            return cpuTanh(a);
+        else
+            return std::tanh(a);
+    }
 };
-template <typename T> class NaiveMul : public NativeElementWise<T> {
-    T doCompute(T val0, T val1) const override { return val0 * val1; }
+struct AbsFunc {
+    template <typename T> T operator()(T a) const { return a < 0 ? -a : a; }
 };
-template <typename T> class NaiveDiv : public NativeElementWise<T> {
-    T doCompute(T val0, T val1) const override { return (T)(val0 / val1); }
+struct SqrtFunc {
+    template <typename T> T operator()(T a) const { return std::sqrt(a); }
 };
+struct NegFunc {
+    template <typename T> T operator()(T a) const { return -a; }
+};
+
+// Evaluates the program of a FusedElementWiseObj on tiles of consecutive
+// output elements, keeping the inputs and intermediate results of each tile in
+// a small buffer that stays in L1 cache.
+template <typename T>
+class FusedElementWiseCpu : public CpuKernelWithoutConfig {
+    using Instruction = FusedElementWiseObj::Instruction;
+    static constexpr size_t TILE = 256;
+
+    template <typename Op>
+    static void binary(const T *a, const T *b, T *c, size_t len) {
+        Op f;
+#pragma omp simd
+        for (size_t i = 0; i < len; ++i)
+            c[i] = f(a[i], b[i]);
+    }
+
+    template <typename Op> static void unary(const T *a, T *c, size_t len) {
+        Op f;
+#pragma omp simd
+        for (size_t i = 0; i < len; ++i)
+            c[i] = f(a[i]);
+    }
+
+    static void execute(const Instruction &inst, const T *a, const T *b, T *c,
+                        size_t len) {
+        switch (inst.type.underlying()) {
+        case OpType::Add:
+            return binary<AddFunc>(a, b, c, len);
+        case OpType::Sub:
+            return binary<SubFunc>(a, b, c, len);
+        case OpType::Mul:
+            return binary<MulFunc>(a, b, c, len);
+        case OpType::Div:
+            return binary<DivFunc>(a, b, c, len);
+        case OpType::Relu:
+            return unary<ReluFunc>(a, c, len);
+        case OpType::Sigmoid:
+            return unary<SigmoidFunc>(a, c, len);
+        case OpType::Tanh:
+            return unary<TanhFunc>(a, c, len);
+        case OpType::Abs:
+            return unary<AbsFunc>(a, c, len);
+        case OpType::Sqrt:
+            return unary<SqrtFunc>(a, c, len);
+        case OpType::Neg:
+            return unary<NegFunc>(a, c, len);
+        default:
+            IT_TODO_HALT();
+        }
+    }
+
+    template <size_t N>
+    static void run(const BroadcastShape &shape,
+                    const vector<const T *> &inputs,
+                    const vector<Instruction> &program, T *outptr) {
+        vector<size_t> strides(N);
+        for (size_t i = 0; i < N; ++i)
+            strides[i] = shape.getInnerStride(i);
+        shape.forEachRun<N>([&](size_t o, const std::array<size_t, N> &in,
+                                size_t len) {
+            // Inputs first, then the results of the instructions
+            vector<T> regs((N + program.size()) * TILE);
+            auto reg = [&](int operand) {
+                return regs.data() +
+                       (operand >= 0 ? operand : N + ~operand) * TILE;
+            };
+            for (size_t t = 0; t < len; t += TILE) {
+                const size_t n = std::min(TILE, len - t);
+                for (size_t i = 0; i < N; ++i) {
+                    const T *src = inputs[i] + in[i] + t * strides[i];
+                    if (strides[i] == 1)
+                        std::copy_n(src, n, reg(i));
+                    else if (strides[i] == 0)
+                        std::fill_n(reg(i), n, *src);
+                    else
+                        for (size_t e = 0; e < n; ++e)
+                            reg(i)[e] = src[e * strides[i]];
+                }
+                for (size_t j = 0; j < program.size(); ++j) {
+                    const auto &inst = program[j];
+                    // The last result goes to the output directly
+                    T *dst = j + 1 == program.size() ? outptr + o + t
+                                                     : reg(~(int)j);
+                    execute(inst, reg(inst.lhs), reg(inst.rhs), dst, n);
+                }
+            }
+        });
+    }
+
+    bool supportsStridedInput(const Operator &op, int index) const override {
+        return true;
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<FusedElementWiseObj>(_op);
+        vector<const T *> inputs;
+        vector<Shape> inputDims, inputStrides;
+        for (auto &input : op->getInputs()) {
+            inputs.emplace_back(input->getRawDataPtr<T *>());
+            inputDims.emplace_back(input->getDims());
+            inputStrides.emplace_back(input->getStride());
+        }
+        BroadcastShape shape(op->getOutput()->getDims(), inputDims,
+                             inputStrides);
+        const auto &program = op->getProgram();
+        T *outptr = op->getOutput()->getRawDataPtr<T *>();
+        switch (inputs.size()) {
+        case 1:
+            return run<1>(shape, inputs, program, outptr);
+        case 2:
+            return run<2>(shape, inputs, program, outptr);
+        case 3:
+            return run<3>(shape, inputs, program, outptr);
+        case 4:
+            return run<4>(shape, inputs, program, outptr);
+        case 5:
+            return run<5>(shape, inputs, program, outptr);
+        case 6:
+            return run<6>(shape, inputs, program, outptr);
+        case 7:
+            return run<7>(shape, inputs, program, outptr);
+        case 8:
+            return run<8>(shape, inputs, program, outptr);
+        default:
+            IT_TODO_HALT();
+        }
+    }
+};
+
+template <typename T> using NaiveAdd = NativeElementWise<T, AddFunc>;
+template <typename T> using NaiveSub = NativeElementWise<T, SubFunc>;
+template <typename T> using NaiveMul = NativeElementWise<T, MulFunc>;
+template <typename T> using NaiveDiv = NativeElementWise<T, DivFunc>;
+template <typename T> using NaivePow = NativeElementWise<T, PowFunc>;
+template <typename T> using NaiveMin = NativeElementWise<T, MinFunc>;
+template <typename T> using NaiveMax = NativeElementWise<T, MaxFunc>;
+template <typename T> using NaiveEqual = NativeElementWise<T, EqualFunc>;
 
 REGISTER_KERNEL(Device::CPU, OpType::Add, DataType::UInt32, NaiveAdd<uint32_t>,
                 "addNaive_CPU_uint32");
@@ -75,4 +274,22 @@ REGISTER_KERNEL(Device::CPU, OpType::Div, DataType::UInt32, NaiveDiv<uint32_t>,
                 "divNaive_CPU_uint32");
 REGISTER_KERNEL(Device::CPU, OpType::Div, DataType::Float32, NaiveDiv<float>,
                 "divNaive_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Pow, DataType::UInt32, NaivePow<uint32_t>,
+                "powNaive_CPU_uint32");
+REGISTER_KERNEL(Device::CPU, OpType::Pow, DataType::Float32, NaivePow<float>,
+                "powNaive_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Min, DataType::UInt32, NaiveMin<uint32_t>,
+                "minNaive_CPU_uint32");
+REGISTER_KERNEL(Device::CPU, OpType::Min, DataType::Float32, NaiveMin<float>,
+                "minNaive_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Max, DataType::UInt32, NaiveMax<uint32_t>,
+                "maxNaive_CPU_uint32");
+REGISTER_KERNEL(Device::CPU, OpType::Max, DataType::Float32, NaiveMax<float>,
+                "maxNaive_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Equal, DataType::UInt32,
+                NaiveEqual<uint32_t>, "equalNaive_CPU_uint32");
+REGISTER_KERNEL(Device::CPU, OpType::Equal, DataType::Float32,
+                NaiveEqual<float>, "equalNaive_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::FusedElementWise, DataType::Float32,
+                FusedElementWiseCpu<float>, "fusedElementWise_CPU_float32");
 }; // namespace infini
@@ -0,0 +1,40 @@
+#include "operators/expand.h"
+#include "core/kernel.h"
+#include "cpu/cpu_copy.h"
+
+namespace infini {
+
+// Copies the input with a stride of 0 along the broadcast dims
+class ExpandCpu : public CpuKernelWithoutConfig {
+    bool supportsStridedInput(const Operator &op, int index) const override {
+        return true;
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<ExpandObj>(_op);
+        auto input = op->getInputs(0), output = op->getOutput();
+        auto inDims = input->getDims(), outDims = output->getDims();
+        auto inStrides = cpuStrides(input);
+        const size_t skip = outDims.size() - inDims.size();
+        vector<int64_t> srcStrides(outDims.size(), 0);
+        for (size_t i = 0; i < inDims.size(); ++i)
+            if (inDims[i] != 1)
+                srcStrides[i + skip] = inStrides[i];
+        cpuStridedCopy(input->getDType().getSize(), outDims,
+                       output->getRawDataPtr<void *>(),
+                       cpuContiguousStrides(outDims),
+                       input->getRawDataPtr<void *>(), srcStrides);
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Expand, DataType::Float32, ExpandCpu,
+                "expand_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Expand, DataType::Float16, ExpandCpu,
+                "expand_CPU_float16");
+REGISTER_KERNEL(Device::CPU, OpType::Expand, DataType::Int32, ExpandCpu,
+                "expand_CPU_int32");
+REGISTER_KERNEL(Device::CPU, OpType::Expand, DataType::Int64, ExpandCpu,
+                "expand_CPU_int64");
+
+} // namespace infini
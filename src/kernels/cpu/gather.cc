@@ -0,0 +1,97 @@
+#include "operators/gather.h"
+#include "core/kernel.h"
+#include <cstring>
+
+namespace infini {
+
+namespace {
+
+// Below this many bytes the OpenMP fork costs more than it saves.
+constexpr size_t PARALLEL_BYTES = 1 << 16;
+
+// The input is viewed as [outer, axis, inner] and the output as
+// [outer, indices, inner]. Rows of inner elements are copied with memcpy,
+// which covers the embedding lookup along axis 0 with one row per index.
+template <typename E, typename I>
+void gather(const E *src, const I *indices, E *dst, size_t outer,
+            int64_t axisLen, size_t nIndices, size_t inner) {
+    // Checked before the parallel loop, which an exception must not leave
+    for (size_t i = 0; i < nIndices; ++i) {
+        int64_t idx = indices[i];
+        if (idx < 0)
+            idx += axisLen;
+        IT_ASSERT(idx >= 0 && idx < axisLen, "Gather index out of range");
+    }
+    const size_t rows = outer * nIndices;
+#pragma omp parallel for if (rows * inner * sizeof(E) > PARALLEL_BYTES)
+    for (size_t r = 0; r < rows; ++r) {
+        const size_t o = r / nIndices;
+        int64_t idx = indices[r % nIndices];
+        if (idx < 0)
+            idx += axisLen;
+        const E *row = src + (o * axisLen + idx) * inner;
+        if (inner == 1)
+            dst[r] = *row;
+        else
+            std::memcpy(dst + r * inner, row, inner * sizeof(E));
+    }
+}
+
+template <typename E>
+void gather(const E *src, const Tensor &indices, E *dst, size_t outer,
+            int64_t axisLen, size_t inner) {
+    if (indices->getDType() == DataType::Int32)
+        gather(src, indices->getRawDataPtr<int32_t *>(), dst, outer, axisLen,
+               indices->size(), inner);
+    else
+        gather(src, indices->getRawDataPtr<int64_t *>(), dst, outer, axisLen,
+               indices->size(), inner);
+}
+
+} // namespace
+
+class GatherCpu : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<GatherObj>(_op);
+        auto input = op->getInputs(0), indices = op->getInputs(1),
+             output = op->getOutput();
+        auto dims = input->getDims();
+        const int axis = op->getAxis();
+        size_t outer = 1, inner = 1;
+        for (int i = 0; i < axis; ++i)
+            outer *= dims[i];
+        for (size_t i = axis + 1; i < dims.size(); ++i)
+            inner *= dims[i];
+        const int64_t axisLen = dims[axis];
+        void *src = input->getRawDataPtr<void *>(),
+             *dst = output->getRawDataPtr<void *>();
+        switch (input->getDType().getSize()) {
+        case 2:
+            gather((uint16_t *)src, indices, (uint16_t *)dst, outer, axisLen,
+                   inner);
+            break;
+        case 4:
+            gather((uint32_t *)src, indices, (uint32_t *)dst, outer, axisLen,
+                   inner);
+            break;
+        case 8:
+            gather((uint64_t *)src, indices, (uint64_t *)dst, outer, axisLen,
+                   inner);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Gather, DataType::Float32, GatherCpu,
+                "gather_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Gather, DataType::Float16, GatherCpu,
+                "gather_CPU_float16");
+REGISTER_KERNEL(Device::CPU, OpType::Gather, DataType::Int32, GatherCpu,
+                "gather_CPU_int32");
+REGISTER_KERNEL(Device::CPU, OpType::Gather, DataType::Int64, GatherCpu,
+                "gather_CPU_int64");
+
+} // namespace infini
@@ -0,0 +1,273 @@
+#include "cpu/cpu_gemm.h"
+#include "core/common.h"
+#include "cpu/cpu_math.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace infini {
+
+namespace {
+
+// Cache blocking in elements. A KC x NR panel of B is reused from L1 by every
+// microkernel call of a column strip, and an MC x KC block of A stays in L2.
+// MC and NC must be multiples of every MR and NR below.
+constexpr int KC = 256;
+constexpr int MC = 96;
+constexpr int NC = 256;
+constexpr int MAX_MR = 12;
+constexpr int MAX_NR = 16;
+// Below this many multiply-adds the OpenMP fork costs more than it saves.
+constexpr double PARALLEL_WORKLOAD = 1 << 15;
+
+// Computes an MR x NR block of C from kc packed columns of A and rows of B.
+template <typename T>
+using MicroKernel = void (*)(int kc, const T *a, const T *b, T *c, int ldc,
+                             bool accumulate);
+
+template <typename T> struct MicroKernelInfo {
+    int mr, nr;
+    MicroKernel<T> fn;
+};
+
+template <typename T, int MR, int NR>
+void microKernelScalar(int kc, const T *a, const T *b, T *c, int ldc,
+                       bool accumulate) {
+    T acc[MR][NR] = {};
+    for (int p = 0; p < kc; ++p, a += MR, b += NR)
+        for (int i = 0; i < MR; ++i)
+            for (int j = 0; j < NR; ++j)
+                acc[i][j] += a[i] * b[j];
+    for (int i = 0; i < MR; ++i)
+        for (int j = 0; j < NR; ++j)
+            c[i * ldc + j] =
+                accumulate ? c[i * ldc + j] + acc[i][j] : acc[i][j];
+}
+
+#if defined(__x86_64__)
+// 6 x 16 block held in 12 ymm accumulators.
+__attribute__((target("avx2,fma"))) void
+microKernelAvx2(int kc, const float *a, const float *b, float *c, int ldc,
+                bool accumulate) {
+#define ZERO_ROW(i)                                                            \
+    __m256 c##i##0 = _mm256_setzero_ps(), c##i##1 = _mm256_setzero_ps();
+    ZERO_ROW(0) ZERO_ROW(1) ZERO_ROW(2) ZERO_ROW(3) ZERO_ROW(4) ZERO_ROW(5)
+#undef ZERO_ROW
+    for (int p = 0; p < kc; ++p, a += 6, b += 16) {
+        __m256 b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8), t;
+#define FMA_ROW(i)                                                             \
+    t = _mm256_broadcast_ss(a + i);                                            \
+    c##i##0 = _mm256_fmadd_ps(t, b0, c##i##0);                                 \
+    c##i##1 = _mm256_fmadd_ps(t, b1, c##i##1);
+        FMA_ROW(0) FMA_ROW(1) FMA_ROW(2) FMA_ROW(3) FMA_ROW(4) FMA_ROW(5)
+#undef FMA_ROW
+    }
+#define STORE_ROW(i)                                                           \
+    if (accumulate) {                                                          \
+        c##i##0 = _mm256_add_ps(c##i##0, _mm256_loadu_ps(c + i * ldc));        \
+        c##i##1 = _mm256_add_ps(c##i##1, _mm256_loadu_ps(c + i * ldc + 8));    \
+    }                                                                          \
+    _mm256_storeu_ps(c + i * ldc, c##i##0);                                    \
+    _mm256_storeu_ps(c + i * ldc + 8, c##i##1);
+    STORE_ROW(0) STORE_ROW(1) STORE_ROW(2) STORE_ROW(3) STORE_ROW(4)
+    STORE_ROW(5)
+#undef STORE_ROW
+}
+
+// 12 x 16 block held in 12 zmm accumulators.
+__attribute__((target("avx512f"))) void
+microKernelAvx512(int kc, const float *a, const float *b, float *c, int ldc,
+                  bool accumulate) {
+#define ZERO_ROW(i) __m512 c##i = _mm512_setzero_ps();
+    ZERO_ROW(0) ZERO_ROW(1) ZERO_ROW(2) ZERO_ROW(3) ZERO_ROW(4) ZERO_ROW(5)
+    ZERO_ROW(6) ZERO_ROW(7) ZERO_ROW(8) ZERO_ROW(9) ZERO_ROW(10) ZERO_ROW(11)
+#undef ZERO_ROW
+    for (int p = 0; p < kc; ++p, a += 12, b += 16) {
+        __m512 b0 = _mm512_loadu_ps(b);
+#define FMA_ROW(i) c##i = _mm512_fmadd_ps(_mm512_set1_ps(a[i]), b0, c##i);
+        FMA_ROW(0) FMA_ROW(1) FMA_ROW(2) FMA_ROW(3) FMA_ROW(4) FMA_ROW(5)
+        FMA_ROW(6) FMA_ROW(7) FMA_ROW(8) FMA_ROW(9) FMA_ROW(10) FMA_ROW(11)
+#undef FMA_ROW
+    }
+#define STORE_ROW(i)                                                           \
+    if (accumulate)                                                            \
+        c##i = _mm512_add_ps(c##i, _mm512_loadu_ps(c + i * ldc));              \
+    _mm512_storeu_ps(c + i * ldc, c##i);
+    STORE_ROW(0) STORE_ROW(1) STORE_ROW(2) STORE_ROW(3) STORE_ROW(4)
+    STORE_ROW(5) STORE_ROW(6) STORE_ROW(7) STORE_ROW(8) STORE_ROW(9)
+    STORE_ROW(10) STORE_ROW(11)
+#undef STORE_ROW
+}
+#endif
+
+const MicroKernelInfo<float> &floatMicroKernel() {
+    static const MicroKernelInfo<float> info =
+        []() -> MicroKernelInfo<float> {
+#if defined(__x86_64__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return {12, 16, microKernelAvx512};
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return {6, 16, microKernelAvx2};
+#endif
+        return {4, 16, microKernelScalar<float, 4, 16>};
+    }();
+    return info;
+}
+
+template <typename T> MicroKernelInfo<T> getMicroKernel() {
+    if constexpr (std::is_same_v<T, float>)
+        return floatMicroKernel();
+    else
+        return {4, 16, microKernelScalar<T, 4, 16>};
+}
+
+// Packs rows [i0, i0 + mr) x columns [p0, p0 + kc) of op(A) column by column.
+// Rows beyond m are zero-filled so that edge blocks can use the microkernel.
+template <typename T>
+void packA(bool transA, const T *A, int lda, int m, int i0, int p0, int kc,
+           int mr, T *dst) {
+    const int rows = std::min(mr, m - i0);
+    for (int p = 0; p < kc; ++p, dst += mr) {
+        for (int i = 0; i < rows; ++i)
+            dst[i] = transA ? A[(size_t)(p0 + p) * lda + i0 + i]
+                            : A[(size_t)(i0 + i) * lda + p0 + p];
+        for (int i = rows; i < mr; ++i)
+            dst[i] = T(0);
+    }
+}
+
+// Packs rows [p0, p0 + kc) x columns [j0, j0 + nr) of op(B) row by row.
+template <typename T>
+void packB(bool transB, const T *B, int ldb, int n, int j0, int p0, int kc,
+           int nr, T *dst) {
+    const int cols = std::min(nr, n - j0);
+    for (int p = 0; p < kc; ++p, dst += nr) {
+        if (!transB && cols == nr)
+            std::memcpy(dst, B + (size_t)(p0 + p) * ldb + j0, nr * sizeof(T));
+        else {
+            for (int j = 0; j < cols; ++j)
+                dst[j] = transB ? B[(size_t)(j0 + j) * ldb + p0 + p]
+                                : B[(size_t)(p0 + p) * ldb + j0 + j];
+            for (int j = cols; j < nr; ++j)
+                dst[j] = T(0);
+        }
+    }
+}
+
+} // namespace
+
+template <typename T> void cpuApplyAct(T *data, size_t size, ActType act) {
+    if (act == ActType::None)
+        return;
+    if (act == ActType::Relu) {
+        for (size_t i = 0; i < size; ++i)
+            data[i] = std::max(T(0), data[i]);
+        return;
+    }
+    if constexpr (std::is_same_v<T, float>) {
+        if (act == ActType::Sigmoid) {
+#pragma omp simd
+            for (size_t i = 0; i < size; ++i)
+                data[i] = cpuSigmoid(data[i]);
+            return;
+        }
+        if (act == ActType::Tanh) {
+#pragma omp simd
+            for (size_t i = 0; i < size; ++i)
+                data[i] = cpuTanh(data[i]);
+            return;
+        }
+    }
+    IT_TODO_HALT();
+}
+
+template <typename T>
+void cpuGemm(bool transA, bool transB, int m, int n, int k, const T *A,
+             int lda, const T *B, int ldb, T *C, int ldc, bool accumulate,
+             ActType act) {
+    if (m <= 0 || n <= 0)
+        return;
+    if (k <= 0) {
+        for (int i = 0; i < m; ++i) {
+            if (!accumulate)
+                std::fill_n(C + (size_t)i * ldc, n, T(0));
+            cpuApplyAct(C + (size_t)i * ldc, n, act);
+        }
+        return;
+    }
+    const auto kernel = getMicroKernel<T>();
+    const int mr = kernel.mr, nr = kernel.nr;
+    const int mStrips = (m + mr - 1) / mr, nStrips = (n + nr - 1) / nr;
+    const int mTiles = (m + MC - 1) / MC, nTiles = (n + NC - 1) / NC;
+    const int kcMax = std::min(k, KC);
+    vector<T> packedA((size_t)mStrips * mr * kcMax);
+    vector<T> packedB((size_t)nStrips * nr * kcMax);
+    const bool parallel = (double)m * n * k > PARALLEL_WORKLOAD;
+
+    for (int p0 = 0; p0 < k; p0 += KC) {
+        const int kc = std::min(KC, k - p0);
+        const bool acc = accumulate || p0 > 0;
+        const bool lastPanel = p0 + kc == k;
+#pragma omp parallel if (parallel)
+        {
+#pragma omp for schedule(static)
+            for (int s = 0; s < mStrips; ++s)
+                packA(transA, A, lda, m, s * mr, p0, kc, mr,
+                      packedA.data() + (size_t)s * mr * kc);
+#pragma omp for schedule(static)
+            for (int s = 0; s < nStrips; ++s)
+                packB(transB, B, ldb, n, s * nr, p0, kc, nr,
+                      packedB.data() + (size_t)s * nr * kc);
+#pragma omp for collapse(2) schedule(static)
+            for (int ti = 0; ti < mTiles; ++ti)
+                for (int tj = 0; tj < nTiles; ++tj) {
+                    const int i0 = ti * MC, iEnd = std::min(m, i0 + MC);
+                    const int j0 = tj * NC, jEnd = std::min(n, j0 + NC);
+                    T edge[MAX_MR * MAX_NR];
+                    for (int j = j0; j < jEnd; j += nr) {
+                        const T *b =
+                            packedB.data() + (size_t)(j / nr) * nr * kc;
+                        const int nb = std::min(nr, n - j);
+                        for (int i = i0; i < iEnd; i += mr) {
+                            const T *a =
+                                packedA.data() + (size_t)(i / mr) * mr * kc;
+                            const int mb = std::min(mr, m - i);
+                            T *c = C + (size_t)i * ldc + j;
+                            if (mb == mr && nb == nr) {
+                                kernel.fn(kc, a, b, c, ldc, acc);
+                                continue;
+                            }
+                            kernel.fn(kc, a, b, edge, nr, false);
+                            for (int ii = 0; ii < mb; ++ii)
+                                for (int jj = 0; jj < nb; ++jj) {
+                                    T v = edge[ii * nr + jj];
+                                    c[ii * ldc + jj] =
+                                        acc ? c[ii * ldc + jj] + v : v;
+                                }
+                        }
+                    }
+                    // Fused epilogue while the tile is still in cache
+                    if (lastPanel && act != ActType::None)
+                        for (int i = i0; i < iEnd; ++i)
+                            cpuApplyAct(C + (size_t)i * ldc + j0, jEnd - j0,
+                                        act);
+                }
+        }
+    }
+}
+
+template void cpuApplyAct<float>(float *, size_t, ActType);
+template void cpuApplyAct<uint32_t>(uint32_t *, size_t, ActType);
+template void cpuGemm<float>(bool, bool, int, int, int, const float *, int,
+                             const float *, int, float *, int, bool, ActType);
+template void cpuGemm<uint32_t>(bool, bool, int, int, int, const uint32_t *,
+                                int, const uint32_t *, int, uint32_t *, int,
+                                bool, ActType);
+
+} // namespace infini
@@ -0,0 +1,141 @@
+#include "operators/layer_norm.h"
+#include "core/kernel.h"
+#include <cmath>
+#include <vector>
+
+namespace infini {
+
+namespace {
+
+// Independent Welford accumulators per row, which the compiler keeps in
+// vector registers.
+constexpr size_t LANES = 16;
+// Below this many elements the OpenMP fork costs more than it saves.
+constexpr size_t PARALLEL_WORKLOAD = 1 << 15;
+
+// Mean and variance of `n` contiguous elements in a single pass. Every lane
+// runs Welford's update over a strided subsequence, and the lanes are merged
+// with Chan's formula, so that large offsets do not cancel as in
+// E[x^2] - E[x]^2.
+std::pair<float, float> welford(const float *x, size_t n) {
+    float mean[LANES] = {}, m2[LANES] = {};
+    const size_t blocks = n / LANES;
+    for (size_t b = 0; b < blocks; ++b) {
+        const float *src = x + b * LANES;
+        const float inv = 1.f / float(b + 1);
+#pragma omp simd
+        for (size_t j = 0; j < LANES; ++j) {
+            const float delta = src[j] - mean[j];
+            mean[j] += delta * inv;
+            m2[j] += delta * (src[j] - mean[j]);
+        }
+    }
+    // Merge the lanes, which all hold `blocks` elements
+    float count = 0, totalMean = 0, totalM2 = 0;
+    if (blocks > 0) {
+        count = blocks;
+        totalMean = mean[0];
+        totalM2 = m2[0];
+        for (size_t j = 1; j < LANES; ++j) {
+            const float delta = mean[j] - totalMean, merged = count + blocks;
+            totalMean += delta * (blocks / merged);
+            totalM2 += m2[j] + delta * delta * (count * blocks / merged);
+            count = merged;
+        }
+    }
+    for (size_t i = blocks * LANES; i < n; ++i) {
+        count += 1;
+        const float delta = x[i] - totalMean;
+        totalMean += delta / count;
+        totalM2 += delta * (x[i] - totalMean);
+    }
+    return {totalMean, totalM2 / float(n)};
+}
+
+// The scale or the bias expanded to `n` elements, if it has a single one
+const float *expandParam(const Tensor &param, size_t n,
+                         std::vector<float> &buffer) {
+    const float *data = param->getRawDataPtr<float *>();
+    if (param->size() == n)
+        return data;
+    buffer.assign(n, data[0]);
+    return buffer.data();
+}
+
+} // namespace
+
+/**
+ * @brief LayerNorm over the trailing axes. Every row is read once for its
+ * mean and variance with a lane-parallel Welford pass and once to write the
+ * output, and rows are distributed over OpenMP threads.
+ */
+class LayerNormCpu : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<LayerNormBaseObj>(_op);
+        const float *x = op->getInputs(0)->getRawDataPtr<float *>();
+        float *y = op->getOutput()->getRawDataPtr<float *>();
+        const size_t n = op->getNormalizedSize(),
+                     rows = op->getInputs(0)->size() / n;
+        std::vector<float> scaleBuffer, biasBuffer;
+        const float *scale = expandParam(op->getScale(), n, scaleBuffer);
+        const float *bias =
+            op->getBias() ? expandParam(op->getBias(), n, biasBuffer) : nullptr;
+        const float eps = op->getEps();
+
+#pragma omp parallel for if (rows * n > PARALLEL_WORKLOAD) schedule(static)
+        for (size_t r = 0; r < rows; ++r) {
+            const float *src = x + r * n;
+            float *dst = y + r * n;
+            const auto [mean, var] = welford(src, n);
+            const float rstd = 1.f / std::sqrt(var + eps);
+            if (bias) {
+#pragma omp simd
+                for (size_t i = 0; i < n; ++i)
+                    dst[i] = (src[i] - mean) * rstd * scale[i] + bias[i];
+            } else {
+#pragma omp simd
+                for (size_t i = 0; i < n; ++i)
+                    dst[i] = (src[i] - mean) * rstd * scale[i];
+            }
+        }
+    }
+};
+
+/**
+ * @brief RMSNorm over the trailing axes, with one pass for the sum of squares
+ * and one to write the output of every row.
+ */
+class RMSNormCpu : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<LayerNormBaseObj>(_op);
+        const float *x = op->getInputs(0)->getRawDataPtr<float *>();
+        float *y = op->getOutput()->getRawDataPtr<float *>();
+        const size_t n = op->getNormalizedSize(),
+                     rows = op->getInputs(0)->size() / n;
+        std::vector<float> scaleBuffer;
+        const float *scale = expandParam(op->getScale(), n, scaleBuffer);
+        const float eps = op->getEps();
+
+#pragma omp parallel for if (rows * n > PARALLEL_WORKLOAD) schedule(static)
+        for (size_t r = 0; r < rows; ++r) {
+            const float *src = x + r * n;
+            float *dst = y + r * n;
+            float sum = 0;
+#pragma omp simd reduction(+ : sum)
+            for (size_t i = 0; i < n; ++i)
+                sum += src[i] * src[i];
+            const float rms = 1.f / std::sqrt(sum / float(n) + eps);
+#pragma omp simd
+            for (size_t i = 0; i < n; ++i)
+                dst[i] = src[i] * rms * scale[i];
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::LayerNormalization, DataType::Float32,
+                LayerNormCpu, "layerNorm_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::RMSNorm, DataType::Float32, RMSNormCpu,
+                "rmsNorm_CPU_float32");
+} // namespace infini
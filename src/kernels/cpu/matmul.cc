@@ -1,33 +1,228 @@
 #include "operators/matmul.h"
 #include "core/kernel.h"
+#include "cpu/cpu_gemm.h"
+#include <optional>
 
 namespace infini {
 
-template <typename T> class NaiveMatmul : public CpuKernelWithoutConfig {
+// Element offset of every output matrix in an operand with `strides`, whose
+// leading (batch) dimensions are broadcast to `batchShape`. Broadcast
+// dimensions get stride 0.
+static vector<size_t> getBatchOffsets(const Shape &dims, const Shape &strides,
+                                      const Shape &batchShape) {
+    const int rank = batchShape.size();
+    const int offset = rank - (int(dims.size()) - 2);
+    vector<size_t> batchStrides(rank, 0);
+    for (int i = rank - 1; i >= offset; --i)
+        if (dims[i - offset] != 1)
+            batchStrides[i] = strides[i - offset];
+    size_t batch = 1;
+    for (auto d : batchShape)
+        batch *= d;
+    vector<size_t> ret(batch, 0);
+    for (size_t b = 0; b < batch; ++b) {
+        size_t rest = b;
+        for (int i = rank - 1; i >= 0; --i) {
+            ret[b] += rest % batchShape[i] * batchStrides[i];
+            rest /= batchShape[i];
+        }
+    }
+    return ret;
+}
+
+// How cpuGemm reads the matrices in the two innermost dimensions of an
+// operand, which may be a strided view: whether they are stored transposed
+// and their leading dimension. nullopt if neither dimension is contiguous.
+static std::optional<std::pair<bool, int>>
+getMatrixLayout(const Tensor &tensor) {
+    const auto dims = tensor->getDims(), strides = tensor->getStride();
+    const int rank = dims.size();
+    const int rows = dims[rank - 2], cols = dims[rank - 1];
+    const int rowStride = strides[rank - 2], colStride = strides[rank - 1];
+    if ((cols == 1 || colStride == 1) && (rows == 1 || rowStride >= cols))
+        return std::make_pair(false, rows == 1 ? cols : rowStride);
+    if ((rows == 1 || rowStride == 1) && (cols == 1 || colStride >= rows))
+        return std::make_pair(true, cols == 1 ? rows : colStride);
+    return std::nullopt;
+}
+
+// Fills `dst` of shape `dstDims` with `src` broadcast from `srcDims`.
+template <typename T>
+static void broadcastFill(T *dst, const Shape &dstDims, const T *src,
+                          const Shape &srcDims) {
+    const int rank = dstDims.size();
+    const int offset = rank - srcDims.size();
+    vector<size_t> strides(rank, 0);
+    size_t stride = 1;
+    for (int i = rank - 1; i >= offset; --i) {
+        if (srcDims[i - offset] != 1)
+            strides[i] = stride;
+        stride *= srcDims[i - offset];
+    }
+    const size_t inner = dstDims[rank - 1];
+    size_t rows = 1;
+    for (int i = 0; i < rank - 1; ++i)
+        rows *= dstDims[i];
+#pragma omp parallel for if (rows * inner > (1 << 16))
+    for (size_t r = 0; r < rows; ++r) {
+        size_t rest = r, srcOffset = 0;
+        for (int i = rank - 2; i >= 0; --i) {
+            srcOffset += rest % dstDims[i] * strides[i];
+            rest /= dstDims[i];
+        }
+        T *out = dst + r * inner;
+        const T *in = src + srcOffset;
+        if (strides[rank - 1] == 0)
+            std::fill_n(out, inner, *in);
+        else
+            std::copy_n(in, inner, out);
+    }
+}
+
+// The operands of a MatMul as the kernels below read them. The bias, if any,
+// is already broadcast into C.
+template <typename T> struct MatmulOperands {
+    int b, m, n, k;
+    bool transA, transB;
+    int lda, ldb;
+    const T *A, *B;
+    T *C;
+    // Element offsets of the matrices of every batch in A and B
+    vector<size_t> offsetsA, offsetsB;
+    bool hasBias;
+    ActType act;
+};
+
+template <typename T>
+static MatmulOperands<T> getOperands(const Ref<MatmulObj> &op) {
+    MatmulOperands<T> x;
+    std::tie(x.b, x.m, x.n, x.k, x.transA, x.transB) = op->getBMNKTransAB();
+    x.act = op->getAct();
+    auto inputA = op->getInputs(0), inputB = op->getInputs(1);
+    auto output = op->getOutput();
+    x.A = inputA->getRawDataPtr<T *>();
+    x.B = inputB->getRawDataPtr<T *>();
+    x.C = output->getRawDataPtr<T *>();
+
+    const auto outDims = output->getDims();
+    const Shape batchShape(outDims.begin(), outDims.end() - 2);
+    x.offsetsA =
+        getBatchOffsets(inputA->getDims(), inputA->getStride(), batchShape);
+    x.offsetsB =
+        getBatchOffsets(inputB->getDims(), inputB->getStride(), batchShape);
+    IT_ASSERT(x.offsetsA.size() == (size_t)x.b &&
+              x.offsetsB.size() == (size_t)x.b);
+    // A matrix stored column-major is the transpose stored row-major
+    const auto layoutA = getMatrixLayout(inputA),
+               layoutB = getMatrixLayout(inputB);
+    IT_ASSERT(layoutA && layoutB);
+    x.transA ^= layoutA->first;
+    x.transB ^= layoutB->first;
+    x.lda = layoutA->second, x.ldb = layoutB->second;
+
+    // The bias is broadcast into C and accumulated onto by the kernels
+    auto bias = op->getBias();
+    x.hasBias = bias != nullptr;
+    if (bias)
+        broadcastFill(x.C, outDims, bias->getRawDataPtr<T *>(),
+                      bias->getDims());
+    return x;
+}
+
+template <typename T> class MatmulCpu : public CpuKernelWithoutConfig {
+    // Batches of matrices smaller than this (in multiply-adds) are spread
+    // across threads instead of splitting every matrix into tiles.
+    static constexpr size_t SMALL_MATMUL = 1 << 18;
+
+    // A and B are read with their leading dimensions, the bias is not
+    bool supportsStridedInput(const Operator &op, int index) const override {
+        return index < 2 && getMatrixLayout(op->getInputs(index));
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        const auto x = getOperands<T>(as<MatmulObj>(_op));
+#pragma omp parallel for schedule(static)                                      \
+    if (x.b > 1 && (size_t)x.m * x.n * x.k < SMALL_MATMUL)
+        for (int i = 0; i < x.b; ++i)
+            cpuGemm<T>(x.transA, x.transB, x.m, x.n, x.k, x.A + x.offsetsA[i],
+                       x.lda, x.B + x.offsetsB[i], x.ldb,
+                       x.C + (size_t)i * x.m * x.n, x.n, x.hasBias, x.act);
+    }
+};
+
+// Vector-matrix products (m = 1), e.g. of decoding one token at a time, for
+// which packing the whole of B as cpuGemm does rarely pays off. It has a
+// lower priority than MatmulCpu, so it only runs where tuning finds it
+// faster.
+template <typename T> class MatmulGemvCpu : public CpuKernelWithoutConfig {
+    // Columns of C accumulated together when B is not transposed
+    static constexpr int NB = 256;
+    // Products smaller than this (in multiply-adds) run on one thread
+    static constexpr size_t SMALL_GEMV = 1 << 15;
+
+    bool isApplicable(const Operator &op) const override {
+        return as<MatmulObj>(op)->getM() == 1;
+    }
+
+    bool supportsStridedInput(const Operator &op, int index) const override {
+        return index < 2 && getMatrixLayout(op->getInputs(index));
+    }
+
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
-        auto op = as<MatmulObj>(_op);
-        IT_ASSERT(op->getInputs().size() == 2, "Bias is not supported yet.");
-        T *A = op->getInputs(0)->getRawDataPtr<T *>();
-        T *B = op->getInputs(1)->getRawDataPtr<T *>();
-        T *C = op->getOutput()->getRawDataPtr<T *>();
-        IT_ASSERT(op->getTransA() == false && op->getTransB() == false);
-        IT_ASSERT(op->getAct() == ActType::None);
-        const int M = op->getM(), N = op->getN(), K = op->getK();
-        for (int i = 0; i < M; i++) {
-            for (int j = 0; j < N; j++) {
-                C[i * N + j] = 0;
-                for (int k = 0; k < K; k++) {
-                    C[i * N + j] += A[i * K + k] * B[k * N + j];
+        const auto x = getOperands<T>(as<MatmulObj>(_op));
+        // The row vector A is read with this stride
+        const int strideA = x.transA ? x.lda : 1;
+        const bool parallel = (size_t)x.b * x.n * x.k >= SMALL_GEMV;
+        if (x.transB) {
+            // Every element of C is the dot product of A and a row of B
+#pragma omp parallel for collapse(2) schedule(static) if (parallel)
+            for (int i = 0; i < x.b; ++i)
+                for (int j = 0; j < x.n; ++j) {
+                    const T *a = x.A + x.offsetsA[i];
+                    const T *row = x.B + x.offsetsB[i] + (size_t)j * x.ldb;
+                    T sum = 0;
+#pragma omp simd reduction(+ : sum)
+                    for (int p = 0; p < x.k; ++p)
+                        sum += a[(size_t)p * strideA] * row[p];
+                    T &c = x.C[(size_t)i * x.n + j];
+                    c = x.hasBias ? c + sum : sum;
                 }
-            }
+            cpuApplyAct(x.C, (size_t)x.b * x.n, x.act);
+            return;
         }
+        // Every block of C is a sum of the rows of B scaled by A
+        const int numBlocks = (x.n + NB - 1) / NB;
+#pragma omp parallel for collapse(2) schedule(static) if (parallel)
+        for (int i = 0; i < x.b; ++i)
+            for (int block = 0; block < numBlocks; ++block) {
+                const int j0 = block * NB, width = std::min(NB, x.n - j0);
+                const T *a = x.A + x.offsetsA[i];
+                const T *B = x.B + x.offsetsB[i] + j0;
+                T *c = x.C + (size_t)i * x.n + j0;
+                T acc[NB];
+                for (int j = 0; j < width; ++j)
+                    acc[j] = x.hasBias ? c[j] : 0;
+                for (int p = 0; p < x.k; ++p) {
+                    const T ap = a[(size_t)p * strideA];
+                    const T *row = B + (size_t)p * x.ldb;
+#pragma omp simd
+                    for (int j = 0; j < width; ++j)
+                        acc[j] += ap * row[j];
+                }
+                std::copy_n(acc, width, c);
+                cpuApplyAct(c, width, x.act);
+            }
     }
 };
 
 REGISTER_KERNEL(Device::CPU, OpType::MatMul, DataType::UInt32,
-                NaiveMatmul<uint32_t>, "MatmulNaive_CPU_uint32");
+                MatmulCpu<uint32_t>, "Matmul_CPU_uint32");
 REGISTER_KERNEL(Device::CPU, OpType::MatMul, DataType::Float32,
-                NaiveMatmul<float>, "MatmulNaive_CPU_float32");
+                MatmulCpu<float>, "Matmul_CPU_float32");
+REGISTER_KERNEL_WITH_PRIORITY(Device::CPU, OpType::MatMul, DataType::Float32,
+                              MatmulGemvCpu<float>, "MatmulGemv_CPU_float32",
+                              -1);
 
 } // namespace infini
@@ -0,0 +1,42 @@
+#include "operators/pad.h"
+#include "core/kernel.h"
+#include "cpu/cpu_copy.h"
+#include <cstring>
+
+namespace infini {
+
+// Zero-fills the output and copies the input into the region after the
+// leading pads
+class PadCpu : public CpuKernelWithoutConfig {
+    bool supportsStridedInput(const Operator &op, int index) const override {
+        return true;
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<PadObj>(_op);
+        auto input = op->getInputs(0), output = op->getOutput();
+        auto pads = op->getPads();
+        auto dstStrides = cpuContiguousStrides(output->getDims());
+        int64_t offset = 0;
+        for (size_t i = 0; i < dstStrides.size(); ++i)
+            offset += pads[i] * dstStrides[i];
+        const size_t elemSize = input->getDType().getSize();
+        auto dst = output->getRawDataPtr<uint8_t *>();
+        std::memset(dst, 0, output->getBytes());
+        cpuStridedCopy(elemSize, input->getDims(), dst + offset * elemSize,
+                       dstStrides, input->getRawDataPtr<void *>(),
+                       cpuStrides(input));
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Pad, DataType::Float32, PadCpu,
+                "pad_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Pad, DataType::Float16, PadCpu,
+                "pad_CPU_float16");
+REGISTER_KERNEL(Device::CPU, OpType::Pad, DataType::Int32, PadCpu,
+                "pad_CPU_int32");
+REGISTER_KERNEL(Device::CPU, OpType::Pad, DataType::Int64, PadCpu,
+                "pad_CPU_int64");
+
+} // namespace infini
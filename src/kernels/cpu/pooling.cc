@@ -1,82 +1,200 @@
 #include "operators/pooling.h"
 #include "core/kernel.h"
+#include "utils/data_convert.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
 
 namespace infini {
-template <typename T> class NativePooling : public CpuKernelWithoutConfig {
-    virtual T getPoolingValue(int kh, int kw, int posh, int posw, int ih,
-                              int iw, T *inptr) const = 0;
+
+namespace {
+
+// Below this many input elements the OpenMP fork costs more than it saves.
+constexpr size_t PARALLEL_WORKLOAD = 1 << 15;
+
+// Values are pooled in Acc. Float16 tensors hold raw uint16_t bits and are
+// pooled in float.
+template <typename T> struct PoolType {
+    using Acc = T;
+    static Acc load(T x) { return x; }
+    static T store(Acc x) { return x; }
+};
+template <> struct PoolType<uint16_t> {
+    using Acc = float;
+    static Acc load(uint16_t x) { return fp16_to_float(x); }
+    static uint16_t store(Acc x) { return float_to_fp16(x); }
+};
+
+// The identity of the reduction, which also stands for padded elements
+template <typename A, bool IsMax> constexpr A poolInit() {
+    if constexpr (!IsMax)
+        return A(0);
+    else if constexpr (std::numeric_limits<A>::has_infinity)
+        return -std::numeric_limits<A>::infinity();
+    else
+        return std::numeric_limits<A>::lowest();
+}
+
+template <bool IsMax, typename A> inline A poolReduce(A a, A b) {
+    if constexpr (IsMax)
+        return a > b ? a : b;
+    else
+        return a + b;
+}
+
+// Number of taps start + k * dilation, k < kernel, inside [-pad, len + pad).
+// Average pooling divides by it, so padding counts but the overhang of the
+// last window in ceil mode does not.
+int countTaps(int start, int kernel, int dilation, int pad, int len) {
+    int count = 0;
+    for (int k = 0; k < kernel; ++k) {
+        const int pos = start + k * dilation;
+        count += pos >= -pad && pos < len + pad;
+    }
+    return count;
+}
+
+// Pools every plane of `size` contiguous elements into one value.
+template <typename T, bool IsMax>
+void globalPool(const T *in, T *out, size_t planes, size_t size) {
+    using P = PoolType<T>;
+    using A = typename P::Acc;
+#pragma omp parallel for if (planes * size > PARALLEL_WORKLOAD)
+    for (size_t p = 0; p < planes; ++p) {
+        const T *src = in + p * size;
+        A acc = poolInit<A, IsMax>();
+        if constexpr (IsMax) {
+#pragma omp simd reduction(max : acc)
+            for (size_t i = 0; i < size; ++i)
+                acc = std::max(acc, P::load(src[i]));
+        } else {
+#pragma omp simd reduction(+ : acc)
+            for (size_t i = 0; i < size; ++i)
+                acc += P::load(src[i]);
+            acc /= A(size);
+        }
+        out[p] = P::store(acc);
+    }
+}
+
+struct PoolParams {
+    int ih, iw, oh, ow, kh, kw, ph, pw, sh, sw, dh, dw;
+};
+
+// Pools (N * C) planes as two separable passes per output row. The kh input
+// rows of the window are first reduced column-wise into a row buffer that
+// holds pw identity elements on the left and enough on the right for the
+// last window, so that the kw taps of every output are then reduced without
+// bound checks.
+template <typename T, bool IsMax>
+void pool(const T *in, T *out, size_t planes, const PoolParams &s) {
+    using P = PoolType<T>;
+    using A = typename P::Acc;
+    const A init = poolInit<A, IsMax>();
+    const size_t width = std::max(s.iw + 2 * s.pw,
+                                  (s.ow - 1) * s.sw + (s.kw - 1) * s.dw + 1);
+    // Average pooling scales by the reciprocal tap count per column
+    std::vector<A> colScale(s.ow);
+    if constexpr (!IsMax)
+        for (int x = 0; x < s.ow; ++x) {
+            const int n = countTaps(x * s.sw - s.pw, s.kw, s.dw, s.pw, s.iw);
+            colScale[x] = n ? A(1) / n : A(0);
+        }
+    const size_t inPlane = size_t(s.ih) * s.iw,
+                 outPlane = size_t(s.oh) * s.ow;
+#pragma omp parallel if (planes * inPlane > PARALLEL_WORKLOAD)
+    {
+        std::vector<A> buffer(width, init);
+        A *row = buffer.data() + s.pw;
+#pragma omp for collapse(2) schedule(static)
+        for (size_t p = 0; p < planes; ++p)
+            for (int y = 0; y < s.oh; ++y) {
+                const T *src = in + p * inPlane;
+                const int top = y * s.sh - s.ph;
+                bool first = true;
+                for (int k = 0; k < s.kh; ++k) {
+                    const int r = top + k * s.dh;
+                    if (r < 0 || r >= s.ih)
+                        continue;
+                    const T *line = src + size_t(r) * s.iw;
+                    if (first) {
+#pragma omp simd
+                        for (int x = 0; x < s.iw; ++x)
+                            row[x] = P::load(line[x]);
+                        first = false;
+                    } else {
+#pragma omp simd
+                        for (int x = 0; x < s.iw; ++x)
+                            row[x] =
+                                poolReduce<IsMax>(row[x], P::load(line[x]));
+                    }
+                }
+                if (first)
+                    std::fill(row, row + s.iw, init);
+
+                [[maybe_unused]] A rowScale = A(1);
+                if constexpr (!IsMax)
+                    rowScale /= std::max(
+                        1, countTaps(top, s.kh, s.dh, s.ph, s.ih));
+                T *dst = out + p * outPlane + size_t(y) * s.ow;
+                const A *base = buffer.data();
+#pragma omp simd
+                for (int x = 0; x < s.ow; ++x) {
+                    const A *taps = base + size_t(x) * s.sw;
+                    A acc = taps[0];
+                    for (int l = 1; l < s.kw; ++l)
+                        acc = poolReduce<IsMax>(acc, taps[l * s.dw]);
+                    if constexpr (!IsMax)
+                        acc *= rowScale * colScale[x];
+                    dst[x] = P::store(acc);
+                }
+            }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Max and average pooling over NCHW tensors with padding, stride,
+ * dilation and ceil mode. Padded elements never win the max and are counted
+ * by the average, as in the cuDNN, oneDNN and CNNL kernels. A window that
+ * covers the whole plane, e.g. GlobalAveragePool from ONNX, is reduced in a
+ * single pass per plane.
+ */
+template <typename T, bool IsMax>
+class PoolingCpu : public CpuKernelWithoutConfig {
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
         auto op = as<PoolingObj>(_op);
-        T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
+        const T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
         T *outptr = op->getOutput()->getRawDataPtr<T *>();
         const auto [n, c, ih, iw, kh, kw] = op->getNCHWRS();
         const auto [ph, pw, sh, sw, dh, dw] = op->getPadStrideDilation();
-        if (dh != 1 || dw != 1)
-            IT_TODO_HALT(); // To support dailated pooling
         auto outDim = op->getOutput()->getDims();
-        int oh = outDim[2], ow = outDim[3];
-        for (auto i = 0; i < n; i++) {
-            for (auto j = 0; j < c; j++) {
-                auto inoffset = i * (c * ih * iw) + j * ih * iw;
-                for (auto h = 0; h < oh; h++) {
-                    for (auto w = 0; w < ow; w++) {
-                        // TODO: verify ceil mode
-                        T val =
-                            getPoolingValue(kh, kw, h * sh - ph, w * sw - pw,
-                                            ih, iw, inptr + inoffset);
-                        auto outoffset =
-                            w + h * ow + j * (oh * ow) + i * (c * oh * ow);
-                        outptr[outoffset] = val;
-                    }
-                }
-            }
-        }
-    }
-};
+        const int oh = outDim[2], ow = outDim[3];
+        const size_t planes = size_t(n) * c;
 
-template <typename T> class NaiveMaxPool : public NativePooling<T> {
-    T getPoolingValue(int kh, int kw, int posh, int posw, int ih, int iw,
-                      T *inptr) const override {
-        T maxval = 0;
-        for (auto k = 0; k < kh; k++) {
-            for (auto l = 0; l < kw; l++) {
-                auto inPosH = posh + k;
-                auto inPosW = posw + l;
-                if (inPosH < 0 || inPosH >= ih || inPosW < 0 || inPosW >= iw)
-                    continue;
-                auto offset = (posh + k) * iw + posw + l;
-                auto val = inptr[offset];
-                if (maxval < val)
-                    maxval = val;
-            }
+        if (oh == 1 && ow == 1 && kh == ih && kw == iw && ph == 0 &&
+            pw == 0 && dh == 1 && dw == 1) {
+            globalPool<T, IsMax>(inptr, outptr, planes, size_t(ih) * iw);
+            return;
         }
-        return maxval;
+        pool<T, IsMax>(inptr, outptr, planes,
+                       {ih, iw, oh, ow, kh, kw, ph, pw, sh, sw, dh, dw});
     }
 };
 
-template <typename T> class NaiveAvgPool : public NativePooling<T> {
-    T getPoolingValue(int kh, int kw, int posh, int posw, int ih, int iw,
-                      T *inptr) const override {
-        T sum = 0;
-        for (auto k = 0; k < kh; k++) {
-            for (auto l = 0; l < kw; l++) {
-                auto inPosH = posh + k;
-                auto inPosW = posw + l;
-                if (inPosH < 0 || inPosH >= ih || inPosW < 0 || inPosW >= iw)
-                    continue;
-                auto offset = (posh + k) * iw + posw + l;
-                sum += inptr[offset];
-            }
-        }
-        return T(sum / (kh * kw));
-    }
-};
+template <typename T> using MaxPoolCpu = PoolingCpu<T, true>;
+template <typename T> using AvgPoolCpu = PoolingCpu<T, false>;
 
 REGISTER_KERNEL(Device::CPU, OpType::MaxPool, DataType::UInt32,
-                NaiveMaxPool<uint32_t>, "maxPoolNaive_CPU_uint32");
+                MaxPoolCpu<uint32_t>, "maxPool_CPU_uint32");
 REGISTER_KERNEL(Device::CPU, OpType::MaxPool, DataType::Float32,
-                NaiveMaxPool<float>, "maxPoolNaive_CPU_float32");
+                MaxPoolCpu<float>, "maxPool_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::MaxPool, DataType::Float16,
+                MaxPoolCpu<uint16_t>, "maxPool_CPU_float16");
 REGISTER_KERNEL(Device::CPU, OpType::AveragePool, DataType::Float32,
-                NaiveAvgPool<float>, "AvgPoolNaive_CPU_float32");
+                AvgPoolCpu<float>, "avgPool_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::AveragePool, DataType::Float16,
+                AvgPoolCpu<uint16_t>, "avgPool_CPU_float16");
 } // namespace infini
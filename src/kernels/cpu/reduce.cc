@@ -0,0 +1,253 @@
+#include "operators/reduce.h"
+#include "core/kernel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace infini {
+
+namespace {
+
+// Below this many input elements the OpenMP fork costs more than it saves.
+constexpr size_t PARALLEL_WORKLOAD = 1 << 15;
+// A slice of the reduced extent is not worth a thread below this size.
+constexpr size_t MIN_CHUNK = 1 << 12;
+// Inner extents wider than this are split into tiles for the threads.
+constexpr size_t INNER_TILE = 1 << 10;
+
+enum class ReduceKind { Sum, Mean, Max, Min, L2 };
+
+// Every kind reduces map(x) with combine() starting from init(), and turns
+// the result of `count` elements into the output with finish().
+template <ReduceKind K> struct Reducer {
+    static constexpr bool IsAdd =
+        K == ReduceKind::Sum || K == ReduceKind::Mean || K == ReduceKind::L2;
+
+    static float init() {
+        if constexpr (K == ReduceKind::Max)
+            return -std::numeric_limits<float>::infinity();
+        else if constexpr (K == ReduceKind::Min)
+            return std::numeric_limits<float>::infinity();
+        else
+            return 0;
+    }
+    static float map(float x) {
+        if constexpr (K == ReduceKind::L2)
+            return x * x;
+        else
+            return x;
+    }
+    static float combine(float a, float b) {
+        if constexpr (K == ReduceKind::Max)
+            return a > b ? a : b;
+        else if constexpr (K == ReduceKind::Min)
+            return a < b ? a : b;
+        else
+            return a + b;
+    }
+    static float finish(float acc, size_t count) {
+        if constexpr (K == ReduceKind::Mean)
+            return acc / float(count);
+        else if constexpr (K == ReduceKind::L2)
+            return std::sqrt(acc);
+        else
+            return acc;
+    }
+};
+
+// The input viewed as (outer, reduce, inner). Adjacent axes that are both
+// kept or both reduced are merged and unit axes dropped, so `inner` is the
+// contiguous trailing kept extent. When nothing is kept behind the last
+// reduced axis, inner is 1 and the reduction instead reads runs of `run`
+// contiguous elements.
+struct ReducePlan {
+    size_t inner = 1, run = 1;
+    std::vector<size_t> outerOffsets;  // input offset of every outer index
+    std::vector<size_t> reduceOffsets; // offset of every run or inner row
+    size_t count() const { return reduceOffsets.size() * run; }
+};
+
+// Offsets of all indices of the axes `dims` with strides `strides`, first
+// axis outermost.
+std::vector<size_t> enumerateOffsets(const std::vector<size_t> &dims,
+                                     const std::vector<size_t> &strides) {
+    std::vector<size_t> offsets{0};
+    for (size_t i = 0; i < dims.size(); ++i) {
+        std::vector<size_t> next;
+        next.reserve(offsets.size() * dims[i]);
+        for (auto base : offsets)
+            for (size_t j = 0; j < dims[i]; ++j)
+                next.push_back(base + j * strides[i]);
+        offsets = std::move(next);
+    }
+    return offsets;
+}
+
+ReducePlan makePlan(const Shape &shape, const ReduceBaseObj &op) {
+    // Merge the axes into groups of (extent, reduced)
+    std::vector<std::pair<size_t, bool>> groups;
+    for (size_t i = 0; i < shape.size(); ++i) {
+        const bool reduced = op.isReduced(i);
+        if (shape[i] == 1)
+            continue;
+        if (!groups.empty() && groups.back().second == reduced)
+            groups.back().first *= shape[i];
+        else
+            groups.emplace_back(shape[i], reduced);
+    }
+    ReducePlan plan;
+    size_t stride = 1;
+    if (!groups.empty()) {
+        (groups.back().second ? plan.run : plan.inner) = groups.back().first;
+        stride = groups.back().first;
+        groups.pop_back();
+    }
+    std::vector<size_t> keptDims, keptStrides, reducedDims, reducedStrides;
+    for (auto it = groups.rbegin(); it != groups.rend(); ++it) {
+        auto &dims = it->second ? reducedDims : keptDims;
+        auto &strides = it->second ? reducedStrides : keptStrides;
+        dims.insert(dims.begin(), it->first);
+        strides.insert(strides.begin(), stride);
+        stride *= it->first;
+    }
+    plan.outerOffsets = enumerateOffsets(keptDims, keptStrides);
+    plan.reduceOffsets = enumerateOffsets(reducedDims, reducedStrides);
+    return plan;
+}
+
+// Reduces the positions [begin, end) of the reduced extent of one outer
+// index into a scalar, reading contiguous runs.
+template <ReduceKind K>
+float reduceRuns(const float *in, const ReducePlan &plan, size_t begin,
+                 size_t end) {
+    using R = Reducer<K>;
+    float acc = R::init();
+    while (begin < end) {
+        const size_t m = begin / plan.run, l = begin % plan.run;
+        const size_t n = std::min(plan.run - l, end - begin);
+        const float *src = in + plan.reduceOffsets[m] + l;
+        if constexpr (R::IsAdd) {
+#pragma omp simd reduction(+ : acc)
+            for (size_t i = 0; i < n; ++i)
+                acc += R::map(src[i]);
+        } else if constexpr (K == ReduceKind::Max) {
+#pragma omp simd reduction(max : acc)
+            for (size_t i = 0; i < n; ++i)
+                acc = std::max(acc, src[i]);
+        } else {
+#pragma omp simd reduction(min : acc)
+            for (size_t i = 0; i < n; ++i)
+                acc = std::min(acc, src[i]);
+        }
+        begin += n;
+    }
+    return acc;
+}
+
+// Reduces the rows [begin, end) of the reduced extent of one outer index
+// into `acc`, vectorized along the `width` inner elements from `col`.
+template <ReduceKind K>
+void reduceRows(const float *in, const ReducePlan &plan, size_t begin,
+                size_t end, size_t col, size_t width, float *acc) {
+    using R = Reducer<K>;
+    std::fill(acc, acc + width, R::init());
+    for (size_t m = begin; m < end; ++m) {
+        const float *src = in + plan.reduceOffsets[m] + col;
+#pragma omp simd
+        for (size_t j = 0; j < width; ++j)
+            acc[j] = R::combine(acc[j], R::map(src[j]));
+    }
+}
+
+template <ReduceKind K>
+void reduce(const float *in, float *out, const ReducePlan &plan) {
+    using R = Reducer<K>;
+    const size_t outer = plan.outerOffsets.size(), inner = plan.inner;
+    const size_t rows = plan.reduceOffsets.size(), count = plan.count();
+    const size_t size = outer * inner;
+    int threads = 1;
+#ifdef _OPENMP
+    if (size * count > PARALLEL_WORKLOAD)
+        threads = omp_get_max_threads();
+#endif
+    // Work is spread over outer indices and tiles of the inner extent. With
+    // fewer of them than threads, the reduced extent is split into `splits`
+    // slices as well, whose partial results are then combined pairwise.
+    const size_t tiles = (inner + INNER_TILE - 1) / INNER_TILE;
+    const size_t extent = inner == 1 ? count : rows;
+    const size_t grain = inner == 1 ? MIN_CHUNK : MIN_CHUNK / inner + 1;
+    size_t splits = 1;
+    if (outer * tiles < size_t(threads))
+        splits = std::max<size_t>(
+            1, std::min(threads / (outer * tiles), extent / grain));
+    const size_t chunk = (extent + splits - 1) / splits;
+
+    std::vector<float> partial(splits == 1 ? 0 : splits * size);
+    float *dst = splits == 1 ? out : partial.data();
+#pragma omp parallel for collapse(3) schedule(static) if (threads > 1)
+    for (size_t s = 0; s < splits; ++s)
+        for (size_t o = 0; o < outer; ++o)
+            for (size_t t = 0; t < tiles; ++t) {
+                const float *src = in + plan.outerOffsets[o];
+                const size_t begin = std::min(extent, s * chunk),
+                             end = std::min(extent, begin + chunk);
+                float *acc = dst + s * size + o * inner;
+                if (inner == 1) {
+                    *acc = reduceRuns<K>(src, plan, begin, end);
+                } else {
+                    const size_t col = t * INNER_TILE;
+                    reduceRows<K>(src, plan, begin, end, col,
+                                  std::min(INNER_TILE, inner - col),
+                                  acc + col);
+                }
+            }
+    for (size_t width = 1; width < splits; width *= 2) {
+#pragma omp parallel for schedule(static) if (threads > 1)
+        for (size_t s = 0; s < splits - width; s += 2 * width) {
+            float *a = dst + s * size;
+            const float *b = dst + (s + width) * size;
+#pragma omp simd
+            for (size_t i = 0; i < size; ++i)
+                a[i] = R::combine(a[i], b[i]);
+        }
+    }
+#pragma omp parallel for simd if (size > PARALLEL_WORKLOAD)
+    for (size_t i = 0; i < size; ++i)
+        out[i] = R::finish(dst[i], count);
+}
+
+} // namespace
+
+/**
+ * @brief Reduces any set of axes on CPU. The axes are reordered into
+ * (outer, reduce, inner): a contiguous inner extent is accumulated a row at a
+ * time along the inner axis, otherwise every output reduces contiguous runs
+ * into a scalar. Outputs are spread over the threads, and the reduced extent
+ * is split as well when there are fewer outputs than threads.
+ */
+template <ReduceKind K> class ReduceCpu : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<ReduceBaseObj>(_op);
+        auto input = op->getInputs(0);
+        reduce<K>(input->getRawDataPtr<float *>(),
+                  op->getOutput()->getRawDataPtr<float *>(),
+                  makePlan(input->getDims(), *op));
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::ReduceSum, DataType::Float32,
+                ReduceCpu<ReduceKind::Sum>, "reduceSum_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::ReduceMean, DataType::Float32,
+                ReduceCpu<ReduceKind::Mean>, "reduceMean_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::ReduceMax, DataType::Float32,
+                ReduceCpu<ReduceKind::Max>, "reduceMax_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::ReduceMin, DataType::Float32,
+                ReduceCpu<ReduceKind::Min>, "reduceMin_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::ReduceL2, DataType::Float32,
+                ReduceCpu<ReduceKind::L2>, "reduceL2_CPU_float32");
+} // namespace infini
@@ -0,0 +1,49 @@
+#include "operators/reshape.h"
+#include "core/kernel.h"
+#include <cstring>
+
+namespace infini {
+
+// dataMalloc binds the output of a view to the memory of its input, which
+// leaves a copy only for views it cannot alias, e.g. of weights
+class CopyCpu : public CpuKernelWithoutConfig {
+    // A contiguous view, e.g. a slice along the first axis, is copied as is
+    bool supportsStridedInput(const Operator &op, int index) const override {
+        return op->getInputs(0)->isContiguous();
+    }
+
+    void compute(const Operator &op,
+                 const RuntimeObj *context) const override {
+        auto inData = op->getInputs(0)->getRawDataPtr<void *>();
+        auto outData = op->getOutput()->getRawDataPtr<void *>();
+        if (inData != outData)
+            std::memcpy(outData, inData, op->getInputs(0)->getBytes());
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Reshape, DataType::Float32, CopyCpu,
+                "Reshape_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Reshape, DataType::Float16, CopyCpu,
+                "Reshape_CPU_float16");
+REGISTER_KERNEL(Device::CPU, OpType::Reshape, DataType::Int32, CopyCpu,
+                "Reshape_CPU_int32");
+REGISTER_KERNEL(Device::CPU, OpType::Reshape, DataType::Int64, CopyCpu,
+                "Reshape_CPU_int64");
+REGISTER_KERNEL(Device::CPU, OpType::Flatten, DataType::Float32, CopyCpu,
+                "Flatten_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Flatten, DataType::Float16, CopyCpu,
+                "Flatten_CPU_float16");
+REGISTER_KERNEL(Device::CPU, OpType::Flatten, DataType::Int32, CopyCpu,
+                "Flatten_CPU_int32");
+REGISTER_KERNEL(Device::CPU, OpType::Flatten, DataType::Int64, CopyCpu,
+                "Flatten_CPU_int64");
+REGISTER_KERNEL(Device::CPU, OpType::Identity, DataType::Float32, CopyCpu,
+                "Identity_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Identity, DataType::Float16, CopyCpu,
+                "Identity_CPU_float16");
+REGISTER_KERNEL(Device::CPU, OpType::Identity, DataType::Int32, CopyCpu,
+                "Identity_CPU_int32");
+REGISTER_KERNEL(Device::CPU, OpType::Identity, DataType::Int64, CopyCpu,
+                "Identity_CPU_int64");
+
+} // namespace infini
@@ -0,0 +1,43 @@
+#include "operators/slice.h"
+#include "core/kernel.h"
+#include "cpu/cpu_copy.h"
+
+namespace infini {
+
+// The output is a view of the input with the starts as offset and the steps
+// scaling the strides
+class SliceCpu : public CpuKernelWithoutConfig {
+    bool supportsStridedInput(const Operator &op, int index) const override {
+        return true;
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<SliceObj>(_op);
+        auto input = op->getInputs(0), output = op->getOutput();
+        auto starts = op->getStarts(), steps = op->getSteps();
+        auto srcStrides = cpuStrides(input);
+        int64_t offset = 0;
+        for (size_t i = 0; i < srcStrides.size(); ++i) {
+            offset += starts[i] * srcStrides[i];
+            srcStrides[i] *= steps[i];
+        }
+        const size_t elemSize = input->getDType().getSize();
+        cpuStridedCopy(elemSize, output->getDims(),
+                       output->getRawDataPtr<void *>(),
+                       cpuContiguousStrides(output->getDims()),
+                       input->getRawDataPtr<uint8_t *>() + offset * elemSize,
+                       srcStrides);
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Slice, DataType::Float32, SliceCpu,
+                "slice_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Slice, DataType::Float16, SliceCpu,
+                "slice_CPU_float16");
+REGISTER_KERNEL(Device::CPU, OpType::Slice, DataType::Int32, SliceCpu,
+                "slice_CPU_int32");
+REGISTER_KERNEL(Device::CPU, OpType::Slice, DataType::Int64, SliceCpu,
+                "slice_CPU_int64");
+
+} // namespace infini
@@ -0,0 +1,123 @@
+#include "operators/softmax.h"
+#include "core/kernel.h"
+#include "cpu/cpu_math.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace infini {
+
+namespace {
+
+// Columns of the inner dims normalized together when the axis is not the
+// last one, so that the running maxima and sums stay in L1.
+constexpr size_t COLUMN_BLOCK = 64;
+// Below this many elements the OpenMP fork costs more than it saves.
+constexpr size_t PARALLEL_WORKLOAD = 1 << 15;
+
+template <typename T> inline T expOf(T x) {
+    if constexpr (std::is_same_v<T, float>)
+        return cpuExp(x);
+    else
+        return static_cast<T>(std::exp(x));
+}
+
+// Softmax of `len` contiguous elements
+template <typename T> void softmaxRow(const T *x, T *y, size_t len) {
+    T maxVal = x[0];
+#pragma omp simd reduction(max : maxVal)
+    for (size_t i = 1; i < len; ++i)
+        maxVal = std::max(maxVal, x[i]);
+    T sum = 0;
+#pragma omp simd reduction(+ : sum)
+    for (size_t i = 0; i < len; ++i) {
+        y[i] = expOf<T>(x[i] - maxVal);
+        sum += y[i];
+    }
+    const T scale = T(1) / sum;
+#pragma omp simd
+    for (size_t i = 0; i < len; ++i)
+        y[i] *= scale;
+}
+
+// Softmax over `len` rows of `stride` elements, for the `cols` columns
+// starting at `x` and `y`
+template <typename T>
+void softmaxColumns(const T *x, T *y, size_t len, size_t stride,
+                    size_t cols) {
+    T maxVal[COLUMN_BLOCK], sum[COLUMN_BLOCK];
+    std::copy(x, x + cols, maxVal);
+    for (size_t l = 1; l < len; ++l) {
+        const T *row = x + l * stride;
+#pragma omp simd
+        for (size_t j = 0; j < cols; ++j)
+            maxVal[j] = std::max(maxVal[j], row[j]);
+    }
+    std::fill(sum, sum + cols, T(0));
+    for (size_t l = 0; l < len; ++l) {
+        const T *in = x + l * stride;
+        T *out = y + l * stride;
+#pragma omp simd
+        for (size_t j = 0; j < cols; ++j) {
+            out[j] = expOf<T>(in[j] - maxVal[j]);
+            sum[j] += out[j];
+        }
+    }
+#pragma omp simd
+    for (size_t j = 0; j < cols; ++j)
+        sum[j] = T(1) / sum[j];
+    for (size_t l = 0; l < len; ++l) {
+        T *out = y + l * stride;
+#pragma omp simd
+        for (size_t j = 0; j < cols; ++j)
+            out[j] *= sum[j];
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Softmax along any axis. The input is viewed as [outer, len, inner],
+ * where len is the size of the axis. Each of the outer * inner rows is
+ * normalized in one pass for the maximum and one fused pass for exp and the
+ * sum, and rows are distributed over OpenMP threads.
+ */
+template <typename T> class SoftmaxCpu : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<SoftmaxObj>(_op);
+        const T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
+        T *outptr = op->getOutput()->getRawDataPtr<T *>();
+
+        auto dims = op->getInputs(0)->getDims();
+        const int axis = op->getAxis();
+        size_t outer = 1, inner = 1;
+        for (int i = 0; i < axis; ++i)
+            outer *= dims[i];
+        for (size_t i = axis + 1; i < dims.size(); ++i)
+            inner *= dims[i];
+        const size_t len = dims[axis];
+        const bool parallel = outer * len * inner > PARALLEL_WORKLOAD;
+
+        if (inner == 1) {
+#pragma omp parallel for if (parallel) schedule(static)
+            for (size_t o = 0; o < outer; ++o)
+                softmaxRow(inptr + o * len, outptr + o * len, len);
+            return;
+        }
+        const size_t blocks = (inner + COLUMN_BLOCK - 1) / COLUMN_BLOCK;
+#pragma omp parallel for collapse(2) if (parallel) schedule(static)
+        for (size_t o = 0; o < outer; ++o)
+            for (size_t b = 0; b < blocks; ++b) {
+                const size_t col = b * COLUMN_BLOCK,
+                             offset = o * len * inner + col;
+                softmaxColumns(inptr + offset, outptr + offset, len, inner,
+                               std::min(COLUMN_BLOCK, inner - col));
+            }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Softmax, DataType::Float32,
+                SoftmaxCpu<float>, "softmax_CPU_float32");
+
+} // namespace infini
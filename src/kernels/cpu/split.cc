@@ -0,0 +1,39 @@
+#include "operators/split.h"
+#include "core/kernel.h"
+#include "cpu/cpu_copy.h"
+
+namespace infini {
+
+// Each output is copied from its slice of the input along the axis
+class SplitCpu : public CpuKernelWithoutConfig {
+    bool supportsStridedInput(const Operator &op, int index) const override {
+        return true;
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<SplitObj>(_op);
+        auto input = op->getInputs(0);
+        const int dim = op->getDim();
+        const auto srcStrides = cpuStrides(input);
+        const size_t elemSize = input->getDType().getSize();
+        auto src = input->getRawDataPtr<uint8_t *>();
+        for (auto &output : op->getOutputs()) {
+            auto dims = output->getDims();
+            cpuStridedCopy(elemSize, dims, output->getRawDataPtr<void *>(),
+                           cpuContiguousStrides(dims), src, srcStrides);
+            src += dims[dim] * srcStrides[dim] * elemSize;
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Split, DataType::Float32, SplitCpu,
+                "split_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Split, DataType::Float16, SplitCpu,
+                "split_CPU_float16");
+REGISTER_KERNEL(Device::CPU, OpType::Split, DataType::Int32, SplitCpu,
+                "split_CPU_int32");
+REGISTER_KERNEL(Device::CPU, OpType::Split, DataType::Int64, SplitCpu,
+                "split_CPU_int64");
+
+} // namespace infini
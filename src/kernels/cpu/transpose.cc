@@ -0,0 +1,37 @@
+#include "operators/transpose.h"
+#include "core/kernel.h"
+#include "cpu/cpu_copy.h"
+
+namespace infini {
+
+class TransposeCpu : public CpuKernelWithoutConfig {
+    bool supportsStridedInput(const Operator &op, int index) const override {
+        return true;
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<TransposeObj>(_op);
+        auto input = op->getInputs(0), output = op->getOutput();
+        auto permute = op->getPermute();
+        auto inStrides = cpuStrides(input);
+        vector<int64_t> srcStrides(permute.size());
+        for (size_t i = 0; i < permute.size(); ++i)
+            srcStrides[i] = inStrides[permute[i]];
+        cpuStridedCopy(input->getDType().getSize(), output->getDims(),
+                       output->getRawDataPtr<void *>(),
+                       cpuContiguousStrides(output->getDims()),
+                       input->getRawDataPtr<void *>(), srcStrides);
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Transpose, DataType::Float32, TransposeCpu,
+                "transpose_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Transpose, DataType::Float16, TransposeCpu,
+                "transpose_CPU_float16");
+REGISTER_KERNEL(Device::CPU, OpType::Transpose, DataType::Int32, TransposeCpu,
+                "transpose_CPU_int32");
+REGISTER_KERNEL(Device::CPU, OpType::Transpose, DataType::Int64, TransposeCpu,
+                "transpose_CPU_int64");
+
+} // namespace infini
@@ -1,143 +1,181 @@
 #include "operators/unary.h"
-#include "core/constants.h"
 #include "core/kernel.h"
+#include "cpu/cpu_math.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace infini {
-template <typename T> class NativeUnary : public CpuKernelWithoutConfig {
-    virtual T doCompute(T val) const = 0;
-    void compute(const Operator &_op,
-                 const RuntimeObj *context) const override {
-        auto op = as<UnaryObj>(_op);
-        T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
-        T *outptr = op->getOutput()->getRawDataPtr<T *>();
 
-        auto outDim = op->getOutput()->getDims();
-        auto n = op->getOutput()->size();
-        for (size_t offset = 0; offset < n; offset++) {
-            outptr[offset] = doCompute(inptr[offset]);
-        }
-    }
-};
+namespace {
 
-template <typename T> class NaiveSoftmax : public CpuKernelWithoutConfig {
-    void compute(const Operator &_op,
-                 const RuntimeObj *context) const override {
-        auto op = as<UnaryObj>(_op);
-        T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
-        T *outptr = op->getOutput()->getRawDataPtr<T *>();
+// Below this many elements the OpenMP fork costs more than it saves.
+constexpr size_t PARALLEL_WORKLOAD = 1 << 15;
+
+// Applies `f` to every element. `f` is inlined into the loop, which keeps it
+// vectorizable for the branch-free functions of cpu/cpu_math.h.
+template <typename T, typename F>
+void unaryMap(const T *inptr, T *outptr, size_t n, F f) {
+#pragma omp parallel for simd if (n > PARALLEL_WORKLOAD) schedule(static)
+    for (size_t i = 0; i < n; ++i)
+        outptr[i] = f(inptr[i]);
+}
 
-        auto outDim = op->getOutput()->getDims();
-        auto n = op->getOutput()->size();
-        auto sum = T(0);
-        for (size_t offset = 0; offset < n; offset++) {
-            sum += pow(E_CONSTANT, inptr[offset]);
-        }
-        for (size_t offset = 0; offset < n; offset++) {
-            outptr[offset] = pow(E_CONSTANT, inptr[offset]) / sum;
-        }
+// Transcendental functions are evaluated in float for every data type.
+struct ReluFunc {
+    template <typename T> T operator()(T x) const { return std::max(T(0), x); }
+};
+struct SigmoidFunc {
+    template <typename T> T operator()(T x) const {
+        return T(cpuSigmoid(float(x)));
     }
 };
-
-template <typename T> class NaiveRelu : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::max(T(0), val); }
+struct HardSigmoidFunc {
+    template <typename T> T operator()(T x) const {
+        return std::max(T(0), std::min(T(1), T(0.2) * x + T(0.5)));
+    }
+};
+struct HardSwishFunc {
+    template <typename T> T operator()(T x) const {
+        return x * std::max(T(0), std::min(T(1), x * T(1.0 / 6.0) + T(0.5)));
+    }
 };
-template <typename T> class NaiveSigmoid : public NativeUnary<T> {
-    T doCompute(T val) const override {
-        return 1 / (1 + pow(E_CONSTANT, -val));
+struct TanhFunc {
+    template <typename T> T operator()(T x) const {
+        return T(cpuTanh(float(x)));
     }
 };
-template <typename T> class NaiveHardSigmoid : public NativeUnary<T> {
-    T doCompute(T val) const override {
-        return std::max(T(0), std::min(T(1), T(0.2) * val + T(0.5)));
+struct AbsFunc {
+    template <typename T> T operator()(T x) const { return x < 0 ? -x : x; }
+};
+struct SqrtFunc {
+    template <typename T> T operator()(T x) const { return std::sqrt(x); }
+};
+struct GeluFunc {
+    template <typename T> T operator()(T x) const {
+        return T(cpuGelu(float(x)));
     }
 };
-template <typename T> class NaiveHardSwish : public NativeUnary<T> {
-    T doCompute(T val) const override {
-        return val *
-               std::max(T(0), std::min(T(1), val * T(1.0 / 6.0) + T(0.5)));
+struct ErfFunc {
+    template <typename T> T operator()(T x) const {
+        return T(cpuErf(float(x)));
     }
 };
-template <typename T> class NaiveTanh : public NativeUnary<T> {
-    T doCompute(T val) const override {
-        return (pow(E_CONSTANT, val) - pow(E_CONSTANT, -val)) /
-               (pow(E_CONSTANT, val) + pow(E_CONSTANT, -val));
+struct ExpFunc {
+    template <typename T> T operator()(T x) const {
+        return T(cpuExp(float(x)));
     }
 };
-template <typename T> class NaiveAbs : public NativeUnary<T> {
-    T doCompute(T val) const override { return val < 0 ? -val : val; }
+struct NegFunc {
+    template <typename T> T operator()(T x) const { return -x; }
 };
 
-template <typename T> class NaiveSqrt : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::sqrt(val); }
-};
+} // namespace
 
-template <typename T> class NaiveGelu : public NativeUnary<T> {
-    T doCompute(T val) const override {
-        return 0.5 * val * (1 + std::erf(val / std::sqrt(2)));
+template <typename T, typename F>
+class UnaryCpu : public CpuKernelWithoutConfig {
+    void compute(const Operator &op,
+                 const RuntimeObj *context) const override {
+        unaryMap(op->getInputs(0)->getRawDataPtr<T *>(),
+                 op->getOutput()->getRawDataPtr<T *>(), op->getOutput()->size(),
+                 F());
     }
 };
 
-template <typename T> class NaiveErf : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::erf(val); }
-};
+template <typename T> using ReluCpu = UnaryCpu<T, ReluFunc>;
+template <typename T> using SigmoidCpu = UnaryCpu<T, SigmoidFunc>;
+template <typename T> using HardSigmoidCpu = UnaryCpu<T, HardSigmoidFunc>;
+template <typename T> using HardSwishCpu = UnaryCpu<T, HardSwishFunc>;
+template <typename T> using TanhCpu = UnaryCpu<T, TanhFunc>;
+template <typename T> using AbsCpu = UnaryCpu<T, AbsFunc>;
+template <typename T> using SqrtCpu = UnaryCpu<T, SqrtFunc>;
+template <typename T> using GeluCpu = UnaryCpu<T, GeluFunc>;
+template <typename T> using ErfCpu = UnaryCpu<T, ErfFunc>;
+template <typename T> using ExpCpu = UnaryCpu<T, ExpFunc>;
+template <typename T> using NegCpu = UnaryCpu<T, NegFunc>;
 
-template <typename T> class NaiveNeg : public NativeUnary<T> {
-    T doCompute(T val) const override { return -val; }
+template <typename T> class LogCpu : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<LogObj>(_op);
+        // log_b(x) = ln(x) / ln(b)
+        float scale = 1;
+        if (op->getType() == LogObj::Log2)
+            scale = 1.44269504f;
+        else if (op->getType() == LogObj::Log10)
+            scale = 0.434294482f;
+        unaryMap(op->getInputs(0)->getRawDataPtr<T *>(),
+                 op->getOutput()->getRawDataPtr<T *>(), op->getOutput()->size(),
+                 [scale](T x) { return T(cpuLog(float(x)) * scale); });
+    }
 };
 
 template <typename T> class Clip : public CpuKernelWithoutConfig {
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
         auto op = as<ClipObj>(_op);
-        T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
-        T *outptr = op->getOutput()->getRawDataPtr<T *>();
-        auto minValue = op->getMin();
-        auto maxValue = op->getMax();
+        const T lo = op->getMin() ? T(*op->getMin())
+                                  : std::numeric_limits<T>::lowest();
+        const T hi =
+            op->getMax() ? T(*op->getMax()) : std::numeric_limits<T>::max();
+        unaryMap(op->getInputs(0)->getRawDataPtr<T *>(),
+                 op->getOutput()->getRawDataPtr<T *>(), op->getOutput()->size(),
+                 [lo, hi](T x) { return x < lo ? lo : (x > hi ? hi : x); });
+    }
+};
 
-        auto n = op->getOutput()->size();
-        for (size_t offset = 0; offset < n; offset++) {
-            auto val = *inptr++;
-            *outptr++ = (minValue && val < *minValue)   ? *minValue
-                        : (maxValue && val > *maxValue) ? *maxValue
-                                                        : val;
-        }
+template <typename T> class NaiveShape : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<ShapeObj>(_op);
+        T *outptr = op->getOutput()->getRawDataPtr<T *>();
+        for (auto dim : op->getInputs(0)->getDims())
+            *outptr++ = static_cast<T>(dim);
     }
 };
 
 REGISTER_KERNEL(Device::CPU, OpType::Relu, DataType::UInt32,
-                NaiveRelu<uint32_t>, "reluNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Relu, DataType::Float32, NaiveRelu<float>,
-                "reluNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Gelu, DataType::UInt32, NaiveGelu<float>,
-                "geluNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Gelu, DataType::Float32, NaiveGelu<float>,
-                "geluNaive_CPU_float32");
+                ReluCpu<uint32_t>, "relu_CPU_uint32");
+REGISTER_KERNEL(Device::CPU, OpType::Relu, DataType::Float32, ReluCpu<float>,
+                "relu_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Gelu, DataType::UInt32,
+                GeluCpu<uint32_t>, "gelu_CPU_uint32");
+REGISTER_KERNEL(Device::CPU, OpType::Gelu, DataType::Float32, GeluCpu<float>,
+                "gelu_CPU_float32");
 REGISTER_KERNEL(Device::CPU, OpType::Sigmoid, DataType::UInt32,
-                NaiveSigmoid<uint32_t>, "sigmoidNaive_CPU_uint32");
+                SigmoidCpu<uint32_t>, "sigmoid_CPU_uint32");
 REGISTER_KERNEL(Device::CPU, OpType::Sigmoid, DataType::Float32,
-                NaiveSigmoid<float>, "sigmoidNaive_CPU_float32");
+                SigmoidCpu<float>, "sigmoid_CPU_float32");
 REGISTER_KERNEL(Device::CPU, OpType::HardSigmoid, DataType::Float32,
-                NaiveHardSigmoid<float>, "hardSigmoidNaive_CPU_float32");
+                HardSigmoidCpu<float>, "hardSigmoid_CPU_float32");
 REGISTER_KERNEL(Device::CPU, OpType::HardSwish, DataType::Float32,
-                NaiveHardSwish<float>, "hardSwishNaive_CPU_float32");
+                HardSwishCpu<float>, "hardSwish_CPU_float32");
 REGISTER_KERNEL(Device::CPU, OpType::Tanh, DataType::UInt32,
-                NaiveTanh<uint32_t>, "tanhNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Tanh, DataType::Float32, NaiveTanh<float>,
-                "tanhNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Abs, DataType::UInt32, NaiveAbs<uint32_t>,
-                "absNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Abs, DataType::Float32, NaiveAbs<float>,
-                "absNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Sqrt, DataType::Float32, NaiveSqrt<float>,
-                "sqrtNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Erf, DataType::Float32, NaiveErf<float>,
-                "erfNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Neg, DataType::Float32, NaiveNeg<float>,
-                "negNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Softmax, DataType::UInt32,
-                NaiveSoftmax<uint32_t>, "softmaxNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Softmax, DataType::Float32,
-                NaiveSoftmax<float>, "softmaxNaive_CPU_float32");
+                TanhCpu<uint32_t>, "tanh_CPU_uint32");
+REGISTER_KERNEL(Device::CPU, OpType::Tanh, DataType::Float32, TanhCpu<float>,
+                "tanh_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Abs, DataType::UInt32, AbsCpu<uint32_t>,
+                "abs_CPU_uint32");
+REGISTER_KERNEL(Device::CPU, OpType::Abs, DataType::Float32, AbsCpu<float>,
+                "abs_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Sqrt, DataType::Float32, SqrtCpu<float>,
+                "sqrt_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Erf, DataType::Float32, ErfCpu<float>,
+                "erf_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Exp, DataType::Float32, ExpCpu<float>,
+                "exp_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Log, DataType::Float32, LogCpu<float>,
+                "log_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Neg, DataType::Float32, NegCpu<float>,
+                "neg_CPU_float32");
 REGISTER_KERNEL(Device::CPU, OpType::Clip, DataType::Float32, Clip<float>,
                 "Clip_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Shape, DataType::Float32,
+                NaiveShape<float>, "shapeNaive_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Shape, DataType::UInt32,
+                NaiveShape<uint32_t>, "shapeNaive_CPU_uint32");
+REGISTER_KERNEL(Device::CPU, OpType::Shape, DataType::Int32,
+                NaiveShape<int32_t>, "shapeNaive_CPU_int32");
+REGISTER_KERNEL(Device::CPU, OpType::Shape, DataType::Int64,
+                NaiveShape<int64_t>, "shapeNaive_CPU_int64");
 }; // namespace infini
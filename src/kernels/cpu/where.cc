@@ -0,0 +1,71 @@
+#include "operators/where.h"
+#include "core/kernel.h"
+#include "cpu/cpu_broadcast.h"
+
+namespace infini {
+
+namespace {
+
+template <typename E>
+void where(const E *x, const E *y, const uint8_t *cond, E *out,
+           const BroadcastShape &shape) {
+    shape.forEachRun<3>([&](size_t o, const std::array<size_t, 3> &in,
+                            size_t len) {
+        const size_t sx = shape.getInnerStride(0),
+                     sy = shape.getInnerStride(1),
+                     sc = shape.getInnerStride(2);
+        const E *px = x + in[0], *py = y + in[1];
+        const uint8_t *pc = cond + in[2];
+        E *po = out + o;
+#pragma omp simd
+        for (size_t i = 0; i < len; ++i)
+            po[i] = pc[i * sc] ? px[i * sx] : py[i * sy];
+    });
+}
+
+} // namespace
+
+// The condition is read as one byte per element, i.e. Bool or UInt8
+class WhereCpu : public CpuKernelWithoutConfig {
+    bool supportsStridedInput(const Operator &op, int index) const override {
+        return true;
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<WhereObj>(_op);
+        auto x = op->getInputs(0), y = op->getInputs(1),
+             cond = op->getInputs(2), output = op->getOutput();
+        IT_ASSERT(cond->getDType().getSize() == 1);
+        BroadcastShape shape(
+            output->getDims(), {x->getDims(), y->getDims(), cond->getDims()},
+            {x->getStride(), y->getStride(), cond->getStride()});
+        void *px = x->getRawDataPtr<void *>(), *py = y->getRawDataPtr<void *>(),
+             *po = output->getRawDataPtr<void *>();
+        auto pc = cond->getRawDataPtr<uint8_t *>();
+        switch (output->getDType().getSize()) {
+        case 2:
+            where((uint16_t *)px, (uint16_t *)py, pc, (uint16_t *)po, shape);
+            break;
+        case 4:
+            where((uint32_t *)px, (uint32_t *)py, pc, (uint32_t *)po, shape);
+            break;
+        case 8:
+            where((uint64_t *)px, (uint64_t *)py, pc, (uint64_t *)po, shape);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Where, DataType::Float32, WhereCpu,
+                "where_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Where, DataType::Float16, WhereCpu,
+                "where_CPU_float16");
+REGISTER_KERNEL(Device::CPU, OpType::Where, DataType::Int32, WhereCpu,
+                "where_CPU_int32");
+REGISTER_KERNEL(Device::CPU, OpType::Where, DataType::Int64, WhereCpu,
+                "where_CPU_int64");
+
+} // namespace infini
@@ -1,6 +1,6 @@
 #include "operators/conv.h"
 #include "core/kernel.h"
-#include "intelcpu/mkl_runtime.h"
+#include "intelcpu/mkl_primitive_cache.h"
 
 namespace infini {
 struct ConvMklPerfRecordObj : public PerfRecordObj {
@@ -20,14 +20,35 @@ struct ConvMklPerfRecordObj : public PerfRecordObj {
 
 using ConvMklPerfRecord = Ref<ConvMklPerfRecordObj>;
 class MklConv : public Kernel {
-    bool createPrimitives(
-        const Ref<ConvObj> &op, const ConvMklPerfRecord &record,
-        const MklRuntimeObj *context, bool allowEmpty,
-        std::vector<dnnl::primitive> &prims,
-        std::vector<std::unordered_map<int, dnnl::memory>> &primArgs) const {
+    mutable MklPrimitiveCache cache;
+
+    MklPrimitives getPrimitives(const Ref<ConvObj> &op,
+                                const ConvMklPerfRecord &record,
+                                const MklRuntimeObj *context) const {
+        // A weight reordered in advance is identified by its tensor, since
+        // another one may be allocated at the same address later, and by the
+        // version of its data, since it may be updated in place
+        auto weight = op->getInputs(1);
+        auto key = MklPrimitiveCache::getKey(
+            op, {static_cast<int>(record->algo),
+                 static_cast<int>(op->getAct()),
+                 weight->isWeight() ? static_cast<int>(weight->getFuid()) : -1,
+                 weight->isWeight()
+                     ? static_cast<int>(weight->getDataVersion())
+                     : -1});
+        return cache.getOrCreate(
+            key, [&]() { return createPrimitives(op, record, context); });
+    }
+
+    // Returns nullptr if the algorithm does not support the convolution
+    MklPrimitives createPrimitives(const Ref<ConvObj> &op,
+                                   const ConvMklPerfRecord &record,
+                                   const MklRuntimeObj *context) const {
+        const bool allowEmpty = true;
         auto srcData = op->getInputs(0)->getRawDataPtr<float *>();
         auto wData = op->getInputs(1)->getRawDataPtr<float *>();
         auto dstData = op->getOutput(0)->getRawDataPtr<float *>();
+        auto bias = op->getBias();
 
         auto [n, c, h, w, f, r, s] = op->getNCHWFRS();
         auto [ph, pw, sh, sw, dh, dw] = op->getPadStrideDilation();
@@ -71,14 +92,19 @@ class MklConv : public Kernel {
         auto dstMd =
             dnnl::memory::desc({n, f, oH, oW}, dnnl::memory::data_type::f32,
                                dnnl::memory::format_tag::any);
+        // an empty descriptor means no bias
+        dnnl::memory::desc biasMd;
+        if (bias)
+            biasMd = dnnl::memory::desc({f}, dnnl::memory::data_type::f32,
+                                        dnnl::memory::format_tag::x);
 
         // create convolution descriptor
         dnnl::memory::dims strides = {sh, sw};
         dnnl::memory::dims pads = {ph, pw};
         dnnl::memory::dims dilations = {dh - 1, dw - 1};
         auto convDesc = dnnl::convolution_forward::desc(
-            dnnl::prop_kind::forward_inference, record->algo, srcMd, wMd, dstMd,
-            strides, dilations, pads, pads);
+            dnnl::prop_kind::forward_inference, record->algo, srcMd, wMd,
+            biasMd, dstMd, strides, dilations, pads, pads);
 
         dnnl::convolution_forward::primitive_desc primDesc;
 
@@ -115,15 +141,16 @@ class MklConv : public Kernel {
         }
 
         if (primDesc.get(allowEmpty) == nullptr)
-            return false;
+            return nullptr;
 
+        auto prims = make_ref<MklPrimitivesObj>();
         // reorder data and weight
         auto srcMemory = userSrcMemory;
         if (primDesc.src_desc() != userSrcMemory.get_desc()) {
             srcMemory = dnnl::memory(primDesc.src_desc(), context->getEngine());
 
-            prims.push_back(dnnl::reorder(userSrcMemory, srcMemory));
-            primArgs.push_back(
+            prims->add(
+                dnnl::reorder(userSrcMemory, srcMemory),
                 {{DNNL_ARG_FROM, userSrcMemory}, {DNNL_ARG_TO, srcMemory}});
         }
 
@@ -132,38 +159,47 @@ class MklConv : public Kernel {
             wMemory =
                 dnnl::memory(primDesc.weights_desc(), context->getEngine());
 
-            prims.push_back(dnnl::reorder(userWMemory, wMemory));
-            primArgs.push_back(
-                {{DNNL_ARG_FROM, userWMemory}, {DNNL_ARG_TO, wMemory}});
+            auto reorder = dnnl::reorder(userWMemory, wMemory);
+            if (op->getInputs(1)->isWeight()) {
+                // Weights do not change, so they are kept in the blocked
+                // format of the convolution instead of reordered every run
+                reorder.execute(context->getStream(), userWMemory, wMemory);
+                context->getStream().wait();
+            } else {
+                prims->add(reorder, {{DNNL_ARG_FROM, userWMemory},
+                                     {DNNL_ARG_TO, wMemory}});
+            }
         }
 
+        std::unordered_map<int, dnnl::memory> convArgs{
+            {DNNL_ARG_SRC, srcMemory}, {DNNL_ARG_WEIGHTS, wMemory}};
+        if (bias)
+            convArgs[DNNL_ARG_BIAS] =
+                dnnl::memory(biasMd, context->getEngine(),
+                             bias->getRawDataPtr<float *>());
+
         // Create memory for output
         if (primDesc.dst_desc() == userDstMd) {
             auto output = dnnl::memory(primDesc.dst_desc(),
                                        context->getEngine(), dstData);
 
             // create convolution primitivee
-            prims.push_back(dnnl::convolution_forward(primDesc));
-            primArgs.push_back({{DNNL_ARG_SRC, srcMemory},
-                                {DNNL_ARG_WEIGHTS, wMemory},
-                                {DNNL_ARG_DST, output}});
+            convArgs[DNNL_ARG_DST] = output;
+            prims->add(dnnl::convolution_forward(primDesc), convArgs);
         } else {
             auto dstMemory =
                 dnnl::memory(primDesc.dst_desc(), context->getEngine());
 
             // create convolution primitivee
-            prims.push_back(dnnl::convolution_forward(primDesc));
-            primArgs.push_back({{DNNL_ARG_SRC, srcMemory},
-                                {DNNL_ARG_WEIGHTS, wMemory},
-                                {DNNL_ARG_DST, dstMemory}});
+            convArgs[DNNL_ARG_DST] = dstMemory;
+            prims->add(dnnl::convolution_forward(primDesc), convArgs);
 
             auto output =
                 dnnl::memory(userDstMd, context->getEngine(), dstData);
-            prims.push_back(dnnl::reorder(dstMemory, output));
-            primArgs.push_back(
-                {{DNNL_ARG_FROM, dstMemory}, {DNNL_ARG_TO, output}});
+            prims->add(dnnl::reorder(dstMemory, output),
+                       {{DNNL_ARG_FROM, dstMemory}, {DNNL_ARG_TO, output}});
         }
-        return true;
+        return prims;
     }
 
     void compute(const Operator &_op, const PerfRecord &_record,
@@ -172,13 +208,9 @@ class MklConv : public Kernel {
         auto context = dynamic_cast<const MklRuntimeObj *>(_context);
         auto record = as<ConvMklPerfRecordObj>(_record);
 
-        std::vector<dnnl::primitive> prims;
-        std::vector<std::unordered_map<int, dnnl::memory>> primArgs;
-        IT_ASSERT(createPrimitives(op, record, context, true, prims, primArgs));
-
-        IT_ASSERT(prims.size() == primArgs.size());
-        for (size_t i = 0; i < prims.size(); ++i)
-            prims.at(i).execute(context->getStream(), primArgs.at(i));
+        auto prims = getPrimitives(op, record, context);
+        IT_ASSERT(prims);
+        prims->execute(context->getStream());
         context->getStream().wait();
     }
 
@@ -201,26 +233,20 @@ class MklConv : public Kernel {
             ConvMklPerfRecordObj record;
             record.algo = algo;
 
-            std::vector<dnnl::primitive> prims;
-            std::vector<std::unordered_map<int, dnnl::memory>> primArgs;
-            if (!createPrimitives(op, make_ref<ConvMklPerfRecordObj>(record),
-                                  context, true, prims, primArgs))
+            // The primitives of the chosen algorithm stay cached for run
+            auto prims = getPrimitives(
+                op, make_ref<ConvMklPerfRecordObj>(record), context);
+            if (!prims)
                 continue;
 
-            IT_ASSERT(prims.size() == primArgs.size());
             // does context->getStream() need to be attached to runtime, and
             // delete after each use?
-            for (size_t i = 0; i < prims.size(); ++i)
-                prims.at(i).execute(context->getStream(), primArgs.at(i));
+            prims->execute(context->getStream());
             context->getStream().wait();
 
-            record.time = timeit(
-                [&]() {
-                    for (size_t i = 0; i < prims.size(); ++i)
-                        prims.at(i).execute(context->getStream(),
-                                            primArgs.at(i));
-                },
-                [&]() { context->getStream().wait(); });
+            record.time =
+                timeit([&]() { prims->execute(context->getStream()); },
+                       [&]() { context->getStream().wait(); });
 
             // Update the tune result
             if (ret.time > record.time)
@@ -1,10 +1,12 @@
 #include "operators/element_wise.h"
 #include "intelcpu/mkl_kernel_without_config.h"
-#include "intelcpu/mkl_runtime.h"
+#include "intelcpu/mkl_primitive_cache.h"
 #include "operators/unary.h"
 
 namespace infini {
 class MklBinary : public MklKernelWithoutConfig {
+    mutable MklPrimitiveCache cache;
+
     dnnl::algorithm getAlgorithem(const Ref<ElementWiseObj> &op) const {
         switch (op->getOpType().underlying()) {
         case OpType::Add:
@@ -22,43 +24,47 @@ class MklBinary : public MklKernelWithoutConfig {
         return dnnl::algorithm::undef;
     }
 
+    MklPrimitives createPrimitives(const Ref<ElementWiseObj> &op,
+                                   const MklRuntimeObj *context) const {
+        //  create user memory that describes data layout in the buffers
+        // of the inputs, padded to the rank of the output
+        auto getMemory = [&](const Tensor &tensor) {
+            std::vector<dnnl_dim_t> dims(op->getOutput()->getRank(), 1);
+            auto tensorDims = tensor->getDims();
+            std::copy(tensorDims.begin(), tensorDims.end(),
+                      dims.end() - tensorDims.size());
+            auto md = dnnl::memory::desc(dims, dnnl::memory::data_type::f32,
+                                         getUserFormatTag(dims.size()));
+            return dnnl::memory(md, context->getEngine(),
+                                tensor->getRawDataPtr<void *>());
+        };
+        auto srcMemory1 = getMemory(op->getInputs(0));
+        auto srcMemory2 = getMemory(op->getInputs(1));
+        auto output = getMemory(op->getOutput());
+
+        auto binaryDesc = dnnl::binary::desc(
+            getAlgorithem(op), srcMemory1.get_desc(), srcMemory2.get_desc(),
+            output.get_desc());
+        auto primDesc =
+            dnnl::binary::primitive_desc(binaryDesc, context->getEngine());
+
+        auto prims = make_ref<MklPrimitivesObj>();
+        prims->add(dnnl::binary(primDesc), {{DNNL_ARG_SRC_0, srcMemory1},
+                                            {DNNL_ARG_SRC_1, srcMemory2},
+                                            {DNNL_ARG_DST, output}});
+        return prims;
+    }
+
     // Binary primitives support elementwise broadcast
     void compute(const Operator &_op,
                  const RuntimeObj *_context) const override {
         auto op = as<ElementWiseObj>(_op);
         auto context = dynamic_cast<const MklRuntimeObj *>(_context);
 
-        void *const aData = (op->getInputs(0)->getRawDataPtr<void *>());
-        void *const bData = (op->getInputs(1)->getRawDataPtr<void *>());
-        void *const cData = (op->getOutput()->getRawDataPtr<void *>());
-
-        //  create user memory that describes data layout in the buffers
-        std::vector<dnnl_dim_t> dims;
-        for (size_t i = 0; i < op->getInputs(0)->getRank(); ++i)
-            dims.push_back(op->getInputs(0)->getDims()[i]);
-
-        auto srcMd1 = dnnl::memory::desc(dims, dnnl::memory::data_type::f32,
-                                         getUserFormatTag(dims.size()));
-        auto srcMemory1 = dnnl::memory(srcMd1, context->getEngine(), aData);
-
-        auto srcMd2 = dnnl::memory::desc(dims, dnnl::memory::data_type::f32,
-                                         getUserFormatTag(dims.size()));
-        auto srcMemory2 = dnnl::memory(srcMd2, context->getEngine(), bData);
-
-        auto dstMd = dnnl::memory::desc(dims, dnnl::memory::data_type::f32,
-                                        getUserFormatTag(dims.size()));
-        auto output = dnnl::memory(dstMd, context->getEngine(), cData);
-
-        auto binaryDesc =
-            dnnl::binary::desc(getAlgorithem(op), srcMd1, srcMd2, dstMd);
-        auto primDesc =
-            dnnl::binary::primitive_desc(binaryDesc, context->getEngine());
-
-        // create and execute binary primitive
-        dnnl::binary(primDesc).execute(context->getStream(),
-                                       {{DNNL_ARG_SRC_0, srcMemory1},
-                                        {DNNL_ARG_SRC_1, srcMemory2},
-                                        {DNNL_ARG_DST, output}});
+        cache
+            .getOrCreate(MklPrimitiveCache::getKey(op),
+                         [&]() { return createPrimitives(op, context); })
+            ->execute(context->getStream());
     }
 };
 
@@ -1,9 +1,20 @@
 #include "operators/matmul.h"
 #include "core/kernel.h"
-#include "intelcpu/mkl_runtime.h"
+#include "intelcpu/mkl_kernel_without_config.h"
+#include "intelcpu/mkl_primitive_cache.h"
 
 namespace infini {
 template <typename T> class MklMatmul : public CpuKernelWithoutConfig {
+    // Batches are neither broadcast nor fused with a bias or an activation
+    bool isApplicable(const Operator &_op) const override {
+        auto op = as<MatmulObj>(_op);
+        auto dimsA = op->getInputs(0)->getDims(),
+             dimsB = op->getInputs(1)->getDims();
+        return op->getInputs().size() == 2 && op->getAct() == ActType::None &&
+               dimsA.size() == dimsB.size() &&
+               std::equal(dimsA.begin(), dimsA.end() - 2, dimsB.begin());
+    }
+
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
         auto op = as<MatmulObj>(_op);
@@ -31,7 +42,99 @@ template <typename T> class MklMatmul : public CpuKernelWithoutConfig {
     }
 };
 
-/*REGISTER_KERNEL(Device::INTELCPU, OpType::Matmul, DataType::Float32,
-                MklMatmul<float>, "MklMatmul_CPU_float32");*/
+class MklDnnMatmul : public MklKernelWithoutConfig {
+    mutable MklPrimitiveCache cache;
+
+    // Describe a row-major tensor padded to `rank` dims. The last two dims
+    // are swapped if `trans`.
+    static dnnl::memory::desc getMd(const Shape &shape, size_t rank,
+                                    bool trans) {
+        dnnl::memory::dims dims(rank, 1), strides(rank);
+        std::copy(shape.begin(), shape.end(), dims.end() - shape.size());
+        dnnl_dim_t stride = 1;
+        for (size_t i = rank; i-- > 0;) {
+            strides[i] = stride;
+            stride *= dims[i];
+        }
+        if (trans) {
+            std::swap(dims[rank - 1], dims[rank - 2]);
+            std::swap(strides[rank - 1], strides[rank - 2]);
+        }
+        return dnnl::memory::desc(dims, dnnl::memory::data_type::f32, strides);
+    }
+
+    MklPrimitives createPrimitives(const Ref<MatmulObj> &op,
+                                   const MklRuntimeObj *context) const {
+        auto a = op->getInputs(0), b = op->getInputs(1), bias = op->getBias(),
+             c = op->getOutput();
+        const size_t rank = c->getRank();
+        IT_ASSERT(a->getRank() >= 2 && b->getRank() >= 2);
+        auto engine = context->getEngine();
+
+        // Batch dims of size 1 are broadcast by the primitive
+        auto aMd = getMd(a->getDims(), rank, op->getTransA());
+        auto bMd = getMd(b->getDims(), rank, op->getTransB());
+        auto cMd = getMd(c->getDims(), rank, false);
+        // an empty descriptor means no bias
+        dnnl::memory::desc biasMd;
+        if (bias)
+            biasMd = getMd(bias->getDims(), rank, false);
+
+        dnnl::primitive_attr attr;
+        if (op->getAct() != ActType::None) {
+            dnnl::algorithm algo;
+            switch (op->getAct()) {
+            case ActType::Relu:
+                algo = dnnl::algorithm::eltwise_relu;
+                break;
+            case ActType::Sigmoid:
+                algo = dnnl::algorithm::eltwise_logistic;
+                break;
+            case ActType::Tanh:
+                algo = dnnl::algorithm::eltwise_tanh;
+                break;
+            default:
+                IT_TODO_HALT();
+            }
+            dnnl::post_ops po;
+            po.append_eltwise(1.f, algo, 0.f, 0.f);
+            attr.set_post_ops(po);
+        }
+        auto primDesc = dnnl::matmul::primitive_desc(
+            dnnl::matmul::desc(aMd, bMd, biasMd, cMd), attr, engine);
+
+        auto getMemory = [&](const dnnl::memory::desc &md,
+                             const Tensor &tensor) {
+            return dnnl::memory(md, engine, tensor->getRawDataPtr<void *>());
+        };
+        std::unordered_map<int, dnnl::memory> args{
+            {DNNL_ARG_SRC, getMemory(aMd, a)},
+            {DNNL_ARG_WEIGHTS, getMemory(bMd, b)},
+            {DNNL_ARG_DST, getMemory(cMd, c)}};
+        if (bias)
+            args[DNNL_ARG_BIAS] = getMemory(biasMd, bias);
+        auto prims = make_ref<MklPrimitivesObj>();
+        prims->add(dnnl::matmul(primDesc), args);
+        return prims;
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *_context) const override {
+        auto op = as<MatmulObj>(_op);
+        auto context = dynamic_cast<const MklRuntimeObj *>(_context);
+
+        cache
+            .getOrCreate(MklPrimitiveCache::getKey(op),
+                         [&]() { return createPrimitives(op, context); })
+            ->execute(context->getStream());
+    }
+};
+
+REGISTER_KERNEL(Device::INTELCPU, OpType::MatMul, DataType::Float32,
+                MklDnnMatmul, "MklDnnMatmul_CPU_float32");
+// An alternative to oneDNN that tuning chooses where cblas_sgemm is faster
+REGISTER_KERNEL_WITH_PRIORITY(Device::INTELCPU, OpType::MatMul,
+                              DataType::Float32, MklMatmul<float>,
+                              "MklMatmul_CPU_float32", -1);
 
 } // namespace infini
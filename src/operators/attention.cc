@@ -0,0 +1,92 @@
+#include "operators/attention.h"
+#include <cmath>
+#include <cstring>
+
+namespace infini {
+AttentionObj::AttentionObj(GraphObj *graph, Tensor query, Tensor key,
+                           Tensor value, Tensor output, Tensor mask,
+                           optional<float> _scale)
+    : OperatorObj(OpType::Attention,
+                  mask ? TensorVec{query, key, value, mask}
+                       : TensorVec{query, key, value},
+                  {output}) {
+    IT_ASSERT(query->getRank() >= 2);
+    scale = _scale ? *_scale
+                   : 1.f / std::sqrt(float(query->getDims().back()));
+    IT_ASSERT(checkValid(graph));
+}
+
+bool AttentionObj::isMaskShape(const Shape &mask, const Shape &scores) {
+    if (mask.size() > scores.size())
+        return false;
+    for (size_t i = 1; i <= mask.size(); ++i) {
+        const int d = mask[mask.size() - i];
+        if (d != 1 && d != scores[scores.size() - i])
+            return false;
+    }
+    return true;
+}
+
+optional<vector<Shape>>
+AttentionObj::inferShape(const TensorVec &inputs) const {
+    auto q = inputs[0]->getDims(), k = inputs[1]->getDims(),
+         v = inputs[2]->getDims();
+    const size_t rank = q.size();
+    if (k.size() != rank || v.size() != rank)
+        return {};
+    // The kernels read all inputs as the type of the query, and the mask as
+    // float32 scores to add
+    const auto dtype = inputs[0]->getDType();
+    if (!(inputs[1]->getDType() == dtype && inputs[2]->getDType() == dtype))
+        return {};
+    if (inputs.size() > 3 && !(inputs[3]->getDType() == DataType::Float32))
+        return {};
+    // The leading dims are not broadcast
+    for (size_t i = 0; i + 2 < rank; ++i)
+        if (k[i] != q[i] || v[i] != q[i])
+            return {};
+    if (k[rank - 1] != q[rank - 1] || v[rank - 2] != k[rank - 2])
+        return {};
+    Shape scores = q;
+    scores.back() = k[rank - 2];
+    if (inputs.size() > 3 && !isMaskShape(inputs[3]->getDims(), scores))
+        return {};
+    Shape ret = q;
+    ret.back() = v.back();
+    return {{ret}};
+}
+
+std::string AttentionObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(inputs[0]->getDims()) << ",";
+    os << vecToString(inputs[1]->getDims()) << ",";
+    os << vecToString(inputs[2]->getDims()) << ",";
+    os << "scale=" << scale << ",";
+    os << "query=" << inputs[0]->getGuid() << ",";
+    os << "key=" << inputs[1]->getGuid() << ",";
+    os << "value=" << inputs[2]->getGuid() << ",";
+    if (auto mask = getMask())
+        os << "mask=" << mask->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+vector<int> AttentionObj::getWorkloadVector() const {
+    vector<int> ret = inputs[0]->getDims();
+    ret.emplace(ret.begin(), type.underlying());
+    ret.emplace_back(inputs[1]->getDims().rbegin()[1]);
+    ret.emplace_back(inputs[2]->getDims().back());
+    ret.emplace_back(int(inputs.size()));
+    return ret;
+}
+
+vector<int> AttentionObj::getOpAttrVector() const {
+    // The bits of the scale, so that operators of other scales differ
+    int scaleBits;
+    static_assert(sizeof(scaleBits) == sizeof(scale));
+    std::memcpy(&scaleBits, &scale, sizeof(scale));
+    return {type.underlying(), int(inputs.size()), scaleBits};
+}
+} // namespace infini
@@ -79,4 +79,83 @@ vector<int> MSELossObj::getWorkloadVector() const {
 
 vector<int> MSELossObj::getOpAttrVector() const { return {type.underlying()}; }
 
+FusedElementWiseObj::FusedElementWiseObj(GraphObj *graph, TensorVec inputs,
+                                         Tensor output,
+                                         vector<Instruction> program)
+    : OperatorObj(OpType::FusedElementWise, inputs, {output}),
+      program(std::move(program)) {
+    IT_ASSERT(!this->program.empty());
+    IT_ASSERT((int)inputs.size() <= MAX_INPUTS);
+    for (size_t i = 0; i < this->program.size(); ++i) {
+        const auto &[opType, lhs, rhs] = this->program[i];
+        IT_ASSERT(isFusable(opType));
+        // Operands refer to inputs or to earlier instructions
+        for (int operand : {lhs, rhs})
+            IT_ASSERT(operand < (int)inputs.size() && ~operand < (int)i);
+    }
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>>
+FusedElementWiseObj::inferShape(const TensorVec &inputs) const {
+    Shape ret = inputs[0]->getDims();
+    for (size_t i = 1; i < inputs.size(); ++i)
+        ret = infer_broadcast(ret, inputs[i]->getDims());
+    return {{ret}};
+}
+
+std::string FusedElementWiseObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    for (const auto &[opType, lhs, rhs] : program) {
+        os << opType.toString() << "(" << lhs;
+        if (opType.isBinary())
+            os << "," << rhs;
+        os << "),";
+    }
+    for (size_t i = 0; i < inputs.size(); ++i)
+        os << "input" << i << "=" << inputs[i]->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+bool FusedElementWiseObj::isFusable(OpType type) {
+    switch (type.underlying()) {
+    case OpType::Add:
+    case OpType::Sub:
+    case OpType::Mul:
+    case OpType::Div:
+    case OpType::Relu:
+    case OpType::Sigmoid:
+    case OpType::Tanh:
+    case OpType::Abs:
+    case OpType::Sqrt:
+    case OpType::Neg:
+        return true;
+    default:
+        return false;
+    }
+}
+
+vector<int> FusedElementWiseObj::getWorkloadVector() const {
+    vector<int> ret = getOpAttrVector();
+    for (const auto &input : inputs) {
+        auto dims = input->getDims();
+        ret.emplace_back(dims.size());
+        ret.insert(ret.end(), dims.begin(), dims.end());
+    }
+    return ret;
+}
+
+vector<int> FusedElementWiseObj::getOpAttrVector() const {
+    vector<int> ret = {type.underlying()};
+    for (const auto &[opType, lhs, rhs] : program) {
+        ret.emplace_back(opType.underlying());
+        ret.emplace_back(lhs);
+        ret.emplace_back(rhs);
+    }
+    return ret;
+}
+
 }; // namespace infini
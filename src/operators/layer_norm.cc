@@ -0,0 +1,85 @@
+#include "operators/layer_norm.h"
+#include "utils/operator_utils.h"
+#include <cstring>
+
+namespace infini {
+LayerNormBaseObj::LayerNormBaseObj(GraphObj *graph, OpType opType,
+                                   TensorVec inputs, Tensor output, float eps,
+                                   int _axis)
+    : OperatorObj(opType, inputs, {output}), eps(eps) {
+    axis = get_real_axis(_axis, inputs[0]->getRank());
+    IT_ASSERT(checkValid(graph));
+}
+
+bool LayerNormBaseObj::isParamShape(const Shape &param,
+                                    const Shape &normalized) {
+    auto stripOnes = [](const Shape &shape) {
+        auto it = std::find_if(shape.begin(), shape.end(),
+                               [](int d) { return d != 1; });
+        return Shape(it, shape.end());
+    };
+    auto p = stripOnes(param);
+    return p.empty() || p == stripOnes(normalized);
+}
+
+optional<vector<Shape>>
+LayerNormBaseObj::inferShape(const TensorVec &inputs) const {
+    const auto dims = inputs[0]->getDims();
+    const Shape normalized(dims.begin() + axis, dims.end());
+    for (size_t i = 1; i < inputs.size(); ++i)
+        if (!isParamShape(inputs[i]->getDims(), normalized))
+            return {};
+    return {{dims}};
+}
+
+size_t LayerNormBaseObj::getNormalizedSize() const {
+    const auto dims = inputs[0]->getDims();
+    size_t size = 1;
+    for (size_t i = axis; i < dims.size(); ++i)
+        size *= dims[i];
+    return size;
+}
+
+std::string LayerNormBaseObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(inputs[0]->getDims()) << ",";
+    os << "axis=" << axis << ",";
+    os << "eps=" << eps << ",";
+    os << "input=" << inputs[0]->getGuid() << ",";
+    os << "scale=" << inputs[1]->getGuid() << ",";
+    if (auto bias = getBias())
+        os << "bias=" << bias->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+vector<int> LayerNormBaseObj::getWorkloadVector() const {
+    vector<int> ret = inputs[0]->getDims();
+    ret.emplace(ret.begin(), type.underlying());
+    ret.emplace_back(axis);
+    ret.emplace_back(int(inputs.size()));
+    return ret;
+}
+
+vector<int> LayerNormBaseObj::getOpAttrVector() const {
+    // The bits of epsilon, so that norms of other epsilons differ
+    int epsBits;
+    static_assert(sizeof(epsBits) == sizeof(eps));
+    std::memcpy(&epsBits, &eps, sizeof(eps));
+    return {type.underlying(), axis, int(inputs.size()), epsBits};
+}
+
+LayerNormObj::LayerNormObj(GraphObj *graph, Tensor input, Tensor scale,
+                           Tensor output, Tensor bias, float eps, int axis)
+    : LayerNormBaseObj(graph, OpType::LayerNormalization,
+                       bias ? TensorVec{input, scale, bias}
+                            : TensorVec{input, scale},
+                       output, eps, axis) {}
+
+RMSNormObj::RMSNormObj(GraphObj *graph, Tensor input, Tensor scale,
+                       Tensor output, float eps, int axis)
+    : LayerNormBaseObj(graph, OpType::RMSNorm, {input, scale}, output, eps,
+                       axis) {}
+} // namespace infini
@@ -1,4 +1,9 @@
 #include "utils/operator_utils.h"
+#include "core/operator.h"
+#include "operators/attention.h"
+#include "operators/conv.h"
+#include "operators/matmul.h"
+#include "operators/pooling.h"
 
 namespace infini {
 
@@ -41,4 +46,57 @@ int get_real_axis(const int &axis, const int &rank) {
     }
     return newAxis;
 }
+
+double get_flops(const Operator &op) {
+    const auto type = op->getOpType();
+    const double outputSize = op->getOutputs()[0]->size();
+    switch (type.underlying()) {
+    case OpType::MatMul: {
+        auto [b, m, n, k] = as<MatmulObj>(op)->getBMNK();
+        return 2.0 * b * m * n * k;
+    }
+    case OpType::Conv: {
+        auto conv = as<ConvBaseObj>(op);
+        auto [n, c, h, w, f, r, s] = conv->getNCHWFRS();
+        return 2.0 * outputSize * conv->getChannelPerGroup() * r * s;
+    }
+    case OpType::ConvTranspose:
+    case OpType::ConvTransNHWC: {
+        // Every input element is scattered to r * s * f / g outputs
+        auto conv = as<ConvBaseObj>(op);
+        auto [n, c, h, w, f, r, s] = conv->getNCHWFRS();
+        return 2.0 * op->getInputs(0)->size() * conv->getChannelPerGroup() * r *
+               s;
+    }
+    case OpType::Attention: {
+        // Q * K^T and P * V
+        auto dims = op->getInputs(1)->getDims();
+        return 2.0 * outputSize / dims.back() * dims.rbegin()[1] *
+               (dims.back() + op->getInputs(2)->getDims().back());
+    }
+    case OpType::MaxPool:
+    case OpType::AveragePool: {
+        auto pool = as<PoolingObj>(op);
+        return outputSize * pool->getKh() * pool->getKw();
+    }
+    default:
+        break;
+    }
+    if (type.isView() || type == OpType::Transpose || type == OpType::Slice ||
+        type == OpType::Concat || type == OpType::Split ||
+        type == OpType::Gather || type == OpType::Expand ||
+        type == OpType::Pad || type == OpType::Cast)
+        return 0;
+    // Reductions and normalizations read every input element
+    return std::max(outputSize, double(op->getInputs(0)->size()));
+}
+
+size_t get_io_bytes(const Operator &op) {
+    size_t bytes = 0;
+    for (auto &tensor : op->getInputs())
+        bytes += tensor->getBytes();
+    for (auto &tensor : op->getOutputs())
+        bytes += tensor->getBytes();
+    return bytes;
+}
 } // namespace infini
@@ -0,0 +1,85 @@
+#include "core/cost_model.h"
+#include "core/dummy_mutator.h"
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "core/search_engine.h"
+#include "operators/conv.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/reshape.h"
+#include "operators/unary.h"
+
+#include "test.h"
+#include <atomic>
+
+namespace infini {
+
+TEST(CostModel, Roofline) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor a = g->addTensor({64, 128}), b = g->addTensor({128, 32});
+    auto matmul = g->addOp<MatmulObj>(a, b, nullptr);
+    auto relu = g->addOp<ReluObj>(matmul->getOutput(), nullptr);
+    auto reshape = g->addOp<ReshapeObj>(relu->getOutput(), nullptr,
+                                        Shape{32, 64});
+    // 1 GFLOP/s and 1 GB/s are 1e6 per millisecond
+    auto model = make_ref<RooflineCostModelObj>(1, 1, 0.5);
+    const double matmulFlops = 2.0 * 64 * 32 * 128,
+                 matmulBytes = (64 * 128 + 128 * 32 + 64 * 32) * 4,
+                 reluBytes = 2 * 64 * 32 * 4;
+    EXPECT_DOUBLE_EQ(model->getCost(matmul), matmulFlops / 1e6 + 0.5);
+    EXPECT_DOUBLE_EQ(model->getCost(relu), reluBytes / 1e6 + 0.5);
+    auto memoryBound = make_ref<RooflineCostModelObj>(1e6, 1e-3);
+    EXPECT_DOUBLE_EQ(memoryBound->getCost(matmul), matmulBytes / 1e3);
+
+    // The Reshape does nothing once it shares the memory of its input
+    g->dataMalloc();
+    EXPECT_TRUE(reshape->isAliasedView());
+    EXPECT_DOUBLE_EQ(model->getCost(g),
+                     model->getCost(matmul) + model->getCost(relu));
+}
+
+TEST(CostModel, Calibrate) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto model = RooflineCostModelObj::calibrate(runtime);
+    EXPECT_GT(model->getPeakGflops(), 0);
+    EXPECT_GT(model->getBandwidthGBps(), 0);
+    EXPECT_GT(model->getOverheadMs(), 0);
+}
+
+// Counts the operators it has estimated
+class CountingCostModelObj : public RooflineCostModelObj {
+  public:
+    mutable std::atomic<int> numCalls = 0;
+    CountingCostModelObj() : RooflineCostModelObj(100, 10) {}
+    double getCost(const Operator &op) const override {
+        ++numCalls;
+        return RooflineCostModelObj::getCost(op);
+    }
+};
+
+TEST(CostModel, SearchWithFinalists) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    // DummyMutator gives two candidates for every Conv, so that there are
+    // 32 candidates after the fifth one
+    Tensor t = g->addTensor({1, 3, 16, 16});
+    for (int i = 0; i < 5; ++i) {
+        Tensor w = g->addTensor({3, 3, 3, 3});
+        t = g->addOp<ConvObj>(t, w, nullptr, 1, 1)->getOutput();
+        t = g->addOp<ReluObj>(t, nullptr)->getOutput();
+    }
+    g->dataMalloc();
+
+    SearchEngine searchEngine(runtime, make_ref<DummyMutator>(10));
+    auto model = make_ref<CountingCostModelObj>();
+    searchEngine.setCostModel(model, 16);
+    auto best = searchEngine.run(g);
+    EXPECT_GT(model->numCalls, 0);
+    ASSERT_NE(best, nullptr);
+    EXPECT_GE(best->getOperators().size(), 10u);
+    for (auto &tensor : best->getTensors())
+        EXPECT_TRUE(tensor->hasData());
+}
+
+} // namespace infini
@@ -0,0 +1,53 @@
+#include "core/execution_plan.h"
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(ExecutionPlan, ReuseAndInvalidate) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({3, 5, 7}, DataType::Float32);
+    auto y = g->addOp<ReluObj>(x, nullptr)->getOutput();
+    auto z = g->addOp<AddObj>(x, y, nullptr)->getOutput();
+    g->dataMalloc();
+    x->setData(IncrementalGenerator());
+
+    runtime->run(g);
+    auto plan = g->getExecutionPlan();
+    ASSERT_NE(plan, nullptr);
+    ASSERT_EQ(plan->steps.size(), 2u);
+    EXPECT_EQ(plan->steps[0].op, y->getSource());
+    EXPECT_EQ(plan->steps[1].op, z->getSource());
+    runtime->run(g);
+    EXPECT_EQ(g->getExecutionPlan(), plan);
+
+    // Records found by tuning are used by later runs of the same plan
+    runtime->run(g, true);
+    EXPECT_EQ(g->getExecutionPlan(), plan);
+    for (auto &step : plan->steps)
+        EXPECT_NE(step.record, nullptr);
+    runtime->run(g);
+    EXPECT_EQ(g->getExecutionPlan(), plan);
+    EXPECT_TRUE(z->equalData(vector<float>(
+        [] {
+            vector<float> ans(105);
+            for (int i = 0; i < 105; ++i)
+                ans[i] = 2 * i;
+            return ans;
+        }())));
+
+    g->dataMalloc();
+    EXPECT_EQ(g->getExecutionPlan(), nullptr);
+    runtime->run(g);
+    EXPECT_NE(g->getExecutionPlan(), nullptr);
+    g->addOp<ReluObj>(z, nullptr);
+    EXPECT_EQ(g->getExecutionPlan(), nullptr);
+}
+
+} // namespace infini
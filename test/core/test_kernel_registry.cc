@@ -0,0 +1,144 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/perf_engine.h"
+#include "core/profiler.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+// Kernels of Relu on int32 that fill the output with `Mark` and are timed as
+// taking `Time` ms, so that which of them runs can be told from the output
+template <int Mark, int Time> class MarkRelu : public CpuKernelWithoutConfig {
+    void compute(const Operator &op,
+                 const RuntimeObj *context) const override {
+        auto output = op->getOutput();
+        std::fill_n(output->getRawDataPtr<int32_t *>(), output->size(), Mark);
+    }
+    PerfRecord tune(const Operator &op,
+                    const RuntimeObj *context) const override {
+        return make_ref<PerfRecordObj>(Time);
+    }
+};
+
+using FastRelu = MarkRelu<2, 2>;
+using DefaultRelu = MarkRelu<1, 4>;
+// Only applicable to outputs of at most 4 elements
+class SmallRelu : public MarkRelu<3, 1> {
+    bool isApplicable(const Operator &op) const override {
+        return op->getOutput()->size() <= 4;
+    }
+};
+
+static const KernelAttrs reluInt32{Device::CPU, OpType::Relu,
+                                   DataType::Int32};
+
+} // namespace infini
+
+REGISTER_KERNEL_WITH_PRIORITY(Device::CPU, OpType::Relu, DataType::Int32,
+                              FastRelu, "FastRelu", 0);
+REGISTER_KERNEL_WITH_PRIORITY(Device::CPU, OpType::Relu, DataType::Int32,
+                              DefaultRelu, "DefaultRelu", 1);
+REGISTER_KERNEL_WITH_PRIORITY(Device::CPU, OpType::Relu, DataType::Int32,
+                              SmallRelu, "SmallRelu", 2);
+
+namespace infini {
+
+static std::pair<Graph, Tensor> buildRelu(Shape shape) {
+    Graph g = make_ref<GraphObj>(NativeCpuRuntimeObj::getInstance());
+    auto x = g->addTensor(shape, DataType::Int32);
+    auto y = g->addOp<ReluObj>(x, nullptr)->getOutput();
+    g->dataMalloc();
+    return {g, y};
+}
+
+TEST(KernelRegistry, Candidates) {
+    auto &registry = KernelRegistry::getInstance();
+    auto [small, smallOutput] = buildRelu({2, 2});
+    auto [large, largeOutput] = buildRelu({4, 4});
+    auto names = [&](const Graph &g) {
+        vector<string> ret;
+        for (auto item :
+             registry.getKernelItems(reluInt32, g->getOperators()[0]))
+            ret.emplace_back(std::get<1>(*item));
+        return ret;
+    };
+    EXPECT_EQ(names(small),
+              (vector<string>{"SmallRelu", "DefaultRelu", "FastRelu"}));
+    EXPECT_EQ(names(large), (vector<string>{"DefaultRelu", "FastRelu"}));
+    EXPECT_EQ(std::get<1>(registry.getKernelItem(reluInt32)), "SmallRelu");
+    EXPECT_NE(registry.getKernelItem(reluInt32, "FastRelu"), nullptr);
+    EXPECT_EQ(registry.getKernelItem(reluInt32, "NoRelu"), nullptr);
+}
+
+TEST(KernelRegistry, DispatchTunedKernel) {
+    auto runtime = NativeCpuRuntimeObj::getInstance();
+    auto &perfEngine = PerfEngine::getInstance();
+    perfEngine.clear();
+    auto [small, smallOutput] = buildRelu({2, 2});
+    auto [large, largeOutput] = buildRelu({4, 4});
+
+    // Without records, the applicable kernel of the highest priority runs
+    runtime->run(small);
+    runtime->run(large);
+    EXPECT_EQ(smallOutput->copyout<int32_t>(), vector<int32_t>(4, 3));
+    EXPECT_EQ(largeOutput->copyout<int32_t>(), vector<int32_t>(16, 1));
+
+    // Tuning times every applicable kernel and keeps the fastest per shape
+    runtime->run(large, true);
+    EXPECT_EQ(largeOutput->copyout<int32_t>(), vector<int32_t>(16, 2));
+    auto record = perfEngine.getPerfData(
+        {reluInt32, large->getOperators()[0]->getOpPerfKey()});
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(record->kernel, "FastRelu");
+    EXPECT_DOUBLE_EQ(record->time, 2);
+    runtime->run(small, true);
+    EXPECT_EQ(smallOutput->copyout<int32_t>(), vector<int32_t>(4, 3));
+
+    // The kernel is looked up again by later runs and after reloading
+    runtime->run(large);
+    EXPECT_EQ(largeOutput->copyout<int32_t>(), vector<int32_t>(16, 2));
+    json j = perfEngine;
+    perfEngine.clear();
+    runtime->run(large);
+    EXPECT_EQ(largeOutput->copyout<int32_t>(), vector<int32_t>(16, 1));
+    from_json(j, perfEngine);
+    runtime->run(large);
+    EXPECT_EQ(largeOutput->copyout<int32_t>(), vector<int32_t>(16, 2));
+
+    // The time of a graph is the time of the fastest kernels
+    auto [other, otherOutput] = buildRelu({8});
+    perfEngine.clear();
+    EXPECT_DOUBLE_EQ(runtime->getPerfTime(other), 2);
+}
+
+TEST(KernelRegistry, ProfileTunedKernel) {
+    auto runtime = NativeCpuRuntimeObj::getInstance();
+    auto &perfEngine = PerfEngine::getInstance();
+    auto &profiler = Profiler::getInstance();
+    auto lastKernel = [&](uint64_t since) {
+        auto events = profiler.getEvents(since);
+        EXPECT_FALSE(events.empty());
+        return events.empty() ? ""
+                              : profiler.getOpInfo(events.back().op).kernel;
+    };
+    profiler.enable();
+
+    // The events of a step name the kernel chosen by tuning in the same run
+    perfEngine.clear();
+    auto [g, output] = buildRelu({4, 4});
+    uint64_t since = profiler.getEventCount();
+    runtime->run(g, false, true);
+    EXPECT_EQ(lastKernel(since), "DefaultRelu");
+    since = profiler.getEventCount();
+    runtime->run(g, true, true);
+    EXPECT_EQ(lastKernel(since), "FastRelu");
+    since = profiler.getEventCount();
+    runtime->run(g, false, true);
+    EXPECT_EQ(lastKernel(since), "FastRelu");
+    profiler.disable();
+}
+
+} // namespace infini
@@ -1,6 +1,13 @@
+#include "core/execution_plan.h"
 #include "core/graph.h"
 #include "core/kernel.h"
 #include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/expand.h"
+#include "operators/matmul.h"
+#include "operators/reshape.h"
+#include "operators/slice.h"
+#include "operators/transpose.h"
 #include "operators/unary.h"
 
 #include "test.h"
@@ -93,4 +100,209 @@ TEST(LazyAllocator, testGetPtr) {
     EXPECT_EQ(ptr1, ptr2);
 }
 
+TEST(LazyAllocator, testPlan) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // a chain where each block overlaps its neighbours in time
+    vector<LazyAllocator::BlockLifetime> blocks = {
+        {64, 0, 1}, {32, 1, 2}, {64, 2, 3}, {32, 3, 4}, {8, 0, 4}};
+    for (auto strategy : {MemoryPlanStrategy::GreedyBySize,
+                          MemoryPlanStrategy::GreedyByBreadth}) {
+        LazyAllocator allocator = LazyAllocator(runtime);
+        auto offsets = allocator.plan(blocks, strategy);
+        EXPECT_EQ(allocator.getLowerBound(), 104u);
+        EXPECT_EQ(allocator.getPeak(), 104u);
+        // blocks live at the same step never overlap
+        for (size_t i = 0; i < blocks.size(); ++i)
+            for (size_t j = 0; j < i; ++j)
+                if (blocks[i].firstStep <= blocks[j].lastStep &&
+                    blocks[j].firstStep <= blocks[i].lastStep) {
+                    EXPECT_TRUE(offsets[i] + blocks[i].size <= offsets[j] ||
+                                offsets[j] + blocks[j].size <= offsets[i]);
+                }
+    }
+}
+
+TEST(LazyAllocator, testPlanGraphInplace) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({1, 2, 3, 4}, DataType::Float32);
+    auto a = g->addOp<ReluObj>(x, nullptr)->getOutput();
+    auto b = g->addOp<ReluObj>(a, nullptr)->getOutput();
+    auto c = g->addOp<AddObj>(a, b, nullptr)->getOutput();
+    auto d = g->addOp<ReluObj>(c, nullptr)->getOutput();
+    const size_t bytes = x->getBytes();
+
+    g->dataMalloc();
+    EXPECT_EQ(g->getAllocator().getPeak(), 3 * bytes);
+
+    // b reuses x, c overwrites a or b, and d overwrites c
+    g->setMemoryPlanStrategy(MemoryPlanStrategy::GreedyBySize);
+    g->dataMalloc();
+    EXPECT_EQ(g->getAllocator().getPeak(), 2 * bytes);
+    EXPECT_EQ(g->getAllocator().getLowerBound(), 2 * bytes);
+    EXPECT_EQ(x->getRawDataPtr<void *>(), b->getRawDataPtr<void *>());
+    EXPECT_EQ(c->getRawDataPtr<void *>(), d->getRawDataPtr<void *>());
+    x->copyin(vector<float>{-1, 2, -3, 4, -5, 6, -7, 8, -9, 10, -11, 12,
+                            -13, 14, -15, 16, -17, 18, -19, 20, -21, 22,
+                            -23, 24});
+    runtime->run(g);
+    EXPECT_TRUE(d->equalData(vector<float>{0,  4,  0,  8,  0,  12, 0,  16,
+                                           0,  20, 0,  24, 0,  28, 0,  32,
+                                           0,  36, 0,  40, 0,  44, 0,  48}));
+}
+
+TEST(LazyAllocator, testPlanGraphView) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({2, 3, 4}, DataType::Float32);
+    Tensor w = g->addTensor({6, 4}, DataType::Float32);
+    w->setWeight();
+    auto a = g->addOp<ReluObj>(x, nullptr)->getOutput();
+    auto r = g->addOp<ReshapeObj>(a, nullptr, Shape{6, 4})->getOutput();
+    auto v = g->addOp<IdentityObj>(w, nullptr)->getOutput();
+    auto b = g->addOp<AddObj>(r, v, nullptr)->getOutput();
+    auto c = g->addOp<FlattenObj>(b, nullptr, 0)->getOutput();
+    c->setOutput();
+
+    for (auto strategy :
+         {MemoryPlanStrategy::Online, MemoryPlanStrategy::GreedyBySize,
+          MemoryPlanStrategy::GreedyByBreadth}) {
+        g->setMemoryPlanStrategy(strategy);
+        g->dataMalloc();
+        EXPECT_EQ(r->getRawDataPtr<void *>(), a->getRawDataPtr<void *>());
+        EXPECT_EQ(c->getRawDataPtr<void *>(), b->getRawDataPtr<void *>());
+        // the weight lives in a memory space of its own and is copied
+        EXPECT_NE(v->getRawDataPtr<void *>(), w->getRawDataPtr<void *>());
+        if (strategy != MemoryPlanStrategy::Online) {
+            // b overwrites the block shared by a and r
+            EXPECT_EQ(b->getRawDataPtr<void *>(), a->getRawDataPtr<void *>());
+        }
+        x->copyin(vector<float>{-1, 2, -3, 4, -5, 6, -7, 8, -9, 10, -11, 12,
+                                -13, 14, -15, 16, -17, 18, -19, 20, -21, 22,
+                                -23, 24});
+        w->setData(OneGenerator());
+        runtime->run(g);
+        EXPECT_EQ(c->getDims(), (Shape{1, 24}));
+        EXPECT_TRUE(c->equalData(vector<float>{1, 3,  1, 5,  1, 7,  1, 9,
+                                               1, 11, 1, 13, 1, 15, 1, 17,
+                                               1, 19, 1, 21, 1, 23, 1, 25}));
+        // only Relu, Identity and Add are left to run
+        ASSERT_NE(g->getExecutionPlan(), nullptr);
+        EXPECT_EQ(g->getExecutionPlan()->steps.size(), 3u);
+    }
+}
+
+TEST(LazyAllocator, testPlanGraphStridedView) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({2, 3, 4}, DataType::Float32);
+    Tensor y = g->addTensor({2, 3, 5}, DataType::Float32);
+    Tensor z = g->addTensor({1, 5}, DataType::Float32);
+    auto a = g->addOp<ReluObj>(x, nullptr)->getOutput();
+    auto t = g->addOp<TransposeObj>(a, nullptr, vector<int>{0, 2, 1})
+                 ->getOutput();
+    auto m = g->addOp<MatmulObj>(t, y, nullptr)->getOutput();
+    auto s = g->addOp<SliceObj>(m, nullptr, vector<int>{1}, vector<int>{3},
+                                vector<int>{1}, std::nullopt)
+                 ->getOutput();
+    auto e = g->addOp<ExpandObj>(z, nullptr, Shape{2, 2, 5})->getOutput();
+    auto b = g->addOp<AddObj>(s, e, nullptr)->getOutput();
+    // Relu reads only contiguous inputs
+    auto u = g->addOp<TransposeObj>(b, nullptr, vector<int>{0, 2, 1})
+                 ->getOutput();
+    auto r = g->addOp<ReluObj>(u, nullptr)->getOutput();
+    r->setOutput();
+
+    vector<float> xData(x->size()), yData(y->size()), zData(z->size());
+    for (size_t i = 0; i < xData.size(); ++i)
+        xData[i] = i % 3 == 0 ? -float(i) : float(i);
+    for (size_t i = 0; i < yData.size(); ++i)
+        yData[i] = float(i % 7) - 3;
+    for (size_t i = 0; i < zData.size(); ++i)
+        zData[i] = float(i) * 10 - 20;
+    // r[n][q][p] = relu(sum_i relu(x[n][i][p + 1]) * y[n][i][q] + z[q])
+    vector<float> expected(r->size());
+    for (int n = 0; n < 2; ++n)
+        for (int q = 0; q < 5; ++q)
+            for (int p = 0; p < 2; ++p) {
+                float sum = zData[q];
+                for (int i = 0; i < 3; ++i)
+                    sum += std::max(0.f, xData[n * 12 + i * 4 + p + 1]) *
+                           yData[n * 15 + i * 5 + q];
+                expected[n * 10 + q * 2 + p] = std::max(0.f, sum);
+            }
+
+    for (auto strategy :
+         {MemoryPlanStrategy::Online, MemoryPlanStrategy::GreedyBySize,
+          MemoryPlanStrategy::GreedyByBreadth}) {
+        g->setMemoryPlanStrategy(strategy);
+        g->dataMalloc();
+        EXPECT_TRUE(t->isStrided());
+        EXPECT_TRUE(s->isStrided());
+        EXPECT_TRUE(e->isStrided());
+        EXPECT_FALSE(u->isStrided());
+        EXPECT_EQ(t->getStride(), (Shape{12, 1, 4}));
+        EXPECT_EQ(e->getStride(), (Shape{0, 0, 1}));
+        EXPECT_EQ(t->getRawDataPtr<void *>(), a->getRawDataPtr<void *>());
+        EXPECT_EQ(s->getRawDataPtr<float *>(), m->getRawDataPtr<float *>() + 5);
+        EXPECT_EQ(e->getRawDataPtr<void *>(), z->getRawDataPtr<void *>());
+        x->copyin(xData);
+        y->copyin(yData);
+        z->copyin(zData);
+        runtime->run(g);
+        EXPECT_TRUE(r->equalData(expected));
+        // the first Transpose, the Slice and the Expand are skipped
+        ASSERT_NE(g->getExecutionPlan(), nullptr);
+        EXPECT_EQ(g->getExecutionPlan()->steps.size(), 5u);
+    }
+}
+
+TEST(LazyAllocator, testPlanCache) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({2, 3}, DataType::Float32);
+    Tensor y = g->addTensor({3}, DataType::Float32);
+    auto a = g->addOp<ReluObj>(x, nullptr)->getOutput();
+    auto b = g->addOp<AddObj>(a, y, nullptr)->getOutput();
+    auto c = g->addOp<ReluObj>(b, nullptr)->getOutput();
+    const auto &allocator = g->getAllocator();
+    auto getOffsets = [&]() {
+        vector<size_t> ret;
+        for (auto &t : {x, y, a, b, c})
+            ret.emplace_back(t->getRawDataPtr<uint8_t *>() -
+                             static_cast<uint8_t *>(allocator.ptr));
+        return ret;
+    };
+
+    g->dataMalloc();
+    auto smallOffsets = getOffsets();
+    auto smallPeak = allocator.getPeak();
+
+    x->setShape({8, 3});
+    g->shape_infer();
+    EXPECT_EQ(c->getDims(), (Shape{8, 3}));
+    g->dataMalloc();
+    void *largePtr = allocator.ptr;
+    auto largeOffsets = getOffsets();
+    EXPECT_GT(allocator.getPeak(), smallPeak);
+
+    // the cached plan is restored into the larger buffer
+    x->setShape({2, 3});
+    g->shape_infer();
+    g->dataMalloc();
+    EXPECT_EQ(allocator.ptr, largePtr);
+    EXPECT_EQ(allocator.getPeak(), smallPeak);
+    EXPECT_EQ(getOffsets(), smallOffsets);
+    x->copyin(vector<float>{-1, 2, -3, 4, -5, 6});
+    y->copyin(vector<float>{1, -3, 1});
+    runtime->run(g);
+    EXPECT_TRUE(c->equalData(vector<float>{1, 0, 1, 5, 0, 7}));
+
+    x->setShape({8, 3});
+    g->shape_infer();
+    g->dataMalloc();
+    EXPECT_EQ(allocator.ptr, largePtr);
+    EXPECT_EQ(getOffsets(), largeOffsets);
+}
+
 } // namespace infini
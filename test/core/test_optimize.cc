@@ -0,0 +1,407 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/attention.h"
+#include "operators/batch_norm.h"
+#include "operators/conv.h"
+#include "operators/element_wise.h"
+#include "operators/layer_norm.h"
+#include "operators/matmul.h"
+#include "operators/reduce.h"
+#include "operators/softmax.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include "test.h"
+
+namespace infini {
+
+static void expectNear(const Tensor &tensor, const vector<float> &ans) {
+    auto data = tensor->copyout<float>();
+    ASSERT_EQ(data.size(), ans.size());
+    for (size_t i = 0; i < ans.size(); ++i)
+        EXPECT_NEAR(data[i], ans[i], 1e-5);
+}
+
+TEST(Optimize, FuseElementWise) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({2, 3, 7}, DataType::Float32);
+    Tensor y = g->addTensor({2, 3, 7}, DataType::Float32);
+    Tensor z = g->addTensor({1, 7}, DataType::Float32);
+    auto t0 = g->addOp<AddObj>(x, y, nullptr)->getOutput();
+    auto t1 = g->addOp<ReluObj>(t0, nullptr)->getOutput();
+    auto t2 = g->addOp<MulObj>(t1, z, nullptr)->getOutput();
+    auto out = g->addOp<SigmoidObj>(t2, nullptr)->getOutput();
+    auto setInputs = [&]() {
+        x->setData(RandomGenerator(-1, 1, 0));
+        y->setData(RandomGenerator(-1, 1, 1));
+        z->setData(RandomGenerator(-1, 1, 2));
+    };
+    g->dataMalloc();
+    setInputs();
+    runtime->run(g);
+    auto ans = out->copyout<float>();
+
+    g->optimize();
+    ASSERT_EQ(g->getOperators().size(), 1u);
+    auto fused = g->getOperators()[0];
+    EXPECT_EQ(fused->getOpType(), OpType::FusedElementWise);
+    EXPECT_EQ(fused->numInputs(), 3);
+    EXPECT_EQ(fused->getOutput(), out);
+    EXPECT_EQ(g->getTensors().size(), 4u);
+    EXPECT_TRUE(g->checkValid());
+
+    g->dataMalloc();
+    setInputs();
+    runtime->run(g);
+    expectNear(out, ans);
+}
+
+TEST(Optimize, KeepSharedIntermediate) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({4, 5}, DataType::Float32);
+    auto t0 = g->addOp<AbsObj>(x, nullptr)->getOutput();
+    // t0 is also read by Neg, so Abs cannot be fused into the chain
+    auto t1 = g->addOp<SqrtObj>(t0, nullptr)->getOutput();
+    auto out0 = g->addOp<AddObj>(t0, t1, nullptr)->getOutput();
+    auto out1 = g->addOp<NegObj>(t0, nullptr)->getOutput();
+    g->optimize();
+    EXPECT_EQ(g->getOperators().size(), 3u);
+    EXPECT_EQ(t0->getSource()->getOpType(), OpType::Abs);
+    EXPECT_EQ(out0->getSource()->getOpType(), OpType::FusedElementWise);
+    EXPECT_EQ(out0->getSource()->getInputs(), TensorVec{t0});
+    EXPECT_TRUE(g->checkValid());
+
+    g->dataMalloc();
+    x->copyin(vector<float>{-4, 9, 16, -1, 0, 1, 4, -9, 25, 36,
+                            1,  1, 1,  1,  1, 1, 1, 1,  1,  1});
+    runtime->run(g);
+    EXPECT_TRUE(out0->equalData(vector<float>{6, 12, 20, 2, 0, 2, 6, 12, 30,
+                                              42, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+                                              2}));
+    EXPECT_TRUE(out1->equalData(vector<float>{-4, -9, -16, -1, 0,  -1, -4,
+                                              -9, -25, -36, -1, -1, -1, -1,
+                                              -1, -1, -1, -1, -1, -1}));
+}
+
+TEST(Optimize, FuseMatmulBiasAndActivation) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor a = g->addTensor({2, 3, 4}, DataType::Float32);
+    Tensor b = g->addTensor({4, 5}, DataType::Float32);
+    Tensor bias = g->addTensor({5}, DataType::Float32);
+    auto t0 = g->addOp<MatmulObj>(a, b, nullptr)->getOutput();
+    auto t1 = g->addOp<AddObj>(bias, t0, nullptr)->getOutput();
+    auto out = g->addOp<ReluObj>(t1, nullptr)->getOutput();
+    auto setInputs = [&]() {
+        a->setData(RandomGenerator(-1, 1, 0));
+        b->setData(RandomGenerator(-1, 1, 1));
+        bias->setData(RandomGenerator(-1, 1, 2));
+    };
+    g->dataMalloc();
+    setInputs();
+    runtime->run(g);
+    auto ans = out->copyout<float>();
+
+    g->optimize();
+    ASSERT_EQ(g->getOperators().size(), 1u);
+    auto matmul = as<MatmulObj>(g->getOperators()[0]);
+    EXPECT_EQ(matmul->getBias(), bias);
+    EXPECT_EQ(matmul->getAct(), ActType::Relu);
+    EXPECT_EQ(matmul->getOutput(), out);
+
+    g->dataMalloc();
+    setInputs();
+    runtime->run(g);
+    expectNear(out, ans);
+}
+
+TEST(Optimize, FoldBatchNormIntoConv) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    const int c = 3, f = 4;
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor input = g->addTensor({1, c, 5, 5}, DataType::Float32);
+    Tensor weight = g->addTensor({f, c, 3, 3}, DataType::Float32);
+    TensorVec params;
+    for (int i = 0; i < 4; ++i)
+        params.emplace_back(g->addTensor({f}, DataType::Float32));
+    for (auto &t : params)
+        t->setWeight();
+    weight->setWeight();
+    auto t0 = g->addOp<ConvObj>(input, weight, nullptr, 1, 1)->getOutput();
+    auto t1 = g->addOp<BatchNormObj>(t0, nullptr, params[0], params[1],
+                                     params[2], params[3])
+                  ->getOutput();
+    auto out = g->addOp<ReluObj>(t1, nullptr)->getOutput();
+    g->dataMalloc();
+    input->setData(RandomGenerator(-1, 1, 0));
+    weight->setData(RandomGenerator(-1, 1, 1));
+    vector<float> mean{0.5, -0.5, 0, 1}, var{1, 2, 0.5, 4},
+        scale{1, -1, 2, 0.5}, shift{0, 1, -1, 0.25};
+    params[0]->copyin(mean);
+    params[1]->copyin(var);
+    params[2]->copyin(scale);
+    params[3]->copyin(shift);
+
+    // The reference of the convolution, before the weight is scaled
+    Graph ref = make_ref<GraphObj>(runtime);
+    auto refInput = ref->cloneTensor(input);
+    auto refWeight = ref->cloneTensor(weight);
+    auto refOut =
+        ref->addOp<ConvObj>(refInput, refWeight, nullptr, 1, 1)->getOutput();
+    ref->dataMalloc();
+    refInput->copyData(input);
+    refWeight->copyData(weight);
+    runtime->run(ref);
+    auto ans = refOut->copyout<float>();
+    const size_t spatial = ans.size() / f;
+    for (size_t i = 0; i < ans.size(); ++i) {
+        const int ch = i / spatial;
+        float v = (ans[i] - mean[ch]) / std::sqrt(var[ch] + 1e-5f) * scale[ch] +
+                  shift[ch];
+        ans[i] = std::max(v, 0.f);
+    }
+
+    g->optimize();
+    ASSERT_EQ(g->getOperators().size(), 1u);
+    auto conv = as<ConvObj>(g->getOperators()[0]);
+    EXPECT_EQ(conv->getBias(), params[3]);
+    EXPECT_EQ(conv->getAct(), ActType::Relu);
+    EXPECT_EQ(conv->getOutput(), out);
+    EXPECT_EQ(g->getTensors().size(), 4u);
+
+    g->dataMalloc();
+    input->copyData(refInput);
+    runtime->run(g);
+    expectNear(out, ans);
+}
+
+TEST(Optimize, FuseLayerNorm) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({2, 3, 8}, DataType::Float32);
+    Tensor two = g->addTensor({1}, DataType::Float32);
+    Tensor eps = g->addTensor({1}, DataType::Float32);
+    Tensor scale = g->addTensor({8}, DataType::Float32);
+    Tensor bias = g->addTensor({8}, DataType::Float32);
+    for (auto &t : {two, eps, scale, bias})
+        t->setWeight();
+    // As exported from PyTorch
+    auto mean = g->addOp<ReduceMeanObj>(x, nullptr, vector<int>{-1}, true)
+                    ->getOutput();
+    auto d = g->addOp<SubObj>(x, mean, nullptr)->getOutput();
+    auto sq = g->addOp<PowObj>(d, two, nullptr)->getOutput();
+    auto var = g->addOp<ReduceMeanObj>(sq, nullptr, vector<int>{-1}, true)
+                   ->getOutput();
+    auto ve = g->addOp<AddObj>(var, eps, nullptr)->getOutput();
+    auto stddev = g->addOp<SqrtObj>(ve, nullptr)->getOutput();
+    auto norm = g->addOp<DivObj>(d, stddev, nullptr)->getOutput();
+    auto y = g->addOp<MulObj>(norm, scale, nullptr)->getOutput();
+    auto z = g->addOp<AddObj>(y, bias, nullptr)->getOutput();
+    auto out = g->addOp<ReluObj>(z, nullptr)->getOutput();
+    auto setInputs = [&]() {
+        x->setData(RandomGenerator(-1, 1, 0));
+        scale->setData(RandomGenerator(-1, 1, 1));
+        bias->setData(RandomGenerator(-1, 1, 2));
+    };
+    g->dataMalloc();
+    setInputs();
+    two->copyin(vector<float>{2});
+    eps->copyin(vector<float>{1e-5});
+    runtime->run(g);
+    auto ans = out->copyout<float>();
+
+    g->optimize();
+    ASSERT_EQ(g->getOperators().size(), 2u);
+    auto layerNorm = as<LayerNormObj>(z->getSource());
+    ASSERT_EQ(layerNorm->getOpType(), OpType::LayerNormalization);
+    EXPECT_EQ(layerNorm->getInputs(), (TensorVec{x, scale, bias}));
+    EXPECT_EQ(layerNorm->getAxis(), 2);
+    EXPECT_FLOAT_EQ(layerNorm->getEps(), 1e-5);
+    EXPECT_EQ(g->getTensors().size(), 5u);
+    EXPECT_TRUE(g->checkValid());
+
+    g->dataMalloc();
+    setInputs();
+    runtime->run(g);
+    expectNear(out, ans);
+}
+
+TEST(Optimize, FuseRMSNorm) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // x / sqrt(mean(x^2) + eps) * scale, where the root mean square is also
+    // read outside the chain if `shareRms`
+    auto build = [&](bool shareRms) {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({4, 16}, DataType::Float32);
+        Tensor two = g->addTensor({1}, DataType::Float32);
+        Tensor eps = g->addTensor({1}, DataType::Float32);
+        Tensor scale = g->addTensor({16}, DataType::Float32);
+        for (auto &t : {two, eps, scale})
+            t->setWeight();
+        auto sq = g->addOp<PowObj>(x, two, nullptr)->getOutput();
+        auto ms = g->addOp<ReduceMeanObj>(sq, nullptr, vector<int>{1}, true)
+                      ->getOutput();
+        auto mse = g->addOp<AddObj>(ms, eps, nullptr)->getOutput();
+        auto rms = g->addOp<SqrtObj>(mse, nullptr)->getOutput();
+        auto norm = g->addOp<DivObj>(x, rms, nullptr)->getOutput();
+        auto out = g->addOp<MulObj>(norm, scale, nullptr)->getOutput();
+        if (shareRms)
+            g->addOp<DivObj>(rms, x, nullptr);
+        g->dataMalloc();
+        x->setData(RandomGenerator(-1, 1, 0));
+        scale->setData(RandomGenerator(-1, 1, 1));
+        two->copyin(vector<float>{2});
+        eps->copyin(vector<float>{1e-6});
+        return std::make_tuple(g, x, scale, out);
+    };
+    {
+        auto [g, x, scale, out] = build(true);
+        g->optimize();
+        EXPECT_NE(out->getSource()->getOpType(), OpType::RMSNorm);
+    }
+    auto [g, x, scale, out] = build(false);
+    runtime->run(g);
+    auto ans = out->copyout<float>();
+
+    g->optimize();
+    ASSERT_EQ(g->getOperators().size(), 1u);
+    EXPECT_EQ(out->getSource()->getOpType(), OpType::RMSNorm);
+    EXPECT_EQ(out->getSource()->getInputs(), (TensorVec{x, scale}));
+    EXPECT_TRUE(g->checkValid());
+
+    g->dataMalloc();
+    x->setData(RandomGenerator(-1, 1, 0));
+    scale->setData(RandomGenerator(-1, 1, 1));
+    runtime->run(g);
+    expectNear(out, ans);
+}
+
+TEST(Optimize, FuseAttention) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // softmax(q * transpose(k) / sqrt(d) + mask) * v
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor q = g->addTensor({2, 3, 10, 16}, DataType::Float32);
+    Tensor k = g->addTensor({2, 3, 12, 16}, DataType::Float32);
+    Tensor v = g->addTensor({2, 3, 12, 8}, DataType::Float32);
+    Tensor mask = g->addTensor({2, 1, 1, 12}, DataType::Float32);
+    Tensor root = g->addTensor({1}, DataType::Float32);
+    root->setWeight();
+    auto kt = g->addOp<TransposeObj>(k, nullptr, vector<int>{0, 1, 3, 2})
+                  ->getOutput();
+    auto qk = g->addOp<MatmulObj>(q, kt, nullptr)->getOutput();
+    auto scaled = g->addOp<DivObj>(qk, root, nullptr)->getOutput();
+    auto masked = g->addOp<AddObj>(scaled, mask, nullptr)->getOutput();
+    auto probs = g->addOp<SoftmaxObj>(masked, nullptr, 3)->getOutput();
+    auto out = g->addOp<MatmulObj>(probs, v, nullptr)->getOutput();
+    auto setData = [&]() {
+        q->setData(RandomGenerator(-1, 1, 0));
+        k->setData(RandomGenerator(-1, 1, 1));
+        v->setData(RandomGenerator(-1, 1, 2));
+        mask->setData(RandomGenerator(-4, 0, 3));
+    };
+    g->dataMalloc();
+    setData();
+    root->copyin(vector<float>{4});
+    runtime->run(g);
+    auto ans = out->copyout<float>();
+
+    g->optimize();
+    ASSERT_EQ(g->getOperators().size(), 1u);
+    auto op = as<AttentionObj>(out->getSource());
+    ASSERT_EQ(op->getOpType(), OpType::Attention);
+    EXPECT_EQ(op->getInputs(), (TensorVec{q, k, v, mask}));
+    EXPECT_FLOAT_EQ(op->getScale(), 0.25);
+    EXPECT_TRUE(g->checkValid());
+
+    g->dataMalloc();
+    setData();
+    runtime->run(g);
+    expectNear(out, ans);
+}
+
+TEST(FoldConstants, FoldWeights) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({2, 3}, DataType::Float32);
+    Tensor w0 = g->addTensor({2, 3}, DataType::Float32);
+    Tensor w1 = g->addTensor({3}, DataType::Float32);
+    w0->setWeight();
+    w1->setWeight();
+    auto t0 = g->addOp<SubObj>(w0, w1, nullptr)->getOutput();
+    auto t1 = g->addOp<ReluObj>(t0, nullptr)->getOutput();
+    auto out = g->addOp<MulObj>(x, t1, nullptr)->getOutput();
+    out->setOutput();
+    g->dataMalloc();
+    w0->copyin(vector<float>{1, 2, 3, 4, 5, 6});
+    w1->copyin(vector<float>{2, 2, 2});
+
+    g->foldConstants();
+    ASSERT_EQ(g->getOperators().size(), 1u);
+    EXPECT_EQ(out->getSource()->getInputs(), (TensorVec{x, t1}));
+    EXPECT_TRUE(t1->isWeight());
+    EXPECT_EQ(t1->getSource(), nullptr);
+    EXPECT_EQ(g->getTensors().size(), 3u);
+    EXPECT_TRUE(g->checkValid());
+
+    g->dataMalloc();
+    x->copyin(vector<float>{1, 1, 1, 2, 2, 2});
+    runtime->run(g);
+    EXPECT_TRUE(out->equalData(vector<float>{0, 0, 1, 4, 6, 8}));
+}
+
+TEST(FoldConstants, FoldShape) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({2, 3, 4}, DataType::Float32);
+    Tensor y = g->addTensor({3}, DataType::Float32);
+    Tensor w = g->addTensor({3}, DataType::Float32);
+    x->setInput();
+    y->setInput();
+    w->setWeight();
+    auto shape = g->addOp<ShapeObj>(x, nullptr)->getOutput();
+    auto t0 = g->addOp<AddObj>(shape, w, nullptr)->getOutput();
+    auto out0 = g->addOp<ReluObj>(x, nullptr)->getOutput();
+    auto out1 = g->addOp<MulObj>(t0, y, nullptr)->getOutput();
+    out0->setOutput();
+    out1->setOutput();
+    g->dataMalloc();
+    w->copyin(vector<float>{1, 1, 1});
+
+    g->foldConstants();
+    ASSERT_EQ(g->getOperators().size(), 2u);
+    EXPECT_EQ(out1->getSource()->getInputs(0), t0);
+    EXPECT_TRUE(t0->isWeight());
+    EXPECT_TRUE(t0->equalData(vector<float>{3, 4, 5}));
+    EXPECT_EQ(g->getTensors().size(), 5u);
+    EXPECT_TRUE(g->checkValid());
+
+    g->dataMalloc();
+    x->setData(RandomGenerator(-1, 1, 0));
+    y->copyin(vector<float>{1, 2, 3});
+    runtime->run(g);
+    EXPECT_TRUE(out1->equalData(vector<float>{3, 8, 15}));
+}
+
+TEST(FoldConstants, EliminateDeadCode) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({2, 3}, DataType::Float32);
+    Tensor w = g->addTensor({2, 3}, DataType::Float32);
+    w->setWeight();
+    auto t0 = g->addOp<AddObj>(x, w, nullptr)->getOutput();
+    auto out = g->addOp<ReluObj>(t0, nullptr)->getOutput();
+    // Only reachable from tensors that are not graph outputs
+    auto t1 = g->addOp<SigmoidObj>(t0, nullptr)->getOutput();
+    g->addOp<AbsObj>(t1, nullptr);
+    g->addOp<NegObj>(w, nullptr);
+    out->setOutput();
+
+    g->foldConstants();
+    EXPECT_EQ(g->getOperators().size(), 2u);
+    EXPECT_EQ(g->getTensors().size(), 4u);
+    EXPECT_EQ(t0->getTargets().size(), 1u);
+    EXPECT_TRUE(g->checkValid());
+}
+
+} // namespace infini
@@ -0,0 +1,139 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/perf_engine.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/unary.h"
+
+#include "test.h"
+#include <atomic>
+#include <thread>
+
+namespace infini {
+
+// Kernels of Relu and Abs on int64, where Relu fails and Abs counts its runs
+class FailingRelu : public CpuKernelWithoutConfig {
+    void compute(const Operator &op,
+                 const RuntimeObj *context) const override {
+        throw std::runtime_error("FailingRelu");
+    }
+};
+
+static std::atomic<int> numCountingAbsRuns{0};
+class CountingAbs : public CpuKernelWithoutConfig {
+    void compute(const Operator &op,
+                 const RuntimeObj *context) const override {
+        ++numCountingAbsRuns;
+    }
+};
+
+} // namespace infini
+
+REGISTER_KERNEL(Device::CPU, OpType::Relu, DataType::Int64, FailingRelu,
+                "FailingRelu");
+REGISTER_KERNEL(Device::CPU, OpType::Abs, DataType::Int64, CountingAbs,
+                "CountingAbs");
+
+namespace infini {
+
+// Builds several branches of different lengths from one input and sums them
+// up, so that branches run concurrently and reuse each other's memory.
+static Tensor buildBranches(Graph g, Tensor x, int numBranches) {
+    Tensor sum;
+    for (int i = 0; i < numBranches; ++i) {
+        auto w = g->addTensor({64, 64}, DataType::Float32);
+        w->setWeight();
+        Tensor t = g->addOp<MatmulObj>(x, w, nullptr)->getOutput();
+        for (int j = 0; j < i; ++j) {
+            t = g->addOp<ReluObj>(t, nullptr)->getOutput();
+            t = g->addOp<AddObj>(t, x, nullptr)->getOutput();
+        }
+        sum = sum ? g->addOp<AddObj>(sum, t, nullptr)->getOutput() : t;
+    }
+    return sum;
+}
+
+TEST(ParallelRun, SameAsSerial) {
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    for (auto strategy :
+         {MemoryPlanStrategy::Online, MemoryPlanStrategy::GreedyBySize}) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor({32, 64}, DataType::Float32);
+        auto y = buildBranches(g, x, 6);
+        g->setMemoryPlanStrategy(strategy);
+        g->dataMalloc();
+        for (auto &t : g->getTensors())
+            if (t->isWeight())
+                t->setData(RandomGenerator(-0.1, 0.1, t->getGuid()));
+
+        x->setData(RandomGenerator(-1, 1, 0));
+        runtime->run(g);
+        auto serial = y->copyout<float>();
+
+        runtime->setParallelism(4, 1);
+        for (int i = 0; i < 10; ++i) {
+            x->setData(RandomGenerator(-1, 1, 0));
+            runtime->run(g);
+            EXPECT_EQ(y->copyout<float>(), serial);
+        }
+        runtime->setParallelism(1);
+    }
+}
+
+TEST(ParallelRun, ConcurrentGraphsWithTuning) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    constexpr int numGraphs = 4;
+    vector<Graph> graphs;
+    vector<Tensor> inputs, outputs;
+    vector<vector<float>> expected;
+    for (int i = 0; i < numGraphs; ++i) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor({32, 64}, DataType::Float32);
+        inputs.push_back(x);
+        outputs.push_back(buildBranches(g, x, 3));
+        g->dataMalloc();
+        int seed = 0;
+        for (auto &t : g->getTensors())
+            if (t->isWeight())
+                t->setData(RandomGenerator(-0.1, 0.1, i * 100 + seed++));
+        x->setData(RandomGenerator(-1, 1, i));
+        runtime->run(g);
+        expected.push_back(outputs.back()->copyout<float>());
+        graphs.push_back(g);
+    }
+
+    // The graphs share the keys of their operators, which are tuned once
+    // while the graphs run concurrently
+    PerfEngine::getInstance().clear();
+    vector<std::thread> threads;
+    for (int i = 0; i < numGraphs; ++i)
+        threads.emplace_back([&, i]() {
+            // The input may be overwritten by the last operator using it
+            for (int j = 0; j < 3; ++j) {
+                inputs[i]->setData(RandomGenerator(-1, 1, i));
+                runtime->run(graphs[i], true);
+            }
+        });
+    for (auto &thread : threads)
+        thread.join();
+    for (int i = 0; i < numGraphs; ++i)
+        EXPECT_EQ(outputs[i]->copyout<float>(), expected[i]);
+    EXPECT_EQ(PerfEngine::getInstance().size(), 3u);
+}
+
+TEST(ParallelRun, StopAfterException) {
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    runtime->setParallelism(2, 1);
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({4}, DataType::Int64);
+    auto y = g->addOp<ReluObj>(x, nullptr)->getOutput();
+    g->addOp<AbsObj>(y, nullptr);
+    g->dataMalloc();
+    numCountingAbsRuns = 0;
+    EXPECT_THROW(runtime->run(g), std::runtime_error);
+    // Abs would read the output that Relu never computed
+    EXPECT_EQ(numCountingAbsRuns, 0);
+}
+
+} // namespace infini
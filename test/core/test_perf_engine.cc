@@ -0,0 +1,256 @@
+#include "core/perf_engine.h"
+#include "cpu/cpu_conv.h"
+
+#include "nlohmann/json.hpp"
+#include "test.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace infini {
+
+static PerfEngine::Key makeKey(OpType opType, HashType hash,
+                               vector<int> attrs = {}) {
+    return {KernelAttrs{Device::CPU, opType.underlying(), DataType::Float32},
+            OpPerfKey(hash, opType, std::move(attrs))};
+}
+
+static string readFile(const string &path) {
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream os;
+    os << file.rdbuf();
+    return os.str();
+}
+
+static void writeFile(const string &path, const string &content) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+TEST(PerfEngine, KeepFastestRecord) {
+    auto &perfEngine = PerfEngine::getInstance();
+    perfEngine.clear();
+    auto key = makeKey(OpType::Relu, 7);
+    EXPECT_TRUE(perfEngine.setPerfData(key, make_ref<PerfRecordObj>(2.5)));
+    const size_t version = perfEngine.getVersion();
+    EXPECT_FALSE(perfEngine.setPerfData(key, make_ref<PerfRecordObj>(3.0)));
+    EXPECT_EQ(perfEngine.getVersion(), version);
+    EXPECT_TRUE(perfEngine.setPerfData(key, make_ref<PerfRecordObj>(1.25)));
+    EXPECT_GT(perfEngine.getVersion(), version);
+    EXPECT_DOUBLE_EQ(perfEngine.getPerfData(key)->time, 1.25);
+    EXPECT_EQ(perfEngine.size(), 1u);
+    // Keys differing only in attrs or data type are different records
+    EXPECT_EQ(perfEngine.getPerfData(makeKey(OpType::Relu, 7, {1})), nullptr);
+    auto halfKey = key;
+    std::get<2>(halfKey.first) = DataType::Float16;
+    EXPECT_EQ(perfEngine.getPerfData(halfKey), nullptr);
+
+    // Times survive the JSON round trip without truncation
+    json j = perfEngine;
+    perfEngine.clear();
+    from_json(j, perfEngine);
+    EXPECT_DOUBLE_EQ(perfEngine.getPerfData(key)->time, 1.25);
+}
+
+TEST(PerfEngine, SaveAndLoad) {
+    const string path = "test_perf_engine_save.bin";
+    std::remove(path.c_str());
+    auto &perfEngine = PerfEngine::getInstance();
+    perfEngine.clear();
+    auto reluKey = makeKey(OpType::Relu, 1);
+    auto convKey = makeKey(OpType::Conv, 2, {1, 3, 224, 224});
+    auto convRecord = make_ref<ConvCpuPerfRecordObj>();
+    convRecord->algo = ConvCpuPerfRecordObj::DirectBlocked;
+    convRecord->time = 0.375;
+    perfEngine.setPerfData(reluKey, make_ref<PerfRecordObj>(0.0625));
+    perfEngine.setPerfData(convKey, convRecord);
+    EXPECT_FALSE(perfEngine.loadPerfEngineData(path));
+    perfEngine.savePerfEngineData(path);
+
+    perfEngine.clear();
+    EXPECT_TRUE(perfEngine.loadPerfEngineData(path));
+    EXPECT_EQ(perfEngine.size(), 2u);
+    EXPECT_DOUBLE_EQ(perfEngine.getPerfData(reluKey)->time, 0.0625);
+    auto loaded = as<ConvCpuPerfRecordObj>(perfEngine.getPerfData(convKey));
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->algo, ConvCpuPerfRecordObj::DirectBlocked);
+    EXPECT_DOUBLE_EQ(loaded->time, 0.375);
+    std::remove(path.c_str());
+}
+
+TEST(PerfEngine, AppendAndMerge) {
+    const string path = "test_perf_engine_append.bin";
+    std::remove(path.c_str());
+    auto &perfEngine = PerfEngine::getInstance();
+    auto a = makeKey(OpType::Relu, 1), b = makeKey(OpType::Sigmoid, 2),
+         c = makeKey(OpType::Tanh, 3);
+
+    // The first process tunes a and b
+    perfEngine.clear();
+    perfEngine.setPerfData(a, make_ref<PerfRecordObj>(2.0));
+    perfEngine.setPerfData(b, make_ref<PerfRecordObj>(1.0));
+    perfEngine.savePerfEngineData(path);
+    const string first = readFile(path);
+    // Saving the same records again writes nothing
+    perfEngine.savePerfEngineData(path);
+    EXPECT_EQ(readFile(path), first);
+
+    // The second process tunes a faster, b slower and c
+    perfEngine.clear();
+    perfEngine.setPerfData(a, make_ref<PerfRecordObj>(1.5));
+    perfEngine.setPerfData(b, make_ref<PerfRecordObj>(4.0));
+    perfEngine.setPerfData(c, make_ref<PerfRecordObj>(3.0));
+    perfEngine.savePerfEngineData(path);
+    const string second = readFile(path);
+    ASSERT_GT(second.size(), first.size());
+    EXPECT_EQ(second.substr(0, first.size()), first);
+
+    perfEngine.clear();
+    EXPECT_TRUE(perfEngine.loadPerfEngineData(path));
+    EXPECT_EQ(perfEngine.size(), 3u);
+    EXPECT_DOUBLE_EQ(perfEngine.getPerfData(a)->time, 1.5);
+    EXPECT_DOUBLE_EQ(perfEngine.getPerfData(b)->time, 1.0);
+    EXPECT_DOUBLE_EQ(perfEngine.getPerfData(c)->time, 3.0);
+
+    // An interrupted save leaves a truncated record, which is skipped
+    writeFile(path, second.substr(0, first.size() + 3));
+    perfEngine.clear();
+    EXPECT_TRUE(perfEngine.loadPerfEngineData(path));
+    EXPECT_EQ(perfEngine.size(), 2u);
+    EXPECT_DOUBLE_EQ(perfEngine.getPerfData(a)->time, 2.0);
+    EXPECT_EQ(perfEngine.getPerfData(c), nullptr);
+    // and dropped by the next save
+    perfEngine.savePerfEngineData(path);
+    EXPECT_EQ(readFile(path), first);
+    std::remove(path.c_str());
+}
+
+TEST(PerfEngine, RejectOtherHeader) {
+    const string path = "test_perf_engine_header.bin";
+    auto &perfEngine = PerfEngine::getInstance();
+    perfEngine.clear();
+    auto key = makeKey(OpType::Relu, 1);
+    perfEngine.setPerfData(key, make_ref<PerfRecordObj>(1.0));
+    perfEngine.savePerfEngineData(path);
+    const string saved = readFile(path);
+
+    // Another schema version, which follows the 8-byte magic
+    string other = saved;
+    other[8] ^= 0x7f;
+    writeFile(path, other);
+    perfEngine.clear();
+    EXPECT_FALSE(perfEngine.loadPerfEngineData(path));
+    EXPECT_EQ(perfEngine.size(), 0u);
+
+    // Another host
+    other = saved;
+    other[8 + 4 + 4] ^= 0x7f;
+    writeFile(path, other);
+    EXPECT_FALSE(perfEngine.loadPerfEngineData(path));
+
+    // Saving replaces a file written elsewhere
+    perfEngine.setPerfData(key, make_ref<PerfRecordObj>(1.0));
+    perfEngine.savePerfEngineData(path);
+    EXPECT_EQ(readFile(path), saved);
+    std::remove(path.c_str());
+}
+
+TEST(PerfEngine, SkipMistypedRecord) {
+    const string path = "test_perf_engine_mistyped.bin";
+    auto &perfEngine = PerfEngine::getInstance();
+    perfEngine.clear();
+    perfEngine.savePerfEngineData(path);
+    const size_t headerSize = readFile(path).size();
+
+    // A well-formed CBOR payload of the wrong types replaces the one of the
+    // only record, which ends the file
+    auto key = makeKey(OpType::Relu, 1);
+    PerfRecord record = make_ref<PerfRecordObj>(1.0);
+    perfEngine.setPerfData(key, record);
+    perfEngine.savePerfEngineData(path);
+    json saved;
+    record->to_json(saved);
+    const size_t cborSize = json::to_cbor(saved).size();
+    for (const json &payload :
+         {json{{"type", "0"}}, json{{"type", 0}, {"data", "fast"}},
+          json::array({0})}) {
+        string content = readFile(path);
+        uint32_t size;
+        std::memcpy(&size, content.data() + headerSize, sizeof(size));
+        auto cbor = json::to_cbor(payload);
+        content.resize(content.size() - cborSize);
+        content.append(cbor.begin(), cbor.end());
+        size = size - cborSize + cbor.size();
+        std::memcpy(content.data() + headerSize, &size, sizeof(size));
+        writeFile(path + ".tmp", content);
+
+        perfEngine.clear();
+        EXPECT_TRUE(perfEngine.loadPerfEngineData(path + ".tmp"));
+        EXPECT_EQ(perfEngine.size(), 0u);
+        // The records after it are still read and kept by a save
+        auto other = makeKey(OpType::Relu, 2);
+        perfEngine.setPerfData(other, make_ref<PerfRecordObj>(2.0));
+        perfEngine.savePerfEngineData(path + ".tmp");
+        perfEngine.clear();
+        EXPECT_TRUE(perfEngine.loadPerfEngineData(path + ".tmp"));
+        EXPECT_EQ(perfEngine.size(), 1u);
+        EXPECT_NE(perfEngine.getPerfData(other), nullptr);
+    }
+    std::remove(path.c_str());
+    std::remove((path + ".tmp").c_str());
+}
+
+TEST(PerfEngine, SingleFlightTuning) {
+    auto &perfEngine = PerfEngine::getInstance();
+    perfEngine.clear();
+    auto key = makeKey(OpType::Relu, 1);
+    std::atomic<int> numTunings{0};
+    constexpr int numThreads = 8;
+    vector<PerfRecord> records(numThreads);
+    vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i)
+        threads.emplace_back([&, i]() {
+            records[i] = perfEngine.getOrTune(key, [&]() {
+                ++numTunings;
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                return make_ref<PerfRecordObj>(0.5);
+            });
+        });
+    for (auto &thread : threads)
+        thread.join();
+    EXPECT_EQ(numTunings, 1);
+    for (auto &record : records)
+        EXPECT_EQ(record, records[0]);
+    EXPECT_EQ(perfEngine.getPerfData(key), records[0]);
+}
+
+TEST(PerfEngine, FailedTuning) {
+    auto &perfEngine = PerfEngine::getInstance();
+    perfEngine.clear();
+    auto key = makeKey(OpType::Relu, 1);
+    std::atomic<int> numFailures{0};
+    vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+        threads.emplace_back([&]() {
+            try {
+                perfEngine.getOrTune(key, []() -> PerfRecord {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    throw std::runtime_error("tuning failed");
+                });
+            } catch (const std::runtime_error &) {
+                ++numFailures;
+            }
+        });
+    for (auto &thread : threads)
+        thread.join();
+    EXPECT_EQ(numFailures, 4);
+    EXPECT_EQ(perfEngine.getPerfData(key), nullptr);
+    // The next call tunes again
+    auto record = perfEngine.getOrTune(
+        key, []() { return make_ref<PerfRecordObj>(1.0); });
+    EXPECT_DOUBLE_EQ(record->time, 1.0);
+}
+
+} // namespace infini
@@ -0,0 +1,114 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/profiler.h"
+#include "core/runtime.h"
+#include "operators/matmul.h"
+#include "operators/unary.h"
+
+#include "test.h"
+#include <nlohmann/json.hpp>
+
+namespace infini {
+
+// relu(a * b) with a of [2, 8, 16] and b of [16, 4]
+static std::tuple<Graph, Operator, Operator> buildGraph(Runtime runtime) {
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor a = g->addTensor({2, 8, 16}, DataType::Float32);
+    Tensor b = g->addTensor({16, 4}, DataType::Float32);
+    auto matmul = g->addOp<MatmulObj>(a, b, nullptr);
+    auto relu = g->addOp<ReluObj>(matmul->getOutput(), nullptr);
+    g->dataMalloc();
+    a->setData(IncrementalGenerator());
+    b->setData(IncrementalGenerator());
+    return {g, matmul, relu};
+}
+
+TEST(Profiler, RecordEvents) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto [g, matmul, relu] = buildGraph(runtime);
+    auto &profiler = Profiler::getInstance();
+    profiler.enable();
+    for (int i = 0; i < 3; ++i)
+        runtime->run(g);
+    profiler.disable();
+    runtime->run(g);
+
+    auto events = profiler.getEvents();
+    ASSERT_EQ(events.size(), 6u);
+    for (size_t i = 0; i < events.size(); ++i) {
+        EXPECT_LE(events[i].begin, events[i].end);
+        if (i > 0) {
+            EXPECT_LE(events[i - 1].end, events[i].begin);
+        }
+        auto info = profiler.getOpInfo(events[i].op);
+        EXPECT_EQ(info.guid, (i % 2 ? relu : matmul)->getGuid());
+    }
+    auto info = profiler.getOpInfo(events[0].op);
+    EXPECT_EQ(info.type, OpType::MatMul);
+    EXPECT_EQ(info.kernel, "Matmul_CPU_float32");
+    EXPECT_EQ(info.shapes, "[2,8,16],[16,4]");
+    EXPECT_EQ(info.bytes, (2 * 8 * 16 + 16 * 4 + 2 * 8 * 4) * sizeof(float));
+    EXPECT_DOUBLE_EQ(info.flops, 2.0 * 2 * 8 * 4 * 16);
+    EXPECT_EQ(profiler.getEvents(4).size(), 2u);
+
+    auto summary = profiler.summary();
+    EXPECT_NE(summary.find("MatMul"), string::npos);
+    EXPECT_NE(summary.find("Relu"), string::npos);
+
+    auto trace = json::parse(profiler.toChromeTrace());
+    ASSERT_EQ(trace["traceEvents"].size(), 6u);
+    EXPECT_EQ(trace["traceEvents"][0]["name"], "MatMul");
+    EXPECT_EQ(trace["traceEvents"][0]["ph"], "X");
+    EXPECT_EQ(trace["traceEvents"][1]["args"]["guid"], relu->getGuid());
+}
+
+TEST(Profiler, RingBuffer) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto [g, matmul, relu] = buildGraph(runtime);
+    auto &profiler = Profiler::getInstance();
+    // Only the last 4 of the 10 events are kept
+    profiler.enable(3);
+    for (int i = 0; i < 5; ++i)
+        runtime->run(g);
+    profiler.disable();
+    EXPECT_EQ(profiler.getEventCount(), 10u);
+    auto events = profiler.getEvents();
+    ASSERT_EQ(events.size(), 4u);
+    EXPECT_EQ(profiler.getOpInfo(events.back().op).guid, relu->getGuid());
+
+    // Enabling again describes the operators of the existing plan again
+    profiler.enable();
+    runtime->run(g);
+    profiler.disable();
+    events = profiler.getEvents();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(profiler.getOpInfo(events[0].op).guid, matmul->getGuid());
+}
+
+TEST(Profiler, ParallelRun) {
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    runtime->setParallelism(2, 1);
+    auto [g, matmul, relu] = buildGraph(runtime);
+    auto &profiler = Profiler::getInstance();
+    profiler.enable();
+    runtime->run(g);
+    profiler.disable();
+    auto events = profiler.getEvents();
+    ASSERT_EQ(events.size(), 2u);
+    // relu has to wait for matmul
+    EXPECT_LE(events[0].end, events[1].begin);
+    EXPECT_EQ(profiler.getOpInfo(events[1].op).guid, relu->getGuid());
+}
+
+TEST(Profiler, ProfilingRun) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto [g, matmul, relu] = buildGraph(runtime);
+    auto &profiler = Profiler::getInstance();
+    profiler.disable();
+    // Profiling no longer needs tuning, and leaves the profiler as it was
+    runtime->run(g, false, true);
+    EXPECT_FALSE(profiler.isEnabled());
+    EXPECT_EQ(profiler.getEvents().size(), 2u);
+}
+
+} // namespace infini
@@ -52,6 +52,35 @@ TEST(Graph, search_withdm) {
     // check execution results
 }
 
+TEST(SearchEngine, ParallelMatchesSerial) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor t0 = g->addTensor({1, 3, 32, 32});
+    Tensor w0 = g->addTensor({3, 3, 3, 3});
+    Tensor t1 = g->addTensor({1, 3, 32, 32});
+    Tensor w1 = g->addTensor({3, 3, 3, 3});
+    auto t2 = g->addOp<ConvObj>(t0, w0, nullptr, 1, 1)->getOutput();
+    auto t3 = g->addOp<AddObj>(t2, t1, nullptr)->getOutput();
+    auto t4 = g->addOp<ConvObj>(t3, w1, nullptr, 1, 1)->getOutput();
+    g->addOp<ReluObj>(t4, nullptr);
+    g->dataMalloc();
+
+    auto searchWith = [&](int numThreads) {
+        SearchEngine searchEngine(runtime, make_ref<DummyMutator>(10));
+        searchEngine.setNumThreads(numThreads);
+        auto best = searchEngine.run(g);
+        vector<OpType> types;
+        for (auto &op : best->getOperators())
+            types.emplace_back(op->getOpType());
+        // The returned graph is allocated although candidates are not
+        for (auto &tensor : best->getTensors())
+            EXPECT_TRUE(tensor->hasData());
+        return types;
+    };
+    auto serial = searchWith(1);
+    EXPECT_EQ(searchWith(4), serial);
+}
+
 // TEST(DummyMutator, run) {
 //     Runtime runtime = NativeCpuRuntimeObj::getInstance();
 //     Graph g = make_ref<GraphObj>(runtime);
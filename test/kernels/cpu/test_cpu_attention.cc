@@ -0,0 +1,107 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/attention.h"
+
+#include "test.h"
+#include <cmath>
+
+namespace infini {
+
+// softmax(q * k^T * scale + mask) * v for every batch directly, in double.
+// `mask` has been expanded to [batch, sq, sk].
+vector<double> attentionReference(const vector<float> &q,
+                                  const vector<float> &k,
+                                  const vector<float> &v,
+                                  const vector<float> &mask, size_t batch,
+                                  size_t sq, size_t sk, size_t d, size_t dv,
+                                  float scale) {
+    vector<double> out(batch * sq * dv), p(sk);
+    for (size_t b = 0; b < batch; ++b)
+        for (size_t i = 0; i < sq; ++i) {
+            double maxVal = -INFINITY, sum = 0;
+            for (size_t j = 0; j < sk; ++j) {
+                double s = 0;
+                for (size_t t = 0; t < d; ++t)
+                    s += double(q[(b * sq + i) * d + t]) *
+                         k[(b * sk + j) * d + t];
+                p[j] = s * scale +
+                       (mask.empty() ? 0 : mask[(b * sq + i) * sk + j]);
+                maxVal = std::max(maxVal, p[j]);
+            }
+            for (size_t j = 0; j < sk; ++j)
+                sum += p[j] = std::exp(p[j] - maxVal);
+            for (size_t t = 0; t < dv; ++t) {
+                double acc = 0;
+                for (size_t j = 0; j < sk; ++j)
+                    acc += p[j] * v[(b * sk + j) * dv + t];
+                out[(b * sq + i) * dv + t] = acc / sum;
+            }
+        }
+    return out;
+}
+
+void testAttentionCpu(const Shape &batchDims, size_t sq, size_t sk, size_t d,
+                      size_t dv, const optional<Shape> &maskShape) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto withBatch = [&](Shape tail) {
+        Shape shape = batchDims;
+        shape.insert(shape.end(), tail.begin(), tail.end());
+        return shape;
+    };
+    auto q = g->addTensor(withBatch({int(sq), int(d)}), DataType::Float32);
+    auto k = g->addTensor(withBatch({int(sk), int(d)}), DataType::Float32);
+    auto v = g->addTensor(withBatch({int(sk), int(dv)}), DataType::Float32);
+    auto mask = maskShape ? g->addTensor(*maskShape, DataType::Float32)
+                          : nullptr;
+    auto op = g->addOp<AttentionObj>(q, k, v, nullptr, mask);
+    g->dataMalloc();
+    q->setData(RandomGenerator(-1, 1, 0));
+    k->setData(RandomGenerator(-1, 1, 1));
+    v->setData(RandomGenerator(-1, 1, 2));
+    if (mask)
+        mask->setData(RandomGenerator(-4, 4, 3));
+    runtime->run(g);
+
+    size_t batch = 1;
+    for (auto dim : batchDims)
+        batch *= dim;
+    // Expand the mask to [batch, sq, sk]
+    vector<float> fullMask;
+    if (mask) {
+        Shape scores = withBatch({int(sq), int(sk)});
+        Shape mDims = *maskShape;
+        mDims.insert(mDims.begin(), scores.size() - mDims.size(), 1);
+        auto m = mask->copyout<float>();
+        fullMask.resize(batch * sq * sk);
+        for (size_t i = 0; i < fullMask.size(); ++i) {
+            size_t offset = 0, stride = 1;
+            for (size_t rest = i, a = scores.size(); a-- > 0;
+                 rest /= scores[a]) {
+                if (mDims[a] != 1)
+                    offset += rest % scores[a] * stride;
+                stride *= mDims[a];
+            }
+            fullMask[i] = m[offset];
+        }
+    }
+    auto ref = attentionReference(q->copyout<float>(), k->copyout<float>(),
+                                  v->copyout<float>(), fullMask, batch, sq,
+                                  sk, d, dv, op->getScale());
+    auto y = op->getOutput()->copyout<float>();
+    ASSERT_EQ(y.size(), ref.size());
+    for (size_t i = 0; i < y.size(); ++i)
+        ASSERT_NEAR(y[i], ref[i], 1e-4) << "at " << i;
+}
+
+TEST(Attention, Cpu) {
+    testAttentionCpu({2, 3}, 5, 7, 8, 8, std::nullopt);
+    testAttentionCpu({2}, 5, 7, 8, 4, Shape{7});
+    // Several query and key blocks with remainders
+    testAttentionCpu({2, 2}, 70, 300, 32, 16, Shape{2, 1, 1, 300});
+    testAttentionCpu({1, 4}, 33, 129, 64, 64, Shape{33, 129});
+    testAttentionCpu({}, 100, 257, 16, 24, std::nullopt);
+}
+
+} // namespace infini
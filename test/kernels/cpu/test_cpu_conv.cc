@@ -0,0 +1,109 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "cpu/cpu_conv.h"
+#include "operators/conv.h"
+
+#include "test.h"
+
+namespace infini {
+
+// Runs a float convolution with every applicable algorithm and compares it
+// with a direct evaluation of the definition.
+void testConvCpuAlgos(const Shape &inputShape, const Shape &weightShape,
+                      int ph, int pw, int sh, int sw, int dh, int dw,
+                      vector<int> expectAlgos, bool withBias = false) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor i0 = g->addTensor(inputShape, DataType::Float32);
+    Tensor w0 = g->addTensor(weightShape, DataType::Float32);
+    Tensor b0 =
+        withBias ? g->addTensor({weightShape[0]}, DataType::Float32) : nullptr;
+    auto conv = g->addOp<ConvObj>(i0, w0, nullptr, ph, pw, sh, sw, dh, dw, b0);
+    g->dataMalloc();
+    i0->setData(RandomGenerator(-1, 1, 0));
+    w0->setData(RandomGenerator(-1, 1, 1));
+    if (b0)
+        b0->setData(RandomGenerator(-1, 1, 2));
+
+    auto in = i0->copyout<float>(), wt = w0->copyout<float>();
+    int n, c, h, w, f, r, s;
+    std::tie(n, c, h, w, f, r, s) = conv->getNCHWFRS();
+    auto outDims = conv->getOutput()->getDims();
+    int oh = outDims[2], ow = outDims[3];
+    int cpg = conv->getChannelPerGroup(), fpg = f / conv->getNumGroups();
+    auto bias = b0 ? b0->copyout<float>() : vector<float>(f, 0);
+    vector<float> ans(conv->getOutput()->size(), 0);
+    for (int nn = 0; nn < n; ++nn)
+        for (int ff = 0; ff < f; ++ff)
+            for (int y = 0; y < oh; ++y)
+                for (int x = 0; x < ow; ++x) {
+                    float &val = ans[((nn * f + ff) * oh + y) * ow + x];
+                    val = bias[ff];
+                    for (int cc = 0; cc < cpg; ++cc)
+                        for (int rr = 0; rr < r; ++rr)
+                            for (int ss = 0; ss < s; ++ss) {
+                                int ih = y * sh + rr * dh - ph;
+                                int iw = x * sw + ss * dw - pw;
+                                if (ih < 0 || ih >= h || iw < 0 || iw >= w)
+                                    continue;
+                                int ic = ff / fpg * cpg + cc;
+                                val += in[((nn * c + ic) * h + ih) * w + iw] *
+                                       wt[((ff * cpg + cc) * r + rr) * s + ss];
+                            }
+                }
+
+    auto kernel = KernelRegistry::getInstance().getKernel(
+        {Device::CPU, OpType::Conv, DataType::Float32});
+    for (int algo : expectAlgos) {
+        auto record = make_ref<ConvCpuPerfRecordObj>();
+        record->algo = algo;
+        conv->getOutput()->setData(ZeroGenerator());
+        kernel->compute(conv, record, runtime.get());
+        auto out = conv->getOutput()->copyout<float>();
+        for (size_t i = 0; i < ans.size(); ++i)
+            ASSERT_NEAR(out[i], ans[i], 1e-4) << "algo " << algo;
+    }
+    auto best = as<ConvCpuPerfRecordObj>(kernel->tune(conv, runtime.get()));
+    EXPECT_NE(std::find(expectAlgos.begin(), expectAlgos.end(), best->algo),
+              expectAlgos.end());
+}
+
+TEST(Conv, Cpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor i0 = g->addTensor({1, 3, 4, 4}, DataType::Float32);
+    Tensor w0 = g->addTensor({2, 3, 3, 3}, DataType::Float32);
+    auto conv = g->addOp<ConvObj>(i0, w0, nullptr, 1, 1, 2, 1, 1, 2);
+    g->dataMalloc();
+    i0->setData(IncrementalGenerator());
+    w0->setData(IncrementalGenerator());
+    runtime->run(g, true);
+    EXPECT_TRUE(conv->getOutput()->equalData(
+        vector<float>{4794, 4386, 8199, 7506, 11274, 10542, 20835, 19656}));
+}
+
+TEST(Conv, CpuAlgorithms) {
+    using Algo = ConvCpuPerfRecordObj::Algo;
+    // 3x3 with padding, stride and dilation
+    testConvCpuAlgos({2, 5, 9, 11}, {20, 5, 3, 3}, 1, 1, 1, 1, 1, 1,
+                     {Algo::Im2colGemm, Algo::DirectBlocked});
+    testConvCpuAlgos({1, 3, 10, 9}, {7, 3, 3, 3}, 2, 1, 2, 1, 1, 2,
+                     {Algo::Im2colGemm, Algo::DirectBlocked});
+    // Pointwise
+    testConvCpuAlgos({2, 8, 5, 6}, {17, 8, 1, 1}, 0, 0, 1, 1, 1, 1,
+                     {Algo::Im2colGemm, Algo::DirectBlocked});
+    // Grouped 5x5
+    testConvCpuAlgos({1, 6, 8, 8}, {4, 3, 5, 5}, 2, 2, 1, 1, 1, 1,
+                     {Algo::Im2colGemm});
+    // Depthwise with a channel multiplier of 2
+    testConvCpuAlgos({2, 4, 7, 8}, {8, 1, 3, 3}, 1, 1, 2, 2, 1, 1,
+                     {Algo::Im2colGemm, Algo::Depthwise});
+    // With bias
+    testConvCpuAlgos({2, 5, 9, 11}, {20, 5, 3, 3}, 1, 1, 1, 1, 1, 1,
+                     {Algo::Im2colGemm, Algo::DirectBlocked}, true);
+    testConvCpuAlgos({2, 4, 7, 8}, {8, 1, 3, 3}, 1, 1, 2, 2, 1, 1,
+                     {Algo::Im2colGemm, Algo::Depthwise}, true);
+}
+
+} // namespace infini
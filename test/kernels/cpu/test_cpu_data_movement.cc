@@ -0,0 +1,189 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/expand.h"
+#include "operators/gather.h"
+#include "operators/pad.h"
+#include "operators/slice.h"
+#include "operators/split.h"
+#include "operators/transpose.h"
+#include "operators/where.h"
+
+#include "test.h"
+#include <numeric>
+
+namespace infini {
+
+// Compares a transpose with a reference that indexes every element
+void testTransposeCpu(const Shape &shape, const vector<int> &permute) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor(shape, DataType::Float32);
+    auto op = g->addOp<TransposeObj>(input, nullptr, permute);
+    g->dataMalloc();
+    input->setData(IncrementalGenerator());
+    runtime->run(g);
+
+    auto out = op->getOutput()->copyout<float>();
+    auto outDims = op->getOutput()->getDims();
+    auto inStride = input->getStride();
+    const int rank = shape.size();
+    for (size_t i = 0; i < out.size(); ++i) {
+        size_t rest = i, offset = 0;
+        for (int d = rank - 1; d >= 0; --d) {
+            offset += rest % outDims[d] * inStride[permute[d]];
+            rest /= outDims[d];
+        }
+        ASSERT_EQ(out[i], (float)offset) << "at " << i;
+    }
+}
+
+TEST(Transpose, Cpu) {
+    testTransposeCpu({2, 3, 4}, {0, 2, 1});
+    testTransposeCpu({2, 3, 4, 5}, {3, 1, 0, 2});
+    testTransposeCpu({3, 300, 257}, {0, 2, 1});
+    testTransposeCpu({520, 3, 2}, {2, 1, 0});
+}
+
+TEST(Concat, Cpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto t1 = g->addTensor({2, 2, 3, 1}, DataType::Float32);
+    auto t2 = g->addTensor({2, 2, 1, 1}, DataType::Float32);
+    auto t3 = g->addTensor({2, 2, 2, 1}, DataType::Float32);
+    auto op = g->addOp<ConcatObj>(TensorVec{t1, t2, t3}, nullptr, -2);
+    g->dataMalloc();
+    t1->setData(IncrementalGenerator());
+    t2->setData(OneGenerator());
+    t3->setData(OneGenerator());
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(
+        vector<float>{0, 1, 2, 1, 1, 1, 3, 4,  5,  1, 1, 1,
+                      6, 7, 8, 1, 1, 1, 9, 10, 11, 1, 1, 1}));
+}
+
+TEST(Split, Cpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({2, 10, 2, 1}, DataType::Int64);
+    auto op = g->addOp<SplitObj>(input, std::nullopt, 1, 3);
+    g->dataMalloc();
+    vector<int64_t> data(input->size());
+    std::iota(data.begin(), data.end(), 0);
+    input->copyin(data);
+    runtime->run(g);
+    EXPECT_EQ(op->getOutputs().size(), (size_t)3);
+    EXPECT_TRUE(op->getOutput(0)->equalData(
+        vector<int64_t>{0, 1, 2, 3, 4, 5, 20, 21, 22, 23, 24, 25}));
+    EXPECT_TRUE(op->getOutput(1)->equalData(
+        vector<int64_t>{6, 7, 8, 9, 10, 11, 26, 27, 28, 29, 30, 31}));
+    EXPECT_TRUE(op->getOutput(2)->equalData(
+        vector<int64_t>{12, 13, 14, 15, 16, 17, 18, 19, 32, 33, 34, 35, 36,
+                        37, 38, 39}));
+}
+
+TEST(Slice, Cpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({3, 2, 1, 5}, DataType::Float32);
+    auto op = g->addOp<SliceObj>(input, nullptr, vector<int>{1, 1},
+                                 vector<int>{2, 5}, vector<int>{0, 3},
+                                 vector<int>{1, 2});
+    g->dataMalloc();
+    input->setData(IncrementalGenerator());
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(vector<float>{11, 13, 16, 18}));
+}
+
+TEST(Pad, Cpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({1, 2, 3, 2}, DataType::Float32);
+    auto op = g->addOp<PadObj>(input, nullptr, vector<int>{1, 0, 1, 1},
+                               vector<int>{0, 3});
+    g->dataMalloc();
+    input->setData(IncrementalGenerator());
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(
+        vector<float>{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0,  0,
+                      0, 1, 0, 2, 3, 0, 4, 5, 0, 6, 7, 0, 8, 9, 0, 10, 11, 0,
+                      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0,  0}));
+}
+
+TEST(Gather, Cpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto input = g->addTensor({3, 2}, DataType::Float32);
+        auto index = g->addTensor({2, 2}, DataType::Int32);
+        auto op = g->addOp<GatherObj>(input, index, nullptr, 0);
+        g->dataMalloc();
+        input->copyin(vector<float>{1, 2, 3, 4, 5, 6});
+        index->copyin(vector<int32_t>{0, 1, 1, 2});
+        runtime->run(g);
+        EXPECT_TRUE(
+            op->getOutput()->equalData(vector<float>{1, 2, 3, 4, 3, 4, 5, 6}));
+    }
+    {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto input = g->addTensor({2, 4, 2}, DataType::Int64);
+        auto index = g->addTensor({3, 1}, DataType::Int64);
+        auto op = g->addOp<GatherObj>(input, index, nullptr, 1);
+        g->dataMalloc();
+        vector<int64_t> data(input->size());
+        std::iota(data.begin(), data.end(), 0);
+        input->copyin(data);
+        index->copyin(vector<int64_t>{0, 3, 1});
+        runtime->run(g);
+        EXPECT_TRUE(op->getOutput()->equalData(
+            vector<int64_t>{0, 1, 6, 7, 2, 3, 8, 9, 14, 15, 10, 11}));
+    }
+    {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto input = g->addTensor({3, 2}, DataType::Float32);
+        auto index = g->addTensor({2}, DataType::Int64);
+        auto op = g->addOp<GatherObj>(input, index, nullptr, 0);
+        g->dataMalloc();
+        input->copyin(vector<float>{1, 2, 3, 4, 5, 6});
+        index->copyin(vector<int64_t>{-1, -3});
+        runtime->run(g);
+        EXPECT_TRUE(op->getOutput()->equalData(vector<float>{5, 6, 1, 2}));
+        index->copyin(vector<int64_t>{3, 0});
+        EXPECT_THROW(runtime->run(g), Exception);
+        index->copyin(vector<int64_t>{0, -4});
+        EXPECT_THROW(runtime->run(g), Exception);
+    }
+}
+
+TEST(Expand, Cpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({3, 1}, DataType::Float32);
+    auto op = g->addOp<ExpandObj>(input, nullptr, Shape{2, 1, 4});
+    g->dataMalloc();
+    input->copyin(vector<float>{1, 2, 3});
+    runtime->run(g);
+    EXPECT_EQ(op->getOutput()->getDims(), (Shape{2, 3, 4}));
+    EXPECT_TRUE(op->getOutput()->equalData(
+        vector<float>{1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                      1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3}));
+}
+
+TEST(Where, Cpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({2, 3}, DataType::Float32);
+    auto y = g->addTensor({1}, DataType::Float32);
+    auto cond = g->addTensor({2, 1}, DataType::UInt8);
+    auto op = g->addOp<WhereObj>(x, y, cond, nullptr);
+    g->dataMalloc();
+    x->setData(IncrementalGenerator());
+    y->copyin(vector<float>{-1});
+    cond->copyin(vector<uint8_t>{0, 1});
+    runtime->run(g);
+    EXPECT_TRUE(
+        op->getOutput()->equalData(vector<float>{-1, -1, -1, 3, 4, 5}));
+}
+
+} // namespace infini
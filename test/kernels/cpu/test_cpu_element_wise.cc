@@ -0,0 +1,103 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+
+#include "test.h"
+
+namespace infini {
+
+// Compares a broadcast element-wise operator with an evaluation that indexes
+// every output element independently.
+template <class T>
+void testElementWiseCpu(const Shape &shapeA, const Shape &shapeB,
+                        const std::function<float(float, float)> &ref) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor(shapeA, DataType::Float32);
+    auto b = g->addTensor(shapeB, DataType::Float32);
+    auto op = g->addOp<T>(a, b, nullptr);
+    g->dataMalloc();
+    a->setData(RandomGenerator(0.5, 2, 0));
+    b->setData(RandomGenerator(0.5, 2, 1));
+    runtime->run(g);
+
+    auto va = a->copyout<float>(), vb = b->copyout<float>();
+    Tensor c = op->getOutput();
+    auto out = c->copyout<float>();
+    auto outDims = c->getDims();
+    const int rank = outDims.size();
+    auto offset = [&](const Shape &dims, const Shape &idx) {
+        const int skip = rank - dims.size();
+        size_t ret = 0;
+        for (size_t d = 0; d < dims.size(); ++d)
+            ret = ret * dims[d] + (dims[d] == 1 ? 0 : idx[d + skip]);
+        return ret;
+    };
+    Shape idx(rank, 0);
+    for (size_t i = 0; i < out.size(); ++i) {
+        for (int d = rank - 1, rest = i; d >= 0; --d) {
+            idx[d] = rest % outDims[d];
+            rest /= outDims[d];
+        }
+        ASSERT_FLOAT_EQ(out[i], ref(va[offset(shapeA, idx)],
+                                    vb[offset(shapeB, idx)]))
+            << "at " << i;
+    }
+}
+
+TEST(ElementWise, CpuBroadcast) {
+    auto add = [](float a, float b) { return a + b; };
+    // Same shape
+    testElementWiseCpu<AddObj>({2, 3, 4, 5}, {2, 3, 4, 5}, add);
+    testElementWiseCpu<AddObj>({70000}, {70000}, add);
+    // Scalar
+    testElementWiseCpu<AddObj>({3, 4, 5}, {1}, add);
+    testElementWiseCpu<AddObj>({1, 1}, {4, 5, 6}, add);
+    // Row and column
+    testElementWiseCpu<AddObj>({7, 9}, {9}, add);
+    testElementWiseCpu<AddObj>({7, 1}, {7, 9}, add);
+    // Both inputs broadcast, higher rank
+    testElementWiseCpu<AddObj>({2, 1, 3, 1, 5, 1}, {1, 4, 3, 6, 1, 2}, add);
+    testElementWiseCpu<AddObj>({3, 1, 40000}, {1, 2, 1}, add);
+}
+
+TEST(ElementWise, CpuOps) {
+    const Shape a{2, 3, 4}, b{3, 1};
+    testElementWiseCpu<SubObj>(a, b, [](float a, float b) { return a - b; });
+    testElementWiseCpu<MulObj>(a, b, [](float a, float b) { return a * b; });
+    testElementWiseCpu<DivObj>(a, b, [](float a, float b) { return a / b; });
+    testElementWiseCpu<PowObj>(a, b, [](float a, float b) {
+        return std::pow(a, b);
+    });
+    testElementWiseCpu<MinimumObj>(a, b, [](float a, float b) {
+        return std::min(a, b);
+    });
+    testElementWiseCpu<MaximumObj>(a, b, [](float a, float b) {
+        return std::max(a, b);
+    });
+    testElementWiseCpu<EqualObj>(a, a, [](float a, float b) {
+        return float(a == b);
+    });
+    testElementWiseCpu<EqualObj>(a, b, [](float a, float b) {
+        return float(a == b);
+    });
+}
+
+TEST(ElementWise, CpuUInt32) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3}, DataType::UInt32);
+    auto b = g->addTensor({3}, DataType::UInt32);
+    auto pow = g->addOp<PowObj>(a, b, nullptr);
+    auto eq = g->addOp<EqualObj>(a, b, nullptr);
+    g->dataMalloc();
+    a->copyin(vector<uint32_t>{1, 2, 3, 4, 5, 6});
+    b->copyin(vector<uint32_t>{3, 2, 1});
+    runtime->run(g);
+    EXPECT_TRUE(
+        pow->getOutput()->equalData(vector<uint32_t>{1, 4, 3, 64, 25, 6}));
+    EXPECT_TRUE(eq->getOutput()->equalData(vector<uint32_t>{0, 1, 0, 0, 0, 0}));
+}
+
+} // namespace infini
@@ -0,0 +1,86 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/layer_norm.h"
+
+#include "test.h"
+#include <cmath>
+
+namespace infini {
+
+// Normalizes every row of `n` elements directly, in double.
+vector<double> normReference(const vector<float> &x, size_t n,
+                             const vector<float> &scale,
+                             const vector<float> &bias, float eps, bool rms) {
+    vector<double> y(x.size());
+    for (size_t r = 0; r < x.size() / n; ++r) {
+        const float *row = x.data() + r * n;
+        double mean = 0, var = 0;
+        if (!rms) {
+            for (size_t i = 0; i < n; ++i)
+                mean += row[i];
+            mean /= n;
+        }
+        for (size_t i = 0; i < n; ++i)
+            var += (row[i] - mean) * (row[i] - mean);
+        const double rstd = 1 / std::sqrt(var / n + eps);
+        for (size_t i = 0; i < n; ++i)
+            y[r * n + i] = (row[i] - mean) * rstd *
+                               scale[scale.size() == 1 ? 0 : i] +
+                           (bias.empty() ? 0 : bias[bias.size() == 1 ? 0 : i]);
+    }
+    return y;
+}
+
+void testNormCpu(const Shape &shape, int axis, const Shape &paramShape,
+                 bool withBias, bool rms, float offset = 0) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor(shape, DataType::Float32);
+    auto scale = g->addTensor(paramShape, DataType::Float32);
+    auto bias = withBias ? g->addTensor(paramShape, DataType::Float32)
+                         : nullptr;
+    const float eps = 1e-5;
+    Ref<LayerNormBaseObj> op;
+    if (rms)
+        op = g->addOp<RMSNormObj>(input, scale, nullptr, eps, axis);
+    else
+        op = g->addOp<LayerNormObj>(input, scale, nullptr, bias, eps, axis);
+    g->dataMalloc();
+    input->setData(RandomGenerator(offset - 2, offset + 2, 0));
+    scale->setData(RandomGenerator(0.5, 1.5, 1));
+    if (bias)
+        bias->setData(RandomGenerator(-1, 1, 2));
+    runtime->run(g);
+
+    auto x = input->copyout<float>();
+    auto y = op->getOutput()->copyout<float>();
+    auto ref = normReference(x, op->getNormalizedSize(),
+                             scale->copyout<float>(),
+                             bias ? bias->copyout<float>() : vector<float>{},
+                             eps, rms);
+    ASSERT_EQ(y.size(), ref.size());
+    for (size_t i = 0; i < y.size(); ++i)
+        ASSERT_NEAR(y[i], ref[i], 1e-4 * std::max(1.0, std::abs(ref[i])))
+            << "at " << i;
+}
+
+TEST(LayerNorm, Cpu) {
+    testNormCpu({2, 3, 4}, -1, {4}, true, false);
+    testNormCpu({2, 3, 4}, 1, {3, 4}, false, false);
+    testNormCpu({2, 3, 4}, -1, {1}, true, false);
+    // Rows longer than the Welford lanes, with a remainder
+    testNormCpu({4, 7, 771}, -1, {771}, true, false);
+    testNormCpu({128, 768}, -1, {768}, true, false);
+    // A large offset, which cancels in E[x^2] - E[x]^2
+    testNormCpu({8, 1024}, -1, {1024}, true, false, 1000);
+}
+
+TEST(RMSNorm, Cpu) {
+    testNormCpu({2, 3, 4}, -1, {4}, false, true);
+    testNormCpu({2, 3, 4}, 1, {1, 3, 4}, false, true);
+    testNormCpu({4, 7, 771}, -1, {771}, false, true);
+    testNormCpu({128, 768}, -1, {1}, false, true);
+}
+
+} // namespace infini
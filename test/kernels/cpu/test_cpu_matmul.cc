@@ -0,0 +1,132 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/matmul.h"
+
+#include "test.h"
+
+namespace infini {
+using ExpectOutput = vector<float>;
+
+void testMatmulCpu(
+    const std::function<void(void *, size_t, DataType)> &generatorA,
+    const std::function<void(void *, size_t, DataType)> &generatorB,
+    bool transA, bool transB, const Shape &shapeA, const Shape &shapeB,
+    const ExpectOutput &ansVec) {
+    auto cpuRuntime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(cpuRuntime);
+    auto A = g->addTensor(shapeA, DataType::Float32);
+    auto B = g->addTensor(shapeB, DataType::Float32);
+    auto matmul = g->addOp<MatmulObj>(A, B, nullptr, transA, transB);
+
+    g->dataMalloc();
+    A->setData(generatorA);
+    B->setData(generatorB);
+    cpuRuntime->run(g);
+    EXPECT_TRUE(matmul->getOutput()->equalData(ansVec));
+}
+
+// Compares against a straightforward reference with bias and activation on
+// shapes that exercise the packed edge blocks and several K panels. If
+// `kernel` is not empty, the MatMul kernel of that name computes the output.
+void testMatmulCpuReference(int b, int m, int n, int k, bool transA,
+                            bool transB, bool bias, ActType act,
+                            const string &kernel = "") {
+    auto cpuRuntime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(cpuRuntime);
+    auto A = g->addTensor(transA ? Shape{b, k, m} : Shape{b, m, k},
+                          DataType::Float32);
+    // B is broadcast along the batch dimension
+    auto B = g->addTensor(transB ? Shape{n, k} : Shape{k, n},
+                          DataType::Float32);
+    auto bTensor = bias ? g->addTensor({n}, DataType::Float32) : nullptr;
+    auto matmul =
+        g->addOp<MatmulObj>(A, B, nullptr, transA, transB, bTensor, act);
+    g->dataMalloc();
+    A->setData(RandomGenerator(-1, 1, 0));
+    B->setData(RandomGenerator(-1, 1, 1));
+    if (bias)
+        bTensor->setData(RandomGenerator(-1, 1, 2));
+    if (kernel.empty())
+        cpuRuntime->run(g);
+    else {
+        auto item = KernelRegistry::getInstance().getKernelItem(
+            {Device::CPU, OpType::MatMul, DataType::Float32}, kernel);
+        ASSERT_NE(item, nullptr);
+        ASSERT_TRUE(std::get<0>(*item)->isApplicable(matmul));
+        std::get<0>(*item)->compute(matmul, cpuRuntime.get());
+    }
+
+    auto a = A->copyout<float>(), w = B->copyout<float>();
+    auto c = matmul->getOutput()->copyout<float>();
+    vector<float> bv = bias ? bTensor->copyout<float>() : vector<float>(n, 0);
+    for (int bb = 0; bb < b; ++bb)
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j) {
+                double ans = bv[j];
+                for (int p = 0; p < k; ++p)
+                    ans += a[bb * m * k + (transA ? p * m + i : i * k + p)] *
+                           w[transB ? j * k + p : p * n + j];
+                if (act == ActType::Relu)
+                    ans = std::max(ans, 0.0);
+                else if (act == ActType::Sigmoid)
+                    ans = 1 / (1 + std::exp(-ans));
+                else if (act == ActType::Tanh)
+                    ans = std::tanh(ans);
+                ASSERT_NEAR(c[(bb * m + i) * n + j], ans, 1e-4 * k);
+            }
+}
+
+TEST(Matmul, Cpu) {
+    testMatmulCpu(IncrementalGenerator(), OneGenerator(), false, false,
+                  Shape{1, 3, 5}, Shape{1, 5, 2},
+                  ExpectOutput{10, 10, 35, 35, 60, 60});
+    testMatmulCpu(IncrementalGenerator(), IncrementalGenerator(), true, false,
+                  Shape{2, 3, 4}, Shape{2, 3, 2},
+                  ExpectOutput{40, 52, 46, 61, 52, 70, 58, 79, 400, 448, 424,
+                               475, 448, 502, 472, 529});
+    testMatmulCpu(
+        IncrementalGenerator(), IncrementalGenerator(), false, false,
+        Shape{2, 3, 5}, Shape{5, 2},
+        ExpectOutput{60, 70, 160, 195, 260, 320, 360, 445, 460, 570, 560, 695});
+    testMatmulCpu(IncrementalGenerator(), IncrementalGenerator(), true, false,
+                  Shape{2, 5, 3}, Shape{5, 2},
+                  ExpectOutput{180, 210, 200, 235, 220, 260, 480, 585, 500,
+                               610, 520, 635});
+    testMatmulCpu(IncrementalGenerator(), IncrementalGenerator(), false, false,
+                  Shape{3, 5}, Shape{5, 2},
+                  ExpectOutput{60, 70, 160, 195, 260, 320});
+}
+
+TEST(Matmul, CpuBlocked) {
+    testMatmulCpuReference(1, 1, 300, 40, false, false, false, ActType::None);
+    testMatmulCpuReference(2, 37, 29, 300, false, true, true, ActType::Relu);
+    testMatmulCpuReference(3, 100, 270, 64, true, false, true,
+                           ActType::Sigmoid);
+    testMatmulCpuReference(1, 130, 17, 513, true, true, false, ActType::Tanh);
+}
+
+TEST(Matmul, CpuGemv) {
+    const string gemv = "MatmulGemv_CPU_float32";
+    testMatmulCpuReference(1, 1, 300, 40, false, false, false, ActType::None,
+                           gemv);
+    testMatmulCpuReference(3, 1, 600, 70, true, false, true, ActType::Relu,
+                           gemv);
+    testMatmulCpuReference(2, 1, 29, 300, false, true, true, ActType::Sigmoid,
+                           gemv);
+    testMatmulCpuReference(1, 1, 17, 513, true, true, false, ActType::Tanh,
+                           gemv);
+
+    // Only applicable to vector-matrix products
+    auto cpuRuntime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(cpuRuntime);
+    auto A = g->addTensor({2, 8}, DataType::Float32);
+    auto B = g->addTensor({8, 4}, DataType::Float32);
+    auto matmul = g->addOp<MatmulObj>(A, B, nullptr);
+    auto items = KernelRegistry::getInstance().getKernelItems(
+        {Device::CPU, OpType::MatMul, DataType::Float32}, matmul);
+    ASSERT_EQ(items.size(), 1u);
+    EXPECT_EQ(std::get<1>(*items[0]), "Matmul_CPU_float32");
+}
+
+} // namespace infini
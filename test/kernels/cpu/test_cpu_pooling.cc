@@ -0,0 +1,112 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/pooling.h"
+#include "utils/data_convert.h"
+
+#include "test.h"
+#include <cmath>
+
+namespace infini {
+using KDPS = vector<int>;
+
+// Pools every window of one output element directly, in double. Padding is
+// skipped by the max and counted by the average.
+template <bool IsMax>
+vector<double> poolReference(const vector<float> &x, const Shape &in,
+                             const Shape &out, const KDPS &kdps) {
+    const int ih = in[2], iw = in[3], oh = out[2], ow = out[3];
+    const auto [kh, kw, dh, dw, ph, pw, sh, sw] =
+        std::tuple(kdps[0], kdps[1], kdps[2], kdps[3], kdps[4], kdps[5],
+                   kdps[6], kdps[7]);
+    vector<double> y;
+    for (int p = 0; p < in[0] * in[1]; ++p)
+        for (int i = 0; i < oh; ++i)
+            for (int j = 0; j < ow; ++j) {
+                double acc = IsMax ? -INFINITY : 0;
+                int count = 0;
+                for (int k = 0; k < kh; ++k)
+                    for (int l = 0; l < kw; ++l) {
+                        const int r = i * sh - ph + k * dh,
+                                  c = j * sw - pw + l * dw;
+                        count += r < ih + ph && c < iw + pw;
+                        if (r < 0 || r >= ih || c < 0 || c >= iw)
+                            continue;
+                        const double v = x[(p * ih + r) * iw + c];
+                        acc = IsMax ? std::max(acc, v) : acc + v;
+                    }
+                y.push_back(IsMax ? acc : acc / count);
+            }
+    return y;
+}
+
+template <class T>
+void testPoolCpu(const Shape &shape, const KDPS &kdps, int ceilMode = 0) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor(shape, DataType::Float32);
+    auto op = g->addOp<T>(input, nullptr, kdps[0], kdps[1], kdps[2], kdps[3],
+                          kdps[4], kdps[5], kdps[6], kdps[7], ceilMode);
+    g->dataMalloc();
+    input->setData(RandomGenerator(-10, 10, 0));
+    runtime->run(g);
+
+    Tensor output = op->getOutput();
+    auto x = input->copyout<float>();
+    auto y = output->copyout<float>();
+    auto ref = poolReference<std::is_same_v<T, MaxPoolObj>>(
+        x, shape, output->getDims(), kdps);
+    ASSERT_EQ(y.size(), ref.size());
+    for (size_t i = 0; i < y.size(); ++i)
+        ASSERT_NEAR(y[i], ref[i], 1e-5) << "at " << i;
+}
+
+TEST(MaxPool, Cpu) {
+    testPoolCpu<MaxPoolObj>({1, 2, 5, 5}, {3, 3, 1, 1, 1, 1, 2, 2});
+    testPoolCpu<MaxPoolObj>({2, 3, 17, 19}, {3, 2, 1, 1, 0, 1, 2, 3});
+    testPoolCpu<MaxPoolObj>({2, 3, 17, 19}, {3, 3, 2, 3, 2, 1, 1, 2});
+    testPoolCpu<MaxPoolObj>({2, 3, 16, 16}, {3, 3, 1, 1, 0, 0, 2, 2}, 1);
+    testPoolCpu<MaxPoolObj>({4, 64, 56, 56}, {3, 3, 1, 1, 1, 1, 2, 2});
+    testPoolCpu<MaxPoolObj>({2, 8, 7, 7}, {7, 7, 1, 1, 0, 0, 1, 1});
+}
+
+TEST(AvgPool, Cpu) {
+    testPoolCpu<AvgPoolObj>({1, 2, 5, 5}, {3, 3, 1, 1, 1, 1, 2, 2});
+    testPoolCpu<AvgPoolObj>({2, 3, 17, 19}, {3, 2, 1, 1, 0, 1, 2, 3});
+    testPoolCpu<AvgPoolObj>({2, 3, 17, 19}, {3, 3, 2, 3, 2, 1, 1, 2});
+    testPoolCpu<AvgPoolObj>({2, 3, 16, 16}, {3, 3, 1, 1, 1, 1, 2, 2}, 1);
+    testPoolCpu<AvgPoolObj>({4, 64, 56, 56}, {3, 3, 1, 1, 1, 1, 2, 2});
+    // GlobalAveragePool as mapped by the ONNX frontend
+    testPoolCpu<AvgPoolObj>({2, 8, 7, 7}, {7, 7, 1, 1, 0, 0, 1, 1});
+}
+
+TEST(MaxPool, CpuNegative) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({1, 1, 2, 3}, DataType::Float32);
+    auto op = g->addOp<MaxPoolObj>(input, nullptr, 2, 2, 1, 1, 1, 1, 2, 2, 0);
+    g->dataMalloc();
+    input->copyin(vector<float>{-1, -2, -3, -4, -5, -6});
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(vector<float>{-1, -2, -4, -5}));
+}
+
+TEST(AvgPool, CpuFloat16) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({1, 2, 4, 4}, DataType::Float16);
+    auto op = g->addOp<AvgPoolObj>(input, nullptr, 2, 2, 1, 1, 0, 0, 2, 2, 0);
+    g->dataMalloc();
+    vector<uint16_t> data(input->size());
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = float_to_fp16(float(i) - 16);
+    input->copyin(data);
+    runtime->run(g);
+    auto y = op->getOutput()->copyout<uint16_t>();
+    const vector<float> ans{-13.5, -11.5, -5.5, -3.5, 2.5, 4.5, 10.5, 12.5};
+    ASSERT_EQ(y.size(), ans.size());
+    for (size_t i = 0; i < y.size(); ++i)
+        EXPECT_EQ(fp16_to_float(y[i]), ans[i]) << "at " << i;
+}
+
+} // namespace infini
@@ -0,0 +1,90 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/reduce.h"
+
+#include "test.h"
+#include <cmath>
+
+namespace infini {
+
+// Reduces every output element directly, in double.
+vector<double> reduceReference(OpType type, const vector<float> &x,
+                               const Shape &shape, const ReduceBaseObj &op) {
+    const size_t rank = shape.size();
+    // Output strides over the input axes, 0 for reduced ones
+    vector<size_t> strides(rank);
+    size_t outSize = 1;
+    for (size_t i = rank; i-- > 0;)
+        if (!op.isReduced(i)) {
+            strides[i] = outSize;
+            outSize *= shape[i];
+        }
+    const bool isMax = type == OpType::ReduceMax,
+               isMin = type == OpType::ReduceMin;
+    vector<double> y(outSize, isMax ? -INFINITY : isMin ? INFINITY : 0);
+    vector<size_t> count(outSize);
+    for (size_t i = 0; i < x.size(); ++i) {
+        size_t o = 0;
+        for (size_t rest = i, d = rank; d-- > 0; rest /= shape[d])
+            o += rest % shape[d] * strides[d];
+        const double v = x[i];
+        y[o] = isMax                         ? std::max(y[o], v)
+               : isMin                       ? std::min(y[o], v)
+               : type == OpType::ReduceL2 ? y[o] + v * v
+                                             : y[o] + v;
+        count[o]++;
+    }
+    for (size_t o = 0; o < outSize; ++o)
+        if (type == OpType::ReduceMean)
+            y[o] /= count[o];
+        else if (type == OpType::ReduceL2)
+            y[o] = std::sqrt(y[o]);
+    return y;
+}
+
+template <class T>
+void testReduceCpu(const Shape &shape, const optional<vector<int>> &axes,
+                   bool keepDims = true) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor(shape, DataType::Float32);
+    auto op = g->addOp<T>(input, nullptr, axes, keepDims);
+    g->dataMalloc();
+    input->setData(RandomGenerator(-10, 10, 0));
+    runtime->run(g);
+
+    Tensor output = op->getOutput();
+    auto x = input->copyout<float>();
+    auto y = output->copyout<float>();
+    auto ref = reduceReference(op->getOpType(), x, shape, *op);
+    ASSERT_EQ(y.size(), ref.size());
+    for (size_t i = 0; i < y.size(); ++i)
+        ASSERT_NEAR(y[i], ref[i], 1e-4 * std::max(1.0, std::abs(ref[i])))
+            << "at " << i;
+}
+
+template <class T> void testReduceCpuAxes() {
+    testReduceCpu<T>({2, 3, 4, 5}, vector<int>{1});
+    testReduceCpu<T>({2, 3, 4, 5}, vector<int>{3});
+    testReduceCpu<T>({2, 3, 4, 5}, vector<int>{0, 2});
+    testReduceCpu<T>({2, 3, 4, 5}, vector<int>{-1, 1}, false);
+    testReduceCpu<T>({2, 3, 4, 5}, vector<int>{0, 1, 3});
+    testReduceCpu<T>({2, 3, 4, 5}, std::nullopt, false);
+    testReduceCpu<T>({2, 1, 4, 1}, vector<int>{1, 3});
+    // Few outputs, so that the reduced extent is split between threads
+    testReduceCpu<T>({4, 64, 512}, std::nullopt);
+    testReduceCpu<T>({2, 256, 160}, vector<int>{0, 2});
+    testReduceCpu<T>({2, 64, 2100}, vector<int>{1});
+    // Many outputs
+    testReduceCpu<T>({64, 8, 128}, vector<int>{1});
+    testReduceCpu<T>({512, 128}, vector<int>{1}, false);
+}
+
+TEST(ReduceSum, Cpu) { testReduceCpuAxes<ReduceSumObj>(); }
+TEST(ReduceMean, Cpu) { testReduceCpuAxes<ReduceMeanObj>(); }
+TEST(ReduceMax, Cpu) { testReduceCpuAxes<ReduceMaxObj>(); }
+TEST(ReduceMin, Cpu) { testReduceCpuAxes<ReduceMinObj>(); }
+TEST(ReduceL2, Cpu) { testReduceCpuAxes<ReduceL2Obj>(); }
+
+} // namespace infini
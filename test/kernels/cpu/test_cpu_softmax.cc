@@ -0,0 +1,67 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/softmax.h"
+
+#include "test.h"
+#include <cmath>
+
+namespace infini {
+
+// Compares the softmax along `axis` with a reference computed in double.
+void testSoftmaxCpu(const Shape &shape, int axis) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor(shape, DataType::Float32);
+    auto op = g->addOp<SoftmaxObj>(input, nullptr, axis);
+    g->dataMalloc();
+    input->setData(RandomGenerator(-20, 20, 0));
+    runtime->run(g);
+
+    auto x = input->copyout<float>();
+    auto y = op->getOutput()->copyout<float>();
+    const int realAxis = op->getAxis();
+    size_t outer = 1, inner = 1;
+    for (int i = 0; i < realAxis; ++i)
+        outer *= shape[i];
+    for (size_t i = realAxis + 1; i < shape.size(); ++i)
+        inner *= shape[i];
+    const size_t len = shape[realAxis];
+    for (size_t o = 0; o < outer; ++o)
+        for (size_t j = 0; j < inner; ++j) {
+            const size_t base = o * len * inner + j;
+            double maxVal = x[base], sum = 0;
+            for (size_t l = 0; l < len; ++l)
+                maxVal = std::max(maxVal, (double)x[base + l * inner]);
+            for (size_t l = 0; l < len; ++l)
+                sum += std::exp(x[base + l * inner] - maxVal);
+            for (size_t l = 0; l < len; ++l) {
+                const size_t i = base + l * inner;
+                ASSERT_NEAR(y[i], std::exp(x[i] - maxVal) / sum, 1e-6)
+                    << "at " << i;
+            }
+        }
+}
+
+TEST(Softmax, Cpu) {
+    testSoftmaxCpu({2, 3, 4, 70}, 0);
+    testSoftmaxCpu({2, 3, 4, 70}, 1);
+    testSoftmaxCpu({2, 3, 4, 70}, 2);
+    testSoftmaxCpu({2, 3, 4, 70}, -1);
+    testSoftmaxCpu({2, 4, 64, 64}, 3);
+}
+
+TEST(Softmax, CpuLargeValues) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({2, 4}, DataType::Float32);
+    auto op = g->addOp<SoftmaxObj>(input, nullptr, 1);
+    g->dataMalloc();
+    input->copyin(vector<float>{0, 1, 2, 3, 10000, 10001, 10002, -INFINITY});
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(
+        vector<float>{0.032058604, 0.08714432, 0.23688284, 0.6439143,
+                      0.09003057, 0.24472847, 0.66524096, 0}));
+}
+
+} // namespace infini
@@ -0,0 +1,81 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+
+#include "test.h"
+#include <cmath>
+
+namespace infini {
+
+// Compares a unary operator with `ref` evaluated in double, allowing a few
+// ulp of relative error.
+template <class T>
+void testUnaryCpu(const std::function<double(double)> &ref, float lo, float hi,
+                  const Shape &shape = {2, 3, 64, 129}) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor(shape, DataType::Float32);
+    auto op = g->addOp<T>(input, nullptr);
+    g->dataMalloc();
+    input->setData(RandomGenerator(lo, hi, 0));
+    runtime->run(g);
+
+    Tensor output = op->getOutput();
+    auto x = input->copyout<float>();
+    auto y = output->copyout<float>();
+    for (size_t i = 0; i < y.size(); ++i) {
+        const double expected = ref(x[i]);
+        ASSERT_NEAR(y[i], expected, 5e-7 * std::abs(expected) + 1e-30)
+            << "at x = " << x[i];
+    }
+}
+
+TEST(Unary, CpuSigmoid) {
+    testUnaryCpu<SigmoidObj>([](double x) { return 1 / (1 + std::exp(-x)); },
+                             -30, 30);
+}
+
+TEST(Unary, CpuTanh) {
+    testUnaryCpu<TanhObj>([](double x) { return std::tanh(x); }, -10, 10);
+    testUnaryCpu<TanhObj>([](double x) { return std::tanh(x); }, -0.01, 0.01);
+}
+
+TEST(Unary, CpuGelu) {
+    testUnaryCpu<GeluObj>(
+        [](double x) { return 0.5 * x * std::erfc(-x / std::sqrt(2.0)); },
+        -12, 12);
+}
+
+TEST(Unary, CpuErf) {
+    testUnaryCpu<ErfObj>([](double x) { return std::erf(x); }, -5, 5);
+}
+
+TEST(Unary, CpuExp) {
+    testUnaryCpu<ExpObj>([](double x) { return std::exp(x); }, -80, 80);
+}
+
+TEST(Unary, CpuLog) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    for (auto type : {LogObj::LogE, LogObj::Log2, LogObj::Log10}) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto input = g->addTensor({4, 1000}, DataType::Float32);
+        auto op = g->addOp<LogObj>(input, nullptr, type);
+        g->dataMalloc();
+        input->setData(RandomGenerator(1e-3, 1e3, 0));
+        runtime->run(g);
+
+        auto x = input->copyout<float>();
+        auto y = op->getOutput()->copyout<float>();
+        const double base = type == LogObj::LogE   ? std::log(M_E)
+                            : type == LogObj::Log2 ? std::log(2.)
+                                                   : std::log(10.);
+        for (size_t i = 0; i < y.size(); ++i) {
+            const double expected = std::log(x[i]) / base;
+            ASSERT_NEAR(y[i], expected, 5e-7 * std::abs(expected) + 1e-7)
+                << "at x = " << x[i];
+        }
+    }
+}
+
+} // namespace infini
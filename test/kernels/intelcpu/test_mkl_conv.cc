@@ -60,4 +60,27 @@ TEST(mkl_Conv, tune) {
         PerfEngine::getInstance().getPerfData(perfKey);
     ASSERT_TRUE(perfData.has_value());
 }
+
+TEST(dnnl_Conv, weightWithBias) {
+    auto mklRuntime = MklRuntimeObj::getInstance();
+    Graph gMkl = make_ref<GraphObj>(mklRuntime);
+
+    Tensor i0 = gMkl->addTensor({1, 3, 4, 4}, DataType::Float32);
+    Tensor w0 = gMkl->addTensor({2, 3, 3, 3}, DataType::Float32);
+    Tensor b0 = gMkl->addTensor({2}, DataType::Float32);
+    w0->setWeight();
+    b0->setWeight();
+    auto conv = gMkl->addOp<ConvObj>(i0, w0, nullptr, 1, 1, 2, 1, 1, 2, b0);
+    gMkl->dataMalloc();
+    i0->setData(OneGenerator());
+    w0->setData(OneGenerator());
+    b0->copyin(vector<float>{1, -1});
+
+    // The second run reuses the primitives and the reordered weight
+    for (int i = 0; i < 2; ++i) {
+        mklRuntime->run(gMkl);
+        EXPECT_TRUE(conv->getOutput(0)->equalData(
+            vector<float>{13, 13, 19, 19, 11, 11, 17, 17}));
+    }
+}
 } // namespace infini
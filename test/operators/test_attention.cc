@@ -0,0 +1,62 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/attention.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(Attention, ShapeInference) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor q = g->addTensor({2, 4, 10, 16}, DataType::Float32);
+        Tensor k = g->addTensor({2, 4, 12, 16}, DataType::Float32);
+        Tensor v = g->addTensor({2, 4, 12, 8}, DataType::Float32);
+        auto op = g->addOp<AttentionObj>(q, k, v, nullptr);
+        EXPECT_EQ(op->getOutput()->getDims(), (Shape{2, 4, 10, 8}));
+        EXPECT_FLOAT_EQ(op->getScale(), 0.25);
+        EXPECT_EQ(op->getMask(), nullptr);
+    }
+    {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor q = g->addTensor({3, 10, 16}, DataType::Float32);
+        Tensor k = g->addTensor({3, 12, 16}, DataType::Float32);
+        Tensor v = g->addTensor({3, 12, 16}, DataType::Float32);
+        Tensor mask = g->addTensor({1, 12}, DataType::Float32);
+        auto op = g->addOp<AttentionObj>(q, k, v, nullptr, mask, 1.f);
+        EXPECT_EQ(op->getOutput()->getDims(), (Shape{3, 10, 16}));
+        EXPECT_EQ(op->getMask(), mask);
+        EXPECT_EQ(op->numInputs(), 4);
+    }
+    {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor q = g->addTensor({3, 10, 16}, DataType::Float32);
+        Tensor k = g->addTensor({3, 12, 16}, DataType::Float32);
+        Tensor v = g->addTensor({3, 12, 16}, DataType::Float32);
+        auto op0 = g->addOp<AttentionObj>(q, k, v, nullptr);
+        auto op1 = g->addOp<AttentionObj>(q, k, v, nullptr, nullptr, 1.f);
+        EXPECT_NE(op0->hash(), op1->hash());
+    }
+    {
+        // The mask has to hold float32 scores and K and V the type of Q
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor q = g->addTensor({3, 10, 16}, DataType::Float32);
+        Tensor k = g->addTensor({3, 12, 16}, DataType::Float32);
+        Tensor v = g->addTensor({3, 12, 16}, DataType::Float16);
+        Tensor mask = g->addTensor({10, 12}, DataType::Bool);
+        EXPECT_THROW(g->addOp<AttentionObj>(q, k, k, nullptr, mask), Exception);
+        EXPECT_THROW(g->addOp<AttentionObj>(q, k, v, nullptr), Exception);
+    }
+}
+
+TEST(Attention, MaskShape) {
+    EXPECT_TRUE(AttentionObj::isMaskShape({12}, {2, 10, 12}));
+    EXPECT_TRUE(AttentionObj::isMaskShape({2, 1, 1, 12}, {2, 4, 10, 12}));
+    EXPECT_TRUE(AttentionObj::isMaskShape({10, 12}, {2, 10, 12}));
+    EXPECT_FALSE(AttentionObj::isMaskShape({10}, {2, 10, 12}));
+    EXPECT_FALSE(AttentionObj::isMaskShape({1, 2, 10, 12}, {10, 12}));
+}
+
+} // namespace infini
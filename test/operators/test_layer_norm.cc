@@ -0,0 +1,53 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/layer_norm.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(LayerNorm, ShapeInference) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i = g->addTensor({2, 3, 4}, DataType::Float32);
+        Tensor scale = g->addTensor({4}, DataType::Float32);
+        Tensor bias = g->addTensor({1, 4}, DataType::Float32);
+        auto op = g->addOp<LayerNormObj>(i, scale, nullptr, bias);
+        EXPECT_EQ(op->getOutput()->getDims(), (Shape{2, 3, 4}));
+        EXPECT_EQ(op->getAxis(), 2);
+        EXPECT_EQ(op->getNormalizedSize(), 4u);
+        EXPECT_EQ(op->numInputs(), 3);
+    }
+    {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i = g->addTensor({2, 3, 4}, DataType::Float32);
+        Tensor scale = g->addTensor({3, 4}, DataType::Float32);
+        auto op = g->addOp<LayerNormObj>(i, scale, nullptr, nullptr, 1e-5, -2);
+        EXPECT_EQ(op->getOutput()->getDims(), (Shape{2, 3, 4}));
+        EXPECT_EQ(op->getAxis(), 1);
+        EXPECT_EQ(op->getNormalizedSize(), 12u);
+        EXPECT_EQ(op->getBias(), nullptr);
+    }
+    {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i = g->addTensor({2, 3, 4}, DataType::Float32);
+        Tensor scale = g->addTensor({1}, DataType::Float32);
+        auto op = g->addOp<RMSNormObj>(i, scale, nullptr);
+        EXPECT_EQ(op->getOutput()->getDims(), (Shape{2, 3, 4}));
+        EXPECT_EQ(op->getOpType(), OpType::RMSNorm);
+        auto other = g->addOp<RMSNormObj>(i, scale, nullptr, 1e-5);
+        EXPECT_NE(op->hash(), other->hash());
+    }
+}
+
+TEST(LayerNorm, ParamShape) {
+    EXPECT_TRUE(LayerNormBaseObj::isParamShape({4}, {4}));
+    EXPECT_TRUE(LayerNormBaseObj::isParamShape({1, 1}, {3, 4}));
+    EXPECT_TRUE(LayerNormBaseObj::isParamShape({1, 3, 4}, {3, 4}));
+    EXPECT_FALSE(LayerNormBaseObj::isParamShape({4}, {3, 4}));
+    EXPECT_FALSE(LayerNormBaseObj::isParamShape({3, 1}, {3, 4}));
+}
+
+} // namespace infini